@@ -22,6 +22,7 @@ See the AUTHORS file for names of contributors.
 #pragma once
 
 #include <string>
+#include <inttypes.h>
 
 namespace phxpaxos
 {
@@ -108,6 +109,7 @@ public:
     virtual void OnInstanceLearnedNotMyCommit() { }
     virtual void OnInstanceLearnedIsMyCommit(const int iUseTimeMs) { }
     virtual void OnInstanceLearnedSMExecuteFail() { }
+    virtual void OnApplyLagFull() { }
     virtual void ChecksumLogicFail() { }
 };
 
@@ -128,6 +130,7 @@ public:
     virtual void BatchProposeFail() { }
     virtual void BatchProposeWaitTimeMs(const int iWaitTimeMs) { }
     virtual void BatchProposeDoPropose(const int iBatchCount) { }
+    virtual void BatchProposeAdaptive(const int iBatchCount, const int iBatchDelayTimeMs) { }
 };
 
 class IOLoopBP
@@ -213,6 +216,38 @@ public:
     virtual void OtherBeMaster() { }
     virtual void DropMaster() { }
     virtual void MasterSMInconsistent() { }
+    virtual void ReadByLease() { }
+    virtual void ReadByReadIndex() { }
+    virtual void ReadByReadIndexFail() { }
+};
+
+//stages of a commit, LatencyBP report the use time of each stage in microseconds.
+enum LatencyStage
+{
+    //propose thread wait for the group's waitlock.
+    LatencyStage_WaitLock = 0,
+    //value enqueued by propose thread until ioloop start to propose it.
+    LatencyStage_Queue = 1,
+    //proposer prepare until a majority promised.
+    LatencyStage_Prepare = 2,
+    //proposer accept until a majority accepted.
+    LatencyStage_Accept = 3,
+    //acceptor write its state to logstorage, include fsync.
+    LatencyStage_Persist = 4,
+    //acceptor accepted a value until learner learned it on this node.
+    LatencyStage_Learn = 5,
+    //statemachine execute a learned value.
+    LatencyStage_SMExecute = 6,
+    //commit result set until propose thread wake up.
+    LatencyStage_Notify = 7,
+    LatencyStage_Max = 8,
+};
+
+class LatencyBP
+{
+public:
+    virtual ~LatencyBP() { }
+    virtual void StageUseTimeUs(const int iGroupIdx, const int iStage, const uint64_t llUseTimeUs) { }
 };
 
 #define BP (Breakpoint::Instance())
@@ -250,6 +285,8 @@ public:
 
     virtual MasterBP * GetMasterBP();
 
+    virtual LatencyBP * GetLatencyBP();
+
 public:
     ProposerBP m_oProposerBP;
     AcceptorBP m_oAcceptorBP;
@@ -262,6 +299,7 @@ public:
     AlgorithmBaseBP m_oAlgorithmBaseBP;
     CheckpointBP m_oCheckpointBP;
     MasterBP m_oMasterBP;
+    LatencyBP m_oLatencyBP;
 
     static Breakpoint * m_poBreakpoint;
 };
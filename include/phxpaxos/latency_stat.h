@@ -0,0 +1,104 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#pragma once
+
+#include "phxpaxos/breakpoint.h"
+#include <atomic>
+#include <vector>
+
+namespace phxpaxos
+{
+
+//log-linear buckets like HdrHistogram: values under 2^LATENCY_HISTOGRAM_SUB_BITS are exact,
+//each power of two above is split into 2^LATENCY_HISTOGRAM_SUB_BITS buckets,
+//so a recorded value is off by at most 1/16 (6.25%). values are capped at 2^32us(about 71 minutes).
+#define LATENCY_HISTOGRAM_SUB_BITS 4
+#define LATENCY_HISTOGRAM_SUB_COUNT (1 << LATENCY_HISTOGRAM_SUB_BITS)
+#define LATENCY_HISTOGRAM_MAX_BITS 32
+#define LATENCY_HISTOGRAM_BUCKET_COUNT ((LATENCY_HISTOGRAM_MAX_BITS - LATENCY_HISTOGRAM_SUB_BITS + 1) * LATENCY_HISTOGRAM_SUB_COUNT)
+
+struct LatencySnapshot
+{
+    uint64_t llCount;
+    uint64_t llSumUs;
+    uint64_t llP50Us;
+    uint64_t llP90Us;
+    uint64_t llP99Us;
+    uint64_t llP999Us;
+    uint64_t llMaxUs;
+};
+
+//lock-free, many threads can Record at the same time, Snapshot is not atomic with Record
+//but each bucket is consistent, good enough for monitor.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void Record(const uint64_t llValueUs);
+
+    //count and percentiles since last Reset.
+    void Snapshot(LatencySnapshot & oSnapshot) const;
+
+    //add counts of oOther into this.
+    void Merge(const LatencyHistogram & oOther);
+
+    void Reset();
+
+private:
+    static int GetBucketIdx(const uint64_t llValueUs);
+
+    //max value falls in this bucket, so percentiles never under-report.
+    static uint64_t GetBucketMaxValue(const int iBucketIdx);
+
+    uint64_t GetPercentile(const std::vector<uint64_t> & vecCount, const uint64_t llTotal, const double dRatio) const;
+
+private:
+    std::atomic<uint64_t> m_arrCount[LATENCY_HISTOGRAM_BUCKET_COUNT];
+    std::atomic<uint64_t> m_llSumUs;
+};
+
+//keep one histogram per group and stage.
+//to use it, override Breakpoint::GetLatencyBP to return a LatencyStatBP and set the breakpoint by
+//Breakpoint::SetInstance before run node, then call GetSnapshot periodically to export percentiles.
+class LatencyStatBP : public LatencyBP
+{
+public:
+    LatencyStatBP(const int iGroupCount);
+    ~LatencyStatBP();
+
+    void StageUseTimeUs(const int iGroupIdx, const int iStage, const uint64_t llUseTimeUs);
+
+    //return -2 if groupidx or stage invalid.
+    int GetSnapshot(const int iGroupIdx, const int iStage, LatencySnapshot & oSnapshot) const;
+
+    //all groups of this stage merged.
+    int GetSnapshot(const int iStage, LatencySnapshot & oSnapshot) const;
+
+    void Reset();
+
+private:
+    int m_iGroupCount;
+    std::vector<LatencyHistogram *> m_vecHistogram;
+};
+    
+}
@@ -22,6 +22,7 @@ See the AUTHORS file for names of contributors.
 #pragma once
 
 #include <string>
+#include <memory>
 #include <typeinfo>
 #include <inttypes.h>
 
@@ -31,6 +32,10 @@ namespace phxpaxos
 //You can use your own network to make paxos communicate. :)
 
 class Node;
+class MsgBuffer;
+
+//Message shared by all receivers of a broadcast, never modified after created.
+typedef std::shared_ptr<const std::string> SharedMessage;
 
 class NetWork
 {
@@ -48,10 +53,20 @@ public:
 
     virtual int SendMessageUDP(const std::string & sIp, const int iPort, const std::string & sMessage) = 0;
 
+    //Broadcast calls these with one message for all receivers.
+    //Default copy the message by the functions above, override them to hold the reference instead.
+    virtual int SendMessageTCP(const std::string & sIp, const int iPort, const SharedMessage & poMessage);
+
+    virtual int SendMessageUDP(const std::string & sIp, const int iPort, const SharedMessage & poMessage);
+
     //When receive a message, call this funtion.
     //This funtion is async, just enqueue an return.
     int OnReceiveMessage(const char * pcMessage, const int iMessageLen);
 
+    //Used by default network, message is already read into a MsgBuffer from MsgBufferPool.
+    //Take the buffer's ownership, no copy.
+    int OnReceiveMessage(MsgBuffer * poBuffer);
+
 private:
     friend class Node;
     Node * m_poNode;
@@ -27,11 +27,17 @@ See the AUTHORS file for names of contributors.
 #include <inttypes.h>
 #include <map>
 #include <vector>
+#include <functional>
 
 namespace phxpaxos
 {
 
 class NetWork;
+class MsgBuffer;
+
+//Result of async propose, iBatchIndex is always 0 if not batch propose.
+//Callback run in paxos ioloop thread, do not block in it.
+typedef std::function<void(const int iRet, const uint64_t llInstanceID, const uint32_t iBatchIndex)> ProposeCallback;
 
 //All the funciton in class Node is thread safe!
 
@@ -50,6 +56,15 @@ public:
 
     virtual int Propose(const int iGroupIdx, const std::string & sValue, uint64_t & llInstanceID, SMCtx * poSMCtx) = 0;
 
+    //Async propose, return 0 means value is accepted to propose and pCallback will be called later,
+    //otherwise pCallback will never be called.
+    //Only set options::iProposeWindowSize > 0 can use async API, window size is the max count of 
+    //values waiting in paxos of one group, more values wait in a queue up to options::iAsyncProposeQueueSize,
+    //propose will be rejected if the queue is full too.
+    //poSMCtx must be valid until pCallback is called.
+    virtual int ProposeAsync(const int iGroupIdx, const std::string & sValue, 
+            ProposeCallback pCallback, SMCtx * poSMCtx = nullptr) = 0;
+
     virtual const uint64_t GetNowInstanceID(const int iGroupIdx) = 0;
 
     virtual const nodeid_t GetMyNodeID() const = 0;
@@ -66,6 +81,10 @@ public:
     virtual int BatchPropose(const int iGroupIdx, const std::string & sValue, uint64_t & llInstanceID, 
             uint32_t & iBatchIndex, SMCtx * poSMCtx) = 0;
 
+    //Async batch propose, need both options::bUseBatchPropose and options::iProposeWindowSize.
+    virtual int BatchProposeAsync(const int iGroupIdx, const std::string & sValue, 
+            ProposeCallback pCallback, SMCtx * poSMCtx = nullptr) = 0;
+
     //PhxPaxos will batch proposal while waiting proposals count reach to BatchCount, 
     //or wait time reach to BatchDelayTimeMs.
     virtual void SetBatchCount(const int iGroupIdx, const int iBatchCount) = 0;
@@ -137,6 +156,17 @@ public:
 
     virtual int DropMaster(const int iGroupIdx) = 0;
 
+    //Linearizable local read
+    
+    //Return 0 means local state machine has executed every value committed before this call,
+    //then read it directly without propose.
+    //On master with enough lease left, it only wait for local execute. Lease read require all 
+    //writes proposed on master(like phxkv sample), otherwise or lease is uncertain,
+    //it propose an empty value as read index, and cost one paxos round.
+    //Without Options::iMaxApplyLag > 0 the lease path does not wait for execute, it only
+    //guarantee values committed before are chosen.
+    virtual int ReadBarrier(const int iGroupIdx) = 0;
+
     //Qos
 
     //If many threads propose same group, that some threads will be on waiting status.
@@ -150,6 +180,10 @@ public:
     //write disk
     virtual void SetLogSync(const int iGroupIdx, const bool bLogSync) = 0;
 
+    //chrome trace json of recent paxos events in this group, need Options::iInstanceTraceRingSize > 0,
+    //otherwise get an empty trace.
+    virtual int DumpInstanceTrace(const int iGroupIdx, std::string & sTraceJson) = 0;
+
     //Not suggest to use this function
     //pair: value,smid.
     //Because of BatchPropose, a InstanceID maybe include multi-value.
@@ -160,6 +194,8 @@ protected:
     friend class NetWork; 
 
     virtual int OnReceiveMessage(const char * pcMessage, const int iMessageLen) = 0;
+
+    virtual int OnReceiveMessage(MsgBuffer * poBuffer) = 0;
 };
     
 }
@@ -141,6 +141,23 @@ public:
     //That also means you will lost at most iSyncInterval count's paxos log.
     int iSyncInterval;
 
+    //optional
+    //Only work with default logstorage.
+    //If true, paxos log files are mmap to read, readers (learner, replayer) copy from the mapping
+    //instead of seek and read under the file read lock, only a short lock to find the mapping is taken.
+    //Write still use write and fdatasync.
+    //Default is false.
+    bool bUseLogMmapRead;
+
+    //optional
+    //Only work with default logstorage.
+    //If true, instanceid -> log position index is kept in memory and a small append only file,
+    //not in leveldb any more. Leveldb only keep minchosen instanceid and system/master variables.
+    //Old index in leveldb is imported at the first start. Once opened, don't close it again,
+    //leveldb index will be stale.
+    //Default is false.
+    bool bUseLogMemIndex;
+
     //optional
     //User-specified network.
     NetWork * poNetWork;
@@ -224,10 +241,91 @@ public:
     //Default is false;
     bool bUseBatchPropose;
 
+    //optional
+    //If bUseAdaptiveBatchPropose is true, batch propose tune batch count and delay time online
+    //by commit latency, queue depth and arrive rate, BatchCount and BatchDelayTimeMs become the
+    //upper limit. Low load propose at once, burst load batch more.
+    //Default is false;
+    bool bUseAdaptiveBatchPropose;
+
     //optional
     //Only bOpenChangeValueBeforePropose is true, that will callback sm's function(BeforePropose).
     //Default is false;
     bool bOpenChangeValueBeforePropose;
+
+    //optional
+    //Propose window lets up to iProposeWindowSize proposals of one group wait in paxos at the same time,
+    //the next one start right after the last instance is chosen (and skip prepare on a stable master),
+    //instead of waiting for the last proposer thread to wake up and hand over the lock.
+    //Instances are still chosen one by one, the window only remove the gap between them.
+    //Default is 0, that means propose one by one. Max is 100.
+    int iProposeWindowSize;
+
+    //optional
+    //Async proposals of one group that find the propose window full wait in a queue up to this count,
+    //and start in order as window slots free up, a full queue reject new async proposals.
+    //Default is 10000.
+    int iAsyncProposeQueueSize;
+
+    //optional
+    //If iLearnBatchMaxSize > 0, learner sender pack continuous instances into one message
+    //up to this size(bytes), and the receiver write them to logstorage in one batch.
+    //All nodes must support MsgType_PaxosLearner_SendLearnValueBatch before open it.
+    //Default is 0, that means send one instance per message.
+    int iLearnBatchMaxSize;
+
+    //optional
+    //If iMaxApplyLag > 0, StateMachine::Execute run in an apply thread per group instead of ioloop,
+    //chosen instances are executed in order and paxos can run ahead of execute up to iMaxApplyLag
+    //instances, propose result return after its value is executed. While lag is full only learning
+    //wait, the group still answer prepare and accept. A failed Execute is retried with backoff.
+    //Values of system variables and master are still executed before next instance start.
+    //With bUseCheckpointReplayer, replayer run in the apply thread too.
+    //Default is 0, that means execute in ioloop.
+    int iMaxApplyLag;
+
+    //optional
+    //Number of tcp read and write event loops of the default network, each loop is a thread.
+    //Connections to the same peer always go through the same write loop, so message order is kept.
+    //Default is 1.
+    int iTcpIOThreadCount;
+
+    //optional
+    //Number of shared threads to run all groups' ioloops, learner senders, appliers,
+    //checkpoint cleaners, replayers and master managers, for many groups on few cores.
+    //Each of them still runs on one thread at a time, so paxos state keeps single-threaded.
+    //While a slice waits on fsync, the state machine or a propose, its thread is handed
+    //to other jobs, so at most this many slices do work at the same time.
+    //Default is 0, means every group has its own threads.
+    int iIOLoopThreadCount;
+
+    //optional
+    //If true, prepare, accept and their replies are sent in a fixed layout instead of protobuf,
+    //marked by header version, other messages still use protobuf.
+    //All nodes must support the compact layout before open it, receiving is always supported.
+    //Default is false.
+    bool bUseCompactPaxosMsg;
+
+    //optional
+    //If iInstanceTraceRingSize > 0, each group keeps its last iInstanceTraceRingSize paxos events
+    //(prepare, accept, persist, learn, execute...) with timestamps in a lock-free ring,
+    //use Node::DumpInstanceTrace to get them as chrome trace json.
+    //Default is 0, that means trace is closed.
+    int iInstanceTraceRingSize;
+
+    //optional
+    //If iInstanceTraceDumpThresholdMs > 0 and trace is open, when my commit use more than this time,
+    //events during the commit are written into a json file under sInstanceTraceDumpPath.
+    //Files are written by one background thread of the process, at most one every
+    //iInstanceTraceDumpIntervalMs per group, slow commits in between are not dumped.
+    //Default is 0, that means only dump by Node::DumpInstanceTrace.
+    int iInstanceTraceDumpThresholdMs;
+    std::string sInstanceTraceDumpPath;
+
+    //optional
+    //Min interval between two slow commit dumps.
+    //Default is 10000.
+    int iInstanceTraceDumpIntervalMs;
 };
     
 }
@@ -22,6 +22,7 @@ See the AUTHORS file for names of contributors.
 #pragma once
 
 #include <string>
+#include <vector>
 #include <typeinfo>
 #include <inttypes.h>
 
@@ -49,8 +50,46 @@ public:
 
     virtual int Put(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llInstanceID, const std::string & sValue) = 0;
 
+    //Put many continuous instances at once, oWriteOptions.bSync only need to take effect on the last one.
+    //Default put one by one, override it if your storage can do it in one write.
+    virtual int BatchPut(const WriteOptions & oWriteOptions, const int iGroupIdx, 
+            const std::vector<std::pair<uint64_t, std::string> > & vecValues)
+    {
+        WriteOptions oNoSyncWriteOptions;
+        oNoSyncWriteOptions.bSync = false;
+
+        for (size_t i = 0; i < vecValues.size(); i++)
+        {
+            int ret = Put(i + 1 == vecValues.size() ? oWriteOptions : oNoSyncWriteOptions, 
+                    iGroupIdx, vecValues[i].first, vecValues[i].second);
+            if (ret != 0)
+            {
+                return ret;
+            }
+        }
+
+        return 0;
+    }
+
     virtual int Del(const WriteOptions & oWriteOptions, int iGroupIdx, const uint64_t llInstanceID) = 0;
 
+    //Delete instances in [llBeginInstanceID, llEndInstanceID), all of them are before checkpoint.
+    //Default delete one by one, override it if your storage can do it in one write.
+    virtual int DelRange(const WriteOptions & oWriteOptions, const int iGroupIdx, 
+            const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID)
+    {
+        for (uint64_t llInstanceID = llBeginInstanceID; llInstanceID < llEndInstanceID; llInstanceID++)
+        {
+            int ret = Del(oWriteOptions, iGroupIdx, llInstanceID);
+            if (ret != 0)
+            {
+                return ret;
+            }
+        }
+
+        return 0;
+    }
+
     virtual int GetMaxInstanceID(const int iGroupIdx, uint64_t & llInstanceID) = 0;
 
     virtual int SetMinChosenInstanceID(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llMinInstanceID) = 0;
@@ -64,11 +64,18 @@ Status PhxKVServiceImpl :: Put(ServerContext* context, const KVOperator * reques
 }
 
 Status PhxKVServiceImpl :: GetLocal(ServerContext* context, const KVOperator * request, KVResponse * reply)
+{
+    return Get(request, reply, false);
+}
+
+Status PhxKVServiceImpl :: Get(const KVOperator * request, KVResponse * reply, const bool bIsGlobal)
 {
     string sReadValue;
     uint64_t llReadVersion = 0;
 
-    PhxKVStatus status = m_oPhxKV.GetLocal(request->key(), sReadValue, llReadVersion);
+    PhxKVStatus status = bIsGlobal ? 
+        m_oPhxKV.GetGlobal(request->key(), sReadValue, llReadVersion)
+        : m_oPhxKV.GetLocal(request->key(), sReadValue, llReadVersion);
     if (status == PhxKVStatus::SUCC)
     {
         reply->mutable_data()->set_value(sReadValue);
@@ -101,7 +108,7 @@ Status PhxKVServiceImpl :: GetGlobal(ServerContext* context, const KVOperator *
         return Status::OK;
     }
 
-    return GetLocal(context, request, reply);
+    return Get(request, reply, true);
 }
 
 Status PhxKVServiceImpl :: Delete(ServerContext* context, const KVOperator * request, KVResponse * reply)
@@ -44,6 +44,9 @@ public:
 
     grpc::Status Delete(grpc::ServerContext* context, const KVOperator * request, KVResponse * reply) override;
 
+private:
+    grpc::Status Get(const KVOperator * request, KVResponse * reply, const bool bIsGlobal);
+
 private:
     PhxKV m_oPhxKV;
 };
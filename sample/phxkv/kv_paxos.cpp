@@ -206,6 +206,22 @@ PhxKVStatus PhxKV :: GetLocal(
     }
 }
 
+PhxKVStatus PhxKV :: GetGlobal(
+        const std::string & sKey, 
+        std::string & sValue, 
+        uint64_t & llVersion)
+{
+    int iGroupIdx = GetGroupIdx(sKey);
+    int ret = m_poPaxosNode->ReadBarrier(iGroupIdx);
+    if (ret != 0)
+    {
+        PLErr("ReadBarrier fail, ret %d", ret);
+        return PhxKVStatus::FAIL;
+    }
+
+    return GetLocal(sKey, sValue, llVersion);
+}
+
 PhxKVStatus PhxKV :: Delete( 
         const std::string & sKey, 
         const uint64_t llVersion)
@@ -59,6 +59,12 @@ public:
             std::string & sValue, 
             uint64_t & llVersion);
 
+    //linearizable read on master, no propose while master lease is valid.
+    PhxKVStatus GetGlobal(
+            const std::string & sKey, 
+            std::string & sValue, 
+            uint64_t & llVersion);
+
     PhxKVStatus Delete( 
             const std::string & sKey, 
             const uint64_t llVersion = NullVersion);
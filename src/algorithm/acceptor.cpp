@@ -22,6 +22,7 @@ See the AUTHORS file for names of contributors.
 #include "acceptor.h"
 #include "paxos_log.h"
 #include "crc32.h"
+#include "job_scheduler.h"
 
 namespace phxpaxos
 {
@@ -118,11 +119,28 @@ int AcceptorState :: Persist(const uint64_t llInstanceID, const uint32_t iLastCh
         }
     }
 
+    //fsync may take long, other jobs of the scheduler run meanwhile.
+    if (oWriteOptions.bSync)
+    {
+        JobScheduler::EnterBlocking();
+    }
+
+    uint64_t llBeginTimeUs = Time::GetSteadyClockUS();
     int ret = m_oPaxosLog.WriteState(oWriteOptions, m_poConfig->GetMyGroupIdx(), llInstanceID, oState);
+
+    if (oWriteOptions.bSync)
+    {
+        JobScheduler::ExitBlocking();
+    }
+
     if (ret != 0)
     {
         return ret;
     }
+
+    uint64_t llUseTimeUs = Time::GetSteadyClockUS() - llBeginTimeUs;
+    BP->GetLatencyBP()->StageUseTimeUs(m_poConfig->GetMyGroupIdx(), LatencyStage_Persist, llUseTimeUs);
+    m_poConfig->GetInstanceTrace()->Add(TraceEvent_Persist, llInstanceID, 0, llUseTimeUs);
     
     PLGImp("GroupIdx %d InstanceID %lu PromiseID %lu PromiseNodeID %lu "
             "AccectpedID %lu AcceptedNodeID %lu ValueLen %zu Checksum %u", 
@@ -180,7 +198,8 @@ Acceptor :: Acceptor(
         const MsgTransport * poMsgTransport, 
         const Instance * poInstance,
         const LogStorage * poLogStorage)
-    : Base(poConfig, poMsgTransport, poInstance), m_oAcceptorState(poConfig, poLogStorage)
+    : Base(poConfig, poMsgTransport, poInstance), m_oAcceptorState(poConfig, poLogStorage),
+    m_llAcceptedTimeUs(0)
 {
 }
 
@@ -214,6 +233,12 @@ int Acceptor :: Init()
 void Acceptor :: InitForNewPaxosInstance()
 {
     m_oAcceptorState.Init();
+    m_llAcceptedTimeUs = 0;
+}
+
+const uint64_t Acceptor :: GetAcceptedTimeUs() const
+{
+    return m_llAcceptedTimeUs;
 }
 
 AcceptorState * Acceptor :: GetAcceptorState()
@@ -227,6 +252,7 @@ int Acceptor :: OnPrepare(const PaxosMsg & oPaxosMsg)
             oPaxosMsg.instanceid(), oPaxosMsg.nodeid(), oPaxosMsg.proposalid());
 
     BP->GetAcceptorBP()->OnPrepare();
+    m_poConfig->GetInstanceTrace()->Add(TraceEvent_OnPrepare, oPaxosMsg.instanceid(), oPaxosMsg.nodeid());
     
     PaxosMsg oReplyPaxosMsg;
     oReplyPaxosMsg.set_instanceid(GetInstanceID());
@@ -299,6 +325,7 @@ void Acceptor :: OnAccept(const PaxosMsg & oPaxosMsg)
             oPaxosMsg.instanceid(), oPaxosMsg.nodeid(), oPaxosMsg.proposalid(), oPaxosMsg.value().size());
 
     BP->GetAcceptorBP()->OnAccept();
+    m_poConfig->GetInstanceTrace()->Add(TraceEvent_OnAccept, oPaxosMsg.instanceid(), oPaxosMsg.nodeid());
 
     PaxosMsg oReplyPaxosMsg;
     oReplyPaxosMsg.set_instanceid(GetInstanceID());
@@ -339,6 +366,7 @@ void Acceptor :: OnAccept(const PaxosMsg & oPaxosMsg)
         }
 
         BP->GetAcceptorBP()->OnAcceptPass();
+        m_llAcceptedTimeUs = Time::GetSteadyClockUS();
     }
     else
     {
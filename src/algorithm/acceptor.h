@@ -85,8 +85,12 @@ public:
 
     void OnAccept(const PaxosMsg & oPaxosMsg);
 
+    //0 if not accepted any value in this instance.
+    const uint64_t GetAcceptedTimeUs() const;
+
 //private:
     AcceptorState m_oAcceptorState;
+    uint64_t m_llAcceptedTimeUs;
 };
     
 }
@@ -0,0 +1,333 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "applier.h"
+#include "sm_base.h"
+#include "comm_include.h"
+#include "config_include.h"
+#include "cp_mgr.h"
+#include "commitctx.h"
+#include "committer.h"
+#include "ioloop.h"
+#include <chrono>
+#include <algorithm>
+
+namespace phxpaxos
+{
+
+ApplyTask :: ApplyTask()
+    : llInstanceID(0), poSMCtx(nullptr), poCommitCtx(nullptr), bIsAsyncCommit(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+
+Applier :: Applier(
+        Config * poConfig,
+        SMFac * poSMFac,
+        CheckpointMgr * poCheckpointMgr,
+        Committer * poCommitter,
+        IOLoop * poIOLoop,
+        const int iMaxApplyLag)
+    : m_poConfig(poConfig),
+    m_poSMFac(poSMFac),
+    m_poCheckpointMgr(poCheckpointMgr),
+    m_poCommitter(poCommitter),
+    m_poIOLoop(poIOLoop),
+    m_poReplayer(poCheckpointMgr->IsReplayInApplier() ? poCheckpointMgr->GetReplayer() : nullptr),
+    m_iMaxApplyLag(iMaxApplyLag),
+    m_bIsApplying(false),
+    m_bIsIOLoopWaiting(false),
+    m_iRetryWaitMs(0),
+    m_llNextRetryTime(0),
+    m_llAppliedInstanceID(0),
+    m_bIsStarted(false),
+    m_bIsEnd(false)
+{
+}
+
+Applier :: ~Applier()
+{
+}
+
+const bool Applier :: IsOpen() const
+{
+    return m_iMaxApplyLag > 0;
+}
+
+void Applier :: Start(const uint64_t llNowInstanceID, JobScheduler * poScheduler)
+{
+    m_llAppliedInstanceID = llNowInstanceID;
+
+    if (!IsOpen())
+    {
+        return;
+    }
+
+    m_bIsStarted = true;
+    if (poScheduler == nullptr || StartOnScheduler(poScheduler) != 0)
+    {
+        start();
+    }
+}
+
+void Applier :: SetEnd()
+{
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+    m_bIsEnd = true;
+    m_oAddCond.notify_all();
+    m_oApplyCond.notify_all();
+}
+
+void Applier :: Stop()
+{
+    if (!m_bIsStarted)
+    {
+        return;
+    }
+
+    SetEnd();
+
+    if (IsOnScheduler())
+    {
+        StopOnScheduler();
+    }
+    else
+    {
+        join();
+    }
+
+    //ioloop already stop, no one will execute them, tell proposal fail.
+    for (auto & oTask : m_dequeTask)
+    {
+        FinishCommit(oTask, Paxos_SystemError);
+    }
+    m_dequeTask.clear();
+}
+
+bool Applier :: CanAdd(const bool bNeedIdle)
+{
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+
+    bool bCanAdd = bNeedIdle ? m_dequeTask.empty() && !m_bIsApplying 
+        : (int)m_dequeTask.size() < m_iMaxApplyLag;
+    if (!bCanAdd)
+    {
+        BP->GetInstanceBP()->OnApplyLagFull();
+        m_bIsIOLoopWaiting = true;
+    }
+
+    return bCanAdd;
+}
+
+void Applier :: Add(const uint64_t llInstanceID, const std::string & sValue, SMCtx * poSMCtx, CommitCtx * poCommitCtx)
+{
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+
+    ApplyTask oTask;
+    oTask.llInstanceID = llInstanceID;
+    oTask.sValue = sValue;
+    oTask.poSMCtx = poSMCtx;
+    oTask.poCommitCtx = poCommitCtx;
+    oTask.bIsAsyncCommit = poCommitCtx != nullptr && poCommitCtx->IsAsyncCommit();
+
+    m_dequeTask.push_back(oTask);
+    m_oAddCond.notify_one();
+
+    oLock.unlock();
+
+    NotifyScheduler();
+}
+
+void Applier :: SetAppliedInstanceID(const uint64_t llAppliedInstanceID)
+{
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+
+    m_llAppliedInstanceID = llAppliedInstanceID;
+    m_oApplyCond.notify_all();
+}
+
+const uint64_t Applier :: GetAppliedInstanceID() const
+{
+    return m_llAppliedInstanceID;
+}
+
+bool Applier :: WaitApplied(const uint64_t llInstanceID, const int iTimeoutMs)
+{
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+
+    return m_oApplyCond.wait_for(oLock, std::chrono::milliseconds(iTimeoutMs), 
+            [&]() { return m_llAppliedInstanceID >= llInstanceID || m_bIsEnd; })
+        && m_llAppliedInstanceID >= llInstanceID;
+}
+
+void Applier :: run()
+{
+    PLGHead("Applier [START]");
+
+    while (true)
+    {
+        int iWaitMs = RunSlice();
+
+        std::unique_lock<std::mutex> oLock(m_oMutex);
+        if (m_bIsEnd)
+        {
+            break;
+        }
+
+        //wait for a new task, or retry and replay time.
+        if (iWaitMs > 0 && (m_bIsApplying || m_dequeTask.empty()))
+        {
+            m_oAddCond.wait_for(oLock, std::chrono::milliseconds(iWaitMs));
+        }
+    }
+
+    PLGHead("Applier [END]");
+}
+
+int Applier :: RunSlice()
+{
+    for (int i = 0; i < APPLIER_MAX_APPLY_PER_SLICE; i++)
+    {
+        if (!m_bIsApplying)
+        {
+            std::unique_lock<std::mutex> oLock(m_oMutex);
+            if (m_bIsEnd)
+            {
+                return APPLIER_IDLE_WAIT_MS;
+            }
+
+            if (m_dequeTask.empty())
+            {
+                oLock.unlock();
+                return m_poReplayer != nullptr ? m_poReplayer->PlayStep() : APPLIER_IDLE_WAIT_MS;
+            }
+
+            m_oApplyingTask = m_dequeTask.front();
+            m_dequeTask.pop_front();
+            m_bIsApplying = true;
+            m_iRetryWaitMs = 0;
+        }
+        else if (m_iRetryWaitMs > 0 && Time::GetSteadyClockMS() < m_llNextRetryTime)
+        {
+            //woken up by add before retry time.
+            return (int)(m_llNextRetryTime - Time::GetSteadyClockMS());
+        }
+
+        //state machine must execute instances in order, retry until success or stop.
+        //the proposal already fail on the first execute fail, and ioloop go on
+        //with acceptor and timers while lag is full, only learning wait for us.
+        if (!ApplyOne(m_oApplyingTask))
+        {
+            m_iRetryWaitMs = m_iRetryWaitMs == 0 ? APPLIER_RETRY_MIN_WAIT_MS 
+                : std::min(m_iRetryWaitMs * 2, APPLIER_RETRY_MAX_WAIT_MS);
+            m_llNextRetryTime = Time::GetSteadyClockMS() + m_iRetryWaitMs;
+            return m_iRetryWaitMs;
+        }
+
+        if (m_poReplayer != nullptr)
+        {
+            m_poReplayer->OnApplied(m_oApplyingTask.llInstanceID, m_oApplyingTask.sValue);
+        }
+
+        std::unique_lock<std::mutex> oLock(m_oMutex);
+        m_bIsApplying = false;
+        //wake up local reads.
+        m_oApplyCond.notify_all();
+
+        bool bNeedNotifyIOLoop = m_bIsIOLoopWaiting;
+        m_bIsIOLoopWaiting = false;
+        oLock.unlock();
+
+        if (bNeedNotifyIOLoop)
+        {
+            m_poIOLoop->AddNotify();
+        }
+    }
+
+    return 0;
+}
+
+bool Applier :: ApplyOne(ApplyTask & oTask)
+{
+    uint64_t llBeginTimeUs = Time::GetSteadyClockUS();
+    bool bExecuteRet = false;
+    {
+        //state machine may be slow, other jobs of the scheduler run meanwhile.
+        SchedulerBlockingGuard oBlockingGuard;
+        bExecuteRet = m_poSMFac->Execute(m_poConfig->GetMyGroupIdx(), 
+                oTask.llInstanceID, oTask.sValue, oTask.poSMCtx);
+    }
+    uint64_t llUseTimeUs = Time::GetSteadyClockUS() - llBeginTimeUs;
+    BP->GetLatencyBP()->StageUseTimeUs(m_poConfig->GetMyGroupIdx(), LatencyStage_SMExecute, llUseTimeUs);
+    m_poConfig->GetInstanceTrace()->Add(TraceEvent_SMExecute, oTask.llInstanceID, 0, llUseTimeUs);
+    if (!bExecuteRet)
+    {
+        BP->GetInstanceBP()->OnInstanceLearnedSMExecuteFail();
+        PLGErr("SMExecute fail, instanceid %lu, retry later", oTask.llInstanceID);
+
+        //instance is chosen, only proposal fail, retry without its ctx.
+        FinishCommit(oTask, PaxosTryCommitRet_ExecuteFail);
+        oTask.poSMCtx = nullptr;
+        return false;
+    }
+
+    FinishCommit(oTask, PaxosTryCommitRet_OK);
+
+    m_llAppliedInstanceID = oTask.llInstanceID + 1;
+
+    //replayer and cleaner follow applied instance, not chosen instance.
+    m_poCheckpointMgr->SetMaxChosenInstanceID(oTask.llInstanceID + 1);
+
+    return true;
+}
+
+void Applier :: FinishCommit(ApplyTask & oTask, const int iCommitRet)
+{
+    if (oTask.poCommitCtx == nullptr)
+    {
+        return;
+    }
+
+    CommitCtx * poCommitCtx = oTask.poCommitCtx;
+    oTask.poCommitCtx = nullptr;
+
+    bool bIsCommitEnd = poCommitCtx->SetApplyResult(iCommitRet, oTask.llInstanceID, oTask.sValue);
+    if (bIsCommitEnd && oTask.bIsAsyncCommit)
+    {
+        m_poCommitter->OnAsyncCommitEnd(poCommitCtx);
+    }
+}
+
+const bool Applier :: IsSystemValue(const std::string & sValue) const
+{
+    if (sValue.size() < sizeof(int))
+    {
+        return false;
+    }
+
+    int iSMID = 0;
+    memcpy(&iSMID, sValue.data(), sizeof(int));
+
+    return iSMID == SYSTEM_V_SMID || iSMID == MASTER_V_SMID;
+}
+
+}
@@ -0,0 +1,148 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#pragma once
+
+#include "utils_include.h"
+#include "phxpaxos/sm.h"
+#include "job_scheduler.h"
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+
+namespace phxpaxos
+{
+
+class Config;
+class SMFac;
+class CheckpointMgr;
+class CommitCtx;
+class Committer;
+class IOLoop;
+class Replayer;
+
+//failed execute retry wait, double from min to max.
+#define APPLIER_RETRY_MIN_WAIT_MS 10
+#define APPLIER_RETRY_MAX_WAIT_MS 1000
+//idle applier wake up at least this often.
+#define APPLIER_IDLE_WAIT_MS 1000
+//instances applied in one slice, then other jobs of the scheduler get their turn.
+#define APPLIER_MAX_APPLY_PER_SLICE 32
+
+class ApplyTask
+{
+public:
+    ApplyTask();
+
+    uint64_t llInstanceID;
+    std::string sValue;
+    SMCtx * poSMCtx;
+
+    //not null if this instance is my commit, finish it after execute.
+    CommitCtx * poCommitCtx;
+    bool bIsAsyncCommit;
+};
+
+//Execute chosen instances in order on its own thread or as a scheduler job, so a slow
+//state machine don't block the ioloop. Ioloop can run ahead up to iMaxApplyLag instances,
+//checkpoint replayer run here too if it is used.
+class Applier : public Thread, public ScheduledJob
+{
+public:
+    Applier(
+            Config * poConfig,
+            SMFac * poSMFac,
+            CheckpointMgr * poCheckpointMgr,
+            Committer * poCommitter,
+            IOLoop * poIOLoop,
+            const int iMaxApplyLag);
+
+    ~Applier();
+
+    void Start(const uint64_t llNowInstanceID, JobScheduler * poScheduler = nullptr);
+
+    //call after ioloop stop, proposals not applied yet fail.
+    void Stop();
+
+    void run();
+
+    //apply a few instances, play replayer while idle, return ms until next slice.
+    int RunSlice();
+
+    const bool IsOpen() const;
+
+public:
+    //called by ioloop, false if apply lag reach iMaxApplyLag, or not all applied when bNeedIdle,
+    //then ioloop is notified once applier can take the next one.
+    bool CanAdd(const bool bNeedIdle);
+
+    //called by ioloop after CanAdd, never block.
+    void Add(const uint64_t llInstanceID, const std::string & sValue, SMCtx * poSMCtx, CommitCtx * poCommitCtx);
+
+    //system variables and master change how paxos run, ioloop execute them itself
+    //once all before applied, so the next instance see them.
+    const bool IsSystemValue(const std::string & sValue) const;
+
+    //called by ioloop after it execute an instance itself.
+    void SetAppliedInstanceID(const uint64_t llAppliedInstanceID);
+
+    const uint64_t GetAppliedInstanceID() const;
+
+    //wait until instances before llInstanceID applied, return false if timeout.
+    bool WaitApplied(const uint64_t llInstanceID, const int iTimeoutMs);
+
+private:
+    void SetEnd();
+
+    bool ApplyOne(ApplyTask & oTask);
+
+    void FinishCommit(ApplyTask & oTask, const int iCommitRet);
+
+
+private:
+    Config * m_poConfig;
+    SMFac * m_poSMFac;
+    CheckpointMgr * m_poCheckpointMgr;
+    Committer * m_poCommitter;
+    IOLoop * m_poIOLoop;
+    Replayer * m_poReplayer;
+    int m_iMaxApplyLag;
+
+    std::mutex m_oMutex;
+    std::condition_variable m_oAddCond;
+    std::condition_variable m_oApplyCond;
+    std::deque<ApplyTask> m_dequeTask;
+    bool m_bIsApplying;
+    bool m_bIsIOLoopWaiting;
+
+    //task out of queue, only used by apply slices.
+    ApplyTask m_oApplyingTask;
+    int m_iRetryWaitMs;
+    uint64_t m_llNextRetryTime;
+
+    std::atomic<uint64_t> m_llAppliedInstanceID;
+
+    bool m_bIsStarted;
+    bool m_bIsEnd;
+};
+
+}
@@ -23,6 +23,7 @@ See the AUTHORS file for names of contributors.
 #include "msg_transport.h"
 #include "instance.h"
 #include "crc32.h"
+#include "compact_paxos_msg.h"
 
 namespace phxpaxos 
 {
@@ -67,86 +68,99 @@ const uint32_t Base :: GetLastChecksum() const
 
 int Base :: PackMsg(const PaxosMsg & oPaxosMsg, std::string & sBuffer)
 {
-    std::string sBodyBuffer;
-    bool bSucc = oPaxosMsg.SerializeToString(&sBodyBuffer);
+    sBuffer.clear();
+    sBuffer.reserve(PACK_MSG_RESERVE_LEN + oPaxosMsg.value().size());
+
+    if (m_poConfig->UseCompactPaxosMsg() && CompactPaxosMsg::CanPack(oPaxosMsg))
+    {
+        PackBaseMsgHead(MsgCmd_PaxosMsg, HEADER_VERSION_COMPACT_PAXOSMSG, sBuffer);
+        CompactPaxosMsg::Pack(oPaxosMsg, sBuffer);
+        PackBaseMsgTail(sBuffer);
+        return 0;
+    }
+
+    PackBaseMsgHead(MsgCmd_PaxosMsg, 1, sBuffer);
+
+    bool bSucc = oPaxosMsg.AppendToString(&sBuffer);
     if (!bSucc)
     {
-        PLGErr("PaxosMsg.SerializeToString fail, skip this msg");
+        PLGErr("PaxosMsg.AppendToString fail, skip this msg");
         return -1;
     }
 
-    int iCmd = MsgCmd_PaxosMsg;
-    PackBaseMsg(sBodyBuffer, iCmd, sBuffer);
+    PackBaseMsgTail(sBuffer);
 
     return 0;
 }
 
 int Base :: PackCheckpointMsg(const CheckpointMsg & oCheckpointMsg, std::string & sBuffer)
 {
-    std::string sBodyBuffer;
-    bool bSucc = oCheckpointMsg.SerializeToString(&sBodyBuffer);
+    sBuffer.clear();
+    sBuffer.reserve(PACK_MSG_RESERVE_LEN + oCheckpointMsg.buffer().size());
+
+    PackBaseMsgHead(MsgCmd_CheckpointMsg, 1, sBuffer);
+
+    bool bSucc = oCheckpointMsg.AppendToString(&sBuffer);
     if (!bSucc)
     {
-        PLGErr("CheckpointMsg.SerializeToString fail, skip this msg");
+        PLGErr("CheckpointMsg.AppendToString fail, skip this msg");
         return -1;
     }
 
-    int iCmd = MsgCmd_CheckpointMsg;
-    PackBaseMsg(sBodyBuffer, iCmd, sBuffer);
+    PackBaseMsgTail(sBuffer);
 
     return 0;
 }
 
-void Base :: PackBaseMsg(const std::string & sBodyBuffer, const int iCmd, std::string & sBuffer)
+void Base :: PackBaseMsgHead(const int iCmd, const int iVersion, std::string & sBuffer)
 {
-    char sGroupIdx[GROUPIDXLEN] = {0};
     int iGroupIdx = m_poConfig->GetMyGroupIdx();
-    memcpy(sGroupIdx, &iGroupIdx, sizeof(sGroupIdx));
+    sBuffer.append((const char *)&iGroupIdx, GROUPIDXLEN);
 
     Header oHeader;
     oHeader.set_gid(m_poConfig->GetGid());
     oHeader.set_rid(0);
     oHeader.set_cmdid(iCmd);
-    oHeader.set_version(1);
+    oHeader.set_version(iVersion);
+
+    //header len is filled after header serialized in place.
+    size_t iHeaderLenPos = sBuffer.size();
+    sBuffer.append(HEADLEN_LEN, '\0');
 
-    std::string sHeaderBuffer;
-    bool bSucc = oHeader.SerializeToString(&sHeaderBuffer);
+    bool bSucc = oHeader.AppendToString(&sBuffer);
     if (!bSucc)
     {
-        PLGErr("Header.SerializeToString fail, skip this msg");
+        PLGErr("Header.AppendToString fail, skip this msg");
         assert(bSucc == true);
     }
 
-    char sHeaderLen[HEADLEN_LEN] = {0};
-    uint16_t iHeaderLen = (uint16_t)sHeaderBuffer.size();
-    memcpy(sHeaderLen, &iHeaderLen, sizeof(sHeaderLen));
-
-    sBuffer = string(sGroupIdx, sizeof(sGroupIdx)) + string(sHeaderLen, sizeof(sHeaderLen)) + sHeaderBuffer + sBodyBuffer;
+    uint16_t iHeaderLen = (uint16_t)(sBuffer.size() - iHeaderLenPos - HEADLEN_LEN);
+    memcpy(&sBuffer[iHeaderLenPos], &iHeaderLen, HEADLEN_LEN);
+}
 
+void Base :: PackBaseMsgTail(std::string & sBuffer)
+{
     //check sum
     uint32_t iBufferChecksum = crc32(0, (const uint8_t *)sBuffer.data(), sBuffer.size(), NET_CRC32SKIP);
-    char sBufferChecksum[CHECKSUM_LEN] = {0};
-    memcpy(sBufferChecksum, &iBufferChecksum, sizeof(sBufferChecksum));
-
-    sBuffer += string(sBufferChecksum, sizeof(sBufferChecksum));
+    sBuffer.append((const char *)&iBufferChecksum, CHECKSUM_LEN);
 }
 
-int Base :: UnPackBaseMsg(const std::string & sBuffer, Header & oHeader, size_t & iBodyStartPos, size_t & iBodyLen)
+int Base :: UnPackBaseMsg(const char * pcBuffer, const size_t iBufferLen, Header & oHeader, size_t & iBodyStartPos, size_t & iBodyLen)
 {
     uint16_t iHeaderLen = 0;
-    memcpy(&iHeaderLen, sBuffer.data() + GROUPIDXLEN, HEADLEN_LEN);
+    memcpy(&iHeaderLen, pcBuffer + GROUPIDXLEN, HEADLEN_LEN);
 
     size_t iHeaderStartPos = GROUPIDXLEN + HEADLEN_LEN;
     iBodyStartPos = iHeaderStartPos + iHeaderLen;
 
-    if (iBodyStartPos > sBuffer.size())
+    if (iBodyStartPos > iBufferLen)
     {
         BP->GetAlgorithmBaseBP()->UnPackHeaderLenTooLong();
         NLErr("Header headerlen too loog %d", iHeaderLen);
         return -1;
     }
 
-    bool bSucc = oHeader.ParseFromArray(sBuffer.data() + iHeaderStartPos, iHeaderLen);
+    bool bSucc = oHeader.ParseFromArray(pcBuffer + iHeaderStartPos, iHeaderLen);
     if (!bSucc)
     {
         NLErr("Header.ParseFromArray fail, skip this msg");
@@ -154,22 +168,22 @@ int Base :: UnPackBaseMsg(const std::string & sBuffer, Header & oHeader, size_t
     }
 
     NLDebug("buffer_size %zu header len %d cmdid %d gid %lu rid %lu version %d body_startpos %zu", 
-            sBuffer.size(), iHeaderLen, oHeader.cmdid(), oHeader.gid(), oHeader.rid(), oHeader.version(), iBodyStartPos);
+            iBufferLen, iHeaderLen, oHeader.cmdid(), oHeader.gid(), oHeader.rid(), oHeader.version(), iBodyStartPos);
 
     if (oHeader.version() >= 1)
     {
-        if (iBodyStartPos + CHECKSUM_LEN > sBuffer.size())
+        if (iBodyStartPos + CHECKSUM_LEN > iBufferLen)
         {
-            NLErr("no checksum, body start pos %zu buffersize %zu", iBodyStartPos, sBuffer.size());
+            NLErr("no checksum, body start pos %zu buffersize %zu", iBodyStartPos, iBufferLen);
             return -1;
         }
 
-        iBodyLen = sBuffer.size() - CHECKSUM_LEN - iBodyStartPos;
+        iBodyLen = iBufferLen - CHECKSUM_LEN - iBodyStartPos;
 
         uint32_t iBufferChecksum = 0;
-        memcpy(&iBufferChecksum, sBuffer.data() + sBuffer.size() - CHECKSUM_LEN, CHECKSUM_LEN);
+        memcpy(&iBufferChecksum, pcBuffer + iBufferLen - CHECKSUM_LEN, CHECKSUM_LEN);
         
-        uint32_t iNewCalBufferChecksum = crc32(0, (const uint8_t *)sBuffer.data(), sBuffer.size() - CHECKSUM_LEN, NET_CRC32SKIP);
+        uint32_t iNewCalBufferChecksum = crc32(0, (const uint8_t *)pcBuffer, iBufferLen - CHECKSUM_LEN, NET_CRC32SKIP);
         if (iNewCalBufferChecksum != iBufferChecksum)
         {
             BP->GetAlgorithmBaseBP()->UnPackChecksumNotSame();
@@ -185,7 +199,24 @@ int Base :: UnPackBaseMsg(const std::string & sBuffer, Header & oHeader, size_t
     }
     else
     {
-        iBodyLen = sBuffer.size() - iBodyStartPos;
+        iBodyLen = iBufferLen - iBodyStartPos;
+    }
+
+    return 0;
+}
+
+int Base :: UnPackPaxosMsg(const Header & oHeader, const char * pcBody, const size_t iBodyLen, PaxosMsg & oPaxosMsg)
+{
+    if (oHeader.version() == HEADER_VERSION_COMPACT_PAXOSMSG)
+    {
+        return CompactPaxosMsg::UnPack(pcBody, iBodyLen, oPaxosMsg);
+    }
+
+    bool bSucc = oPaxosMsg.ParseFromArray(pcBody, iBodyLen);
+    if (!bSucc)
+    {
+        NLErr("PaxosMsg.ParseFromArray fail");
+        return -1;
     }
 
     return 0;
@@ -259,7 +290,7 @@ int Base :: BroadcastMessage(const PaxosMsg & oPaxosMsg, const int iRunType, con
         return ret;
     }
 
-    ret = m_poMsgTransport->BroadcastMessage(sBuffer, iSendType);
+    ret = m_poMsgTransport->BroadcastMessage(std::make_shared<const std::string>(std::move(sBuffer)), iSendType);
 
     if (iRunType == BroadcastMessage_Type_RunSelf_Final)
     {
@@ -279,7 +310,7 @@ int Base :: BroadcastMessageToFollower(const PaxosMsg & oPaxosMsg, const int iSe
         return ret;
     }
 
-    return m_poMsgTransport->BroadcastMessageFollower(sBuffer, iSendType);
+    return m_poMsgTransport->BroadcastMessageFollower(std::make_shared<const std::string>(std::move(sBuffer)), iSendType);
 }
 
 // ʱ֪ temp ڵô
@@ -292,7 +323,7 @@ int Base :: BroadcastMessageToTempNode(const PaxosMsg & oPaxosMsg, const int iSe
         return ret;
     }
 
-    return m_poMsgTransport->BroadcastMessageTempNode(sBuffer, iSendType);
+    return m_poMsgTransport->BroadcastMessageTempNode(std::make_shared<const std::string>(std::move(sBuffer)), iSendType);
 }
 
 ///////////////////////////
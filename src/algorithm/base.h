@@ -33,6 +33,9 @@ namespace phxpaxos
 #define HEADLEN_LEN (sizeof(uint16_t))
 #define CHECKSUM_LEN (sizeof(uint32_t))
 
+//reserved for groupidx, header, fixed fields and checksum when packing, besides the value.
+#define PACK_MSG_RESERVE_LEN 128
+
 
 class BallotNumber
 {
@@ -128,9 +131,15 @@ public:
 public:
     const uint32_t GetLastChecksum() const;
     
-    void PackBaseMsg(const std::string & sBodyBuffer, const int iCmd, std::string & sBuffer);
+    //body is serialized into sBuffer between head and tail, no temporary buffers.
+    void PackBaseMsgHead(const int iCmd, const int iVersion, std::string & sBuffer);
+
+    void PackBaseMsgTail(std::string & sBuffer);
+
+    static int UnPackBaseMsg(const char * pcBuffer, const size_t iBufferLen, Header & oHeader, size_t & iBodyStartPos, size_t & iBodyLen);
 
-    static int UnPackBaseMsg(const std::string & sBuffer, Header & oHeader, size_t & iBodyStartPos, size_t & iBodyLen);
+    //parse paxosmsg body by header version, protobuf or compact layout.
+    static int UnPackPaxosMsg(const Header & oHeader, const char * pcBody, const size_t iBodyLen, PaxosMsg & oPaxosMsg);
 
     void SetAsTestMode();
 
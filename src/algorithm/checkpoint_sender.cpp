@@ -249,7 +249,7 @@ int CheckpointSender :: SendFile(const StateMachine * poSM, const std::string &
         return 0;
     }
 
-    int iFD = open(sPath.c_str(), O_RDWR, S_IREAD);
+    int iFD = open(sPath.c_str(), O_RDONLY);
 
     if (iFD == -1)
     {
@@ -257,6 +257,9 @@ int CheckpointSender :: SendFile(const StateMachine * poSM, const std::string &
         return -1;
     }
 
+    //file is read once from head to tail, let kernel read ahead more.
+    posix_fadvise(iFD, 0, 0, POSIX_FADV_SEQUENTIAL);
+
     ssize_t iReadLen = 0;
     size_t llOffset = 0;
     while (true)
@@ -352,18 +355,27 @@ void CheckpointSender :: Ack(const nodeid_t iSendNodeID, const uint64_t llUUID,
         return;
     }
 
-    if (llSequence != m_llAckSequence)
+    m_oAckLock.Lock();
+
+    if (llSequence < m_llAckSequence)
     {
-        PLGErr("ack_sequence not same, ack.ack_sequence %lu self.ack_sequence %lu", llSequence, m_llAckSequence);
+        PLGErr("ack_sequence lag, ack.ack_sequence %lu self.ack_sequence %lu", llSequence, m_llAckSequence);
+        m_oAckLock.UnLock();
         return;
     }
 
-    m_llAckSequence++;
+    //receiver only accept blocks in order, so an ack also cover all blocks before it.
+    m_llAckSequence = llSequence + 1;
     m_llAbsLastAckTime = Time::GetSteadyClockMS();
+
+    m_oAckLock.Interupt();
+    m_oAckLock.UnLock();
 }
 
 const bool CheckpointSender :: CheckAck(const uint64_t llSendSequence)
 {
+    m_oAckLock.Lock();
+
     while (llSendSequence > m_llAckSequence + Checkpoint_ACK_LEAD)
     {
         uint64_t llNowTime = Time::GetSteadyClockMS();
@@ -371,20 +383,25 @@ const bool CheckpointSender :: CheckAck(const uint64_t llSendSequence)
 
         if (m_bIsEnd)
         {
+            m_oAckLock.UnLock();
             return false;
         }
 
         if (llPassTime >= Checkpoint_ACK_TIMEOUT)
         {       
             PLGErr("Ack timeout, last acktime %lu", m_llAbsLastAckTime);
+            m_oAckLock.UnLock();
             return false;
         }       
 
         //PLGErr("Need sleep to slow down send speed, sendsequence %lu acksequence %lu",
                 //llSendSequence, m_llAckSequence);
-        Time::MsSleep(20);
+        //Ack wake us up as soon as window open, timeout only for End and ack timeout check.
+        m_oAckLock.WaitTime(20);
     }
 
+    m_oAckLock.UnLock();
+
     return true;
 }
     
@@ -91,6 +91,7 @@ private:
     uint64_t m_llSequence;
 
 private:
+    SerialLock m_oAckLock;
     uint64_t m_llAckSequence;
     uint64_t m_llAbsLastAckTime;
 
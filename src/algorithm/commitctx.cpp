@@ -26,7 +26,7 @@ namespace phxpaxos
 {
 
 CommitCtx :: CommitCtx(Config * poConfig)
-    : m_poConfig(poConfig)
+    : m_poConfig(poConfig), m_iAsyncRetryCount(0)
 {
     NewCommit(nullptr, nullptr, 0);
 }
@@ -42,11 +42,16 @@ void CommitCtx :: NewCommit(std::string * psValue, SMCtx * poSMCtx, const int iT
     m_llInstanceID = (uint64_t)-1;
     m_iCommitRet = -1;
     m_bIsCommitEnd = false;
+    m_bIsApplying = false;
     m_iTimeoutMs = iTimeoutMs;
+    m_llDeadlineMs = iTimeoutMs >= 0 ? Time::GetSteadyClockMS() + iTimeoutMs : 0;
 
     m_psValue = psValue;
     m_poSMCtx = poSMCtx;
 
+    m_llNewCommitTimeUs = Time::GetSteadyClockUS();
+    m_llEndCommitTimeUs = 0;
+
     if (psValue != nullptr)
     {
         PLGHead("OK, valuesize %zu", psValue->size());
@@ -56,6 +61,17 @@ void CommitCtx :: NewCommit(std::string * psValue, SMCtx * poSMCtx, const int iT
 }
 
 
+void CommitCtx :: NewAsyncCommit(const std::string & sValue, SMCtx * poSMCtx, const int iTimeoutMs, 
+        ProposeCallback pCallback)
+{
+    //same retry times as Committer::NewValueGetID.
+    m_sAsyncValue = sValue;
+    m_pCallback = pCallback;
+    m_iAsyncRetryCount = 2;
+
+    NewCommit(&m_sAsyncValue, poSMCtx, iTimeoutMs);
+}
+
 const bool CommitCtx :: IsNewCommit() const
 {
     return m_llInstanceID == (uint64_t)-1 && m_psValue != nullptr;
@@ -71,6 +87,9 @@ void CommitCtx :: StartCommit(const uint64_t llInstanceID)
     m_oSerialLock.Lock();
     m_llInstanceID = llInstanceID;
     m_oSerialLock.UnLock();
+
+    BP->GetLatencyBP()->StageUseTimeUs(m_poConfig->GetMyGroupIdx(), LatencyStage_Queue,
+            Time::GetSteadyClockUS() - m_llNewCommitTimeUs);
 }
 
 bool CommitCtx :: IsMyCommit(const uint64_t llInstanceID, const std::string & sLearnValue,  SMCtx *& poSMCtx)
@@ -94,24 +113,71 @@ bool CommitCtx :: IsMyCommit(const uint64_t llInstanceID, const std::string & sL
     return bIsMyCommit;
 }
 
-void CommitCtx :: SetResultOnlyRet(const int iCommitRet)
+bool CommitCtx :: SetResultOnlyRet(const int iCommitRet)
 {
     return SetResult(iCommitRet, (uint64_t)-1, "");
 }
 
-void CommitCtx :: SetResult(
+//return true if this call end the commit.
+//after that, the commit owner may reuse this ctx at any time.
+bool CommitCtx :: SetResult(
         const int iCommitRet, 
         const uint64_t llInstanceID, 
         const std::string & sLearnValue)
 {
     m_oSerialLock.Lock();
 
-    if (m_bIsCommitEnd || (m_llInstanceID != llInstanceID))
+    if (m_bIsCommitEnd || m_bIsApplying || (m_llInstanceID != llInstanceID))
+    {
+        m_oSerialLock.UnLock();
+        return false;
+    }
+
+    EndCommit(iCommitRet, sLearnValue);
+
+    m_oSerialLock.UnLock();
+
+    return true;
+}
+
+bool CommitCtx :: DetachForApply(const uint64_t llInstanceID)
+{
+    m_oSerialLock.Lock();
+
+    if (m_bIsCommitEnd || m_bIsApplying || (m_llInstanceID != llInstanceID))
+    {
+        m_oSerialLock.UnLock();
+        return false;
+    }
+
+    m_bIsApplying = true;
+
+    m_oSerialLock.UnLock();
+
+    return true;
+}
+
+bool CommitCtx :: SetApplyResult(const int iCommitRet, const uint64_t llInstanceID, const std::string & sLearnValue)
+{
+    m_oSerialLock.Lock();
+
+    if (m_bIsCommitEnd || !m_bIsApplying || (m_llInstanceID != llInstanceID))
     {
         m_oSerialLock.UnLock();
-        return;
+        return false;
     }
 
+    m_bIsApplying = false;
+    EndCommit(iCommitRet, sLearnValue);
+
+    m_oSerialLock.UnLock();
+
+    return true;
+}
+
+//called with m_oSerialLock locked.
+void CommitCtx :: EndCommit(const int iCommitRet, const std::string & sLearnValue)
+{
     m_iCommitRet = iCommitRet;
 
     if (m_iCommitRet == 0)
@@ -124,9 +190,9 @@ void CommitCtx :: SetResult(
 
     m_bIsCommitEnd = true;
     m_psValue = nullptr;
+    m_llEndCommitTimeUs = Time::GetSteadyClockUS();
 
     m_oSerialLock.Interupt();
-    m_oSerialLock.UnLock();
 }
 
 
@@ -139,6 +205,9 @@ int CommitCtx :: GetResult(uint64_t & llSuccInstanceID)
         m_oSerialLock.WaitTime(1000);
     }
 
+    BP->GetLatencyBP()->StageUseTimeUs(m_poConfig->GetMyGroupIdx(), LatencyStage_Notify,
+            Time::GetSteadyClockUS() - m_llEndCommitTimeUs);
+
     if (m_iCommitRet == 0)
     {
         llSuccInstanceID = m_llInstanceID;
@@ -154,11 +223,107 @@ int CommitCtx :: GetResult(uint64_t & llSuccInstanceID)
     return m_iCommitRet;
 }
 
+bool CommitCtx :: WaitCommitEnd(const int iTimeoutMs)
+{
+    uint64_t llDeadlineMs = Time::GetSteadyClockMS() + iTimeoutMs;
+
+    m_oSerialLock.Lock();
+
+    while (!m_bIsCommitEnd)
+    {
+        uint64_t llNowMs = Time::GetSteadyClockMS();
+        if (llNowMs >= llDeadlineMs)
+        {
+            break;
+        }
+
+        m_oSerialLock.WaitTime((int)(llDeadlineMs - llNowMs));
+    }
+
+    bool bIsCommitEnd = m_bIsCommitEnd;
+
+    m_oSerialLock.UnLock();
+
+    return bIsCommitEnd;
+}
+
+const bool CommitCtx :: IsAsyncCommit() const
+{
+    return m_pCallback != nullptr;
+}
+
+//only conflict value can retry, master sm not retry.
+const bool CommitCtx :: RetryAsyncCommit()
+{
+    if (m_iCommitRet != PaxosTryCommitRet_Conflict || m_iAsyncRetryCount <= 0)
+    {
+        return false;
+    }
+
+    if (m_poSMCtx != nullptr && m_poSMCtx->m_iSMID == MASTER_V_SMID)
+    {
+        return false;
+    }
+
+    m_iAsyncRetryCount--;
+    NewCommit(&m_sAsyncValue, m_poSMCtx, m_iTimeoutMs);
+
+    return true;
+}
+
+void CommitCtx :: FinishAsyncCommit(const int iCommitRet)
+{
+    ProposeCallback pCallback;
+    uint64_t llInstanceID = (uint64_t)-1;
+
+    m_oSerialLock.Lock();
+
+    pCallback.swap(m_pCallback);
+    if (iCommitRet == 0)
+    {
+        llInstanceID = m_llInstanceID;
+    }
+
+    m_sAsyncValue.clear();
+    m_poSMCtx = nullptr;
+
+    uint64_t llEndCommitTimeUs = m_llEndCommitTimeUs;
+
+    m_oSerialLock.UnLock();
+
+    if (pCallback != nullptr)
+    {
+        if (llEndCommitTimeUs > 0)
+        {
+            BP->GetLatencyBP()->StageUseTimeUs(m_poConfig->GetMyGroupIdx(), LatencyStage_Notify,
+                    Time::GetSteadyClockUS() - llEndCommitTimeUs);
+        }
+
+        pCallback(iCommitRet, llInstanceID, 0);
+    }
+}
+
+const int CommitCtx :: GetCommitRet() const
+{
+    return m_iCommitRet;
+}
+
 const int CommitCtx :: GetTimeoutMs() const
 {
     return m_iTimeoutMs;
 }
 
+const int CommitCtx :: GetLeftTimeoutMs() const
+{
+    if (m_iTimeoutMs < 0)
+    {
+        return -1;
+    }
+
+    uint64_t llNowMs = Time::GetSteadyClockMS();
+    return llNowMs < m_llDeadlineMs ? (int)(m_llDeadlineMs - llNowMs) : 0;
+}
+
 }
 
 
@@ -24,6 +24,7 @@ See the AUTHORS file for names of contributors.
 #include <string>
 #include "comm_include.h"
 #include "config_include.h"
+#include "phxpaxos/node.h"
 
 namespace phxpaxos
 {
@@ -37,6 +38,9 @@ public:
     ~CommitCtx();
 
     void NewCommit(std::string * psValue, SMCtx * poSMCtx, const int iTimeoutMs);
+
+    void NewAsyncCommit(const std::string & sValue, SMCtx * poSMCtx, const int iTimeoutMs, 
+            ProposeCallback pCallback);
     
     const bool IsNewCommit() const;
 
@@ -47,25 +51,59 @@ public:
     bool IsMyCommit(const uint64_t llInstanceID, const std::string & sLearnValue, SMCtx *& poSMCtx);
 
 public:
-    void SetResult(const int iCommitRet, const uint64_t llInstanceID, const std::string & sLearnValue);
+    bool SetResult(const int iCommitRet, const uint64_t llInstanceID, const std::string & sLearnValue);
+
+    bool SetResultOnlyRet(const int iCommitRet);
 
-    void SetResultOnlyRet(const int iCommitRet);
+    //chosen but wait for apply thread, only SetApplyResult can end it.
+    bool DetachForApply(const uint64_t llInstanceID);
+
+    bool SetApplyResult(const int iCommitRet, const uint64_t llInstanceID, const std::string & sLearnValue);
 
     int GetResult(uint64_t & llSuccInstanceID);
 
+    //wait up to iTimeoutMs, return true if commit end.
+    bool WaitCommitEnd(const int iTimeoutMs);
+
+public:
+    //async commit, no thread wait on it, owner finish it when commit end.
+    const bool IsAsyncCommit() const;
+
+    const bool RetryAsyncCommit();
+
+    void FinishAsyncCommit(const int iCommitRet);
+
+    const int GetCommitRet() const;
+
 public:
     const int GetTimeoutMs() const;
 
+    //timeout count from NewCommit, so the time waiting in propose window is included.
+    //-1 means no timeout, 0 means already timeout.
+    const int GetLeftTimeoutMs() const;
+
+private:
+    void EndCommit(const int iCommitRet, const std::string & sLearnValue);
+
 private:
     Config * m_poConfig;
 
     uint64_t m_llInstanceID;
     int m_iCommitRet;
     bool m_bIsCommitEnd;
+    bool m_bIsApplying;
     int m_iTimeoutMs;
+    uint64_t m_llDeadlineMs;
 
     std::string * m_psValue;
     SMCtx * m_poSMCtx;
     SerialLock m_oSerialLock;
+
+    std::string m_sAsyncValue;
+    ProposeCallback m_pCallback;
+    int m_iAsyncRetryCount;
+
+    uint64_t m_llNewCommitTimeUs;
+    uint64_t m_llEndCommitTimeUs;
 };
 }
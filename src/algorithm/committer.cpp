@@ -27,14 +27,38 @@ See the AUTHORS file for names of contributors.
 namespace phxpaxos
 {
 
-Committer :: Committer(Config * poConfig, CommitCtx * poCommitCtx, IOLoop * poIOLoop, SMFac * poSMFac)
-    : m_poConfig(poConfig), m_poCommitCtx(poCommitCtx), m_poIOLoop(poIOLoop), m_poSMFac(poSMFac), m_iTimeoutMs(-1)
+Committer :: Committer(Config * poConfig, CommitCtx * poCommitCtx, IOLoop * poIOLoop, SMFac * poSMFac,
+        const int iProposeWindowSize, const int iAsyncProposeQueueSize)
+    : m_poConfig(poConfig), m_poCommitCtx(poCommitCtx), m_poIOLoop(poIOLoop), m_poSMFac(poSMFac), m_iTimeoutMs(-1),
+    m_iAsyncProposeQueueSize(iAsyncProposeQueueSize)
 {
     m_llLastLogTime = Time::GetSteadyClockMS();
+
+    for (int i = 0; i < iProposeWindowSize; i++)
+    {
+        CommitCtx * poWindowCommitCtx = new CommitCtx(poConfig);
+        m_vecWindowCommitCtx.push_back(poWindowCommitCtx);
+        m_oFreeCommitCtxQueue.add(poWindowCommitCtx);
+    }
 }
 
 Committer :: ~Committer()
 {
+    for (auto & poWindowCommitCtx : m_vecWindowCommitCtx)
+    {
+        //ioloop already stop, async commit not end yet will never end.
+        if (poWindowCommitCtx->IsAsyncCommit())
+        {
+            poWindowCommitCtx->FinishAsyncCommit(Paxos_SystemError);
+        }
+
+        delete poWindowCommitCtx;
+    }
+
+    for (auto & oAsyncProposal : m_dequeAsyncProposal)
+    {
+        oAsyncProposal.pCallback(Paxos_SystemError, (uint64_t)-1, 0);
+    }
 }
 
 int Committer :: NewValue(const std::string & sValue)
@@ -92,6 +116,7 @@ int Committer :: NewValueGetIDNoRetry(const std::string & sValue, uint64_t & llI
     LogStatus();
 
     int iLockUseTimeMs = 0;
+    uint64_t llLockBeginTimeUs = Time::GetSteadyClockUS();
     bool bHasLock = m_oWaitLock.Lock(m_iTimeoutMs, iLockUseTimeMs);
     if (!bHasLock)
     {
@@ -130,6 +155,8 @@ int Committer :: NewValueGetIDNoRetry(const std::string & sValue, uint64_t & llI
     PLGImp("GetLock ok, use time %dms", iLockUseTimeMs);
     
     BP->GetCommiterBP()->NewValueGetLockOK(iLockUseTimeMs);
+    BP->GetLatencyBP()->StageUseTimeUs(m_poConfig->GetMyGroupIdx(), LatencyStage_WaitLock,
+            Time::GetSteadyClockUS() - llLockBeginTimeUs);
 
     //pack smid to value
     int iSMID = poSMCtx != nullptr ? poSMCtx->m_iSMID : 0;
@@ -138,6 +165,11 @@ int Committer :: NewValueGetIDNoRetry(const std::string & sValue, uint64_t & llI
     // ϢҪϲһ iSMID Ϊ״̬ıʶԺ״ִ̬С
     m_poSMFac->PackPaxosValue(sPackSMIDValue, iSMID);
 
+    if (IsUseProposeWindow())
+    {
+        return NewValueGetIDInWindow(sPackSMIDValue, poSMCtx, iLeftTimeoutMs, llInstanceID);
+    }
+
     // ʼ commit ࡣ 
     m_poCommitCtx->NewCommit(&sPackSMIDValue, poSMCtx, iLeftTimeoutMs);
     // ߡ
@@ -150,6 +182,207 @@ int Committer :: NewValueGetIDNoRetry(const std::string & sValue, uint64_t & llI
     return ret;
 }
 
+//Propose window mode: the waitlock only protect enqueue, so up to window size values
+//can wait in ioloop at the same time, and the next one start right after the last
+//instance chosen, while the proposer thread of the last one is still waking up.
+int Committer :: NewValueGetIDInWindow(std::string & sPackSMIDValue, SMCtx * poSMCtx, 
+        const int iLeftTimeoutMs, uint64_t & llInstanceID)
+{
+    TimeStat oTimeStat;
+    oTimeStat.Point();
+
+    CommitCtx * poCommitCtx = nullptr;
+    bool bHasCommitCtx = true;
+
+    m_oFreeCommitCtxQueue.lock();
+    if (iLeftTimeoutMs == -1)
+    {
+        m_oFreeCommitCtxQueue.peek(poCommitCtx);
+    }
+    else
+    {
+        bHasCommitCtx = m_oFreeCommitCtxQueue.peek(poCommitCtx, iLeftTimeoutMs);
+    }
+
+    if (bHasCommitCtx)
+    {
+        m_oFreeCommitCtxQueue.pop();
+    }
+    m_oFreeCommitCtxQueue.unlock();
+
+    int iWaitWindowTimeMs = oTimeStat.Point();
+    int iCommitTimeoutMs = iLeftTimeoutMs;
+    if (bHasCommitCtx && iLeftTimeoutMs != -1)
+    {
+        iCommitTimeoutMs = iLeftTimeoutMs > iWaitWindowTimeMs ? iLeftTimeoutMs - iWaitWindowTimeMs : 0;
+        bHasCommitCtx = iCommitTimeoutMs > 0;
+
+        if (!bHasCommitCtx)
+        {
+            ReleaseWindowCommitCtx(poCommitCtx);
+        }
+    }
+
+    if (!bHasCommitCtx)
+    {
+        BP->GetCommiterBP()->NewValueGetLockTimeout();
+        PLGErr("Wait propose window timeout, window size %zu wait time %dms", 
+                m_vecWindowCommitCtx.size(), iWaitWindowTimeMs);
+
+        m_oWaitLock.UnLock();
+        return PaxosTryCommitRet_Timeout;
+    }
+
+    poCommitCtx->NewCommit(&sPackSMIDValue, poSMCtx, iCommitTimeoutMs);
+
+    m_oWaitingCommitCtxQueue.lock();
+    m_oWaitingCommitCtxQueue.add(poCommitCtx);
+    m_oWaitingCommitCtxQueue.unlock();
+
+    //let next proposer enqueue while we are waiting.
+    m_oWaitLock.UnLock();
+
+    m_poIOLoop->AddNotify();
+
+    //commits before it in the window are slow, it is still in queue at its deadline,
+    //take it back so ioloop never start it. once ioloop take it, ioloop's commit timer end it.
+    if (iCommitTimeoutMs != -1 && !poCommitCtx->WaitCommitEnd(iCommitTimeoutMs)
+            && RemoveWaitingCommitCtx(poCommitCtx))
+    {
+        PLGErr("Wait in propose window timeout, timeout %dms", iCommitTimeoutMs);
+        poCommitCtx->SetResultOnlyRet(PaxosTryCommitRet_Timeout);
+    }
+
+    int ret = poCommitCtx->GetResult(llInstanceID);
+
+    ReleaseWindowCommitCtx(poCommitCtx);
+
+    return ret;
+}
+
+//Async propose take a free window commit ctx without waiting, or wait in async queue if window
+//is full, the value is copied and the caller return at once, ioloop call OnAsyncCommitEnd when commit end.
+int Committer :: NewValueAsync(const std::string & sValue, SMCtx * poSMCtx, ProposeCallback pCallback)
+{
+    BP->GetCommiterBP()->NewValue();
+
+    if (!IsUseProposeWindow())
+    {
+        PLGErr("Propose window not open, can't propose async");
+        return Paxos_SystemError;
+    }
+
+    if (pCallback == nullptr)
+    {
+        PLGErr("Callback is null");
+        return Paxos_SystemError;
+    }
+
+    LogStatus();
+
+    int iSMID = poSMCtx != nullptr ? poSMCtx->m_iSMID : 0;
+
+    string sPackSMIDValue = sValue;
+    m_poSMFac->PackPaxosValue(sPackSMIDValue, iSMID);
+
+    CommitCtx * poCommitCtx = nullptr;
+
+    std::unique_lock<std::mutex> oLock(m_oAsyncMutex);
+
+    m_oFreeCommitCtxQueue.lock();
+    bool bHasCommitCtx = !m_oFreeCommitCtxQueue.empty();
+    if (bHasCommitCtx)
+    {
+        poCommitCtx = m_oFreeCommitCtxQueue.peek();
+        m_oFreeCommitCtxQueue.pop();
+    }
+    m_oFreeCommitCtxQueue.unlock();
+
+    if (!bHasCommitCtx)
+    {
+        if ((int)m_dequeAsyncProposal.size() >= m_iAsyncProposeQueueSize)
+        {
+            BP->GetCommiterBP()->NewValueGetLockReject();
+            PLGErr("Propose window full and async queue full, window size %zu queue size %zu, reject",
+                    m_vecWindowCommitCtx.size(), m_dequeAsyncProposal.size());
+            return PaxosTryCommitRet_TooManyThreadWaiting_Reject;
+        }
+
+        uint64_t llDeadlineMs = m_iTimeoutMs > 0 ? Time::GetSteadyClockMS() + m_iTimeoutMs : (uint64_t)-1;
+        m_dequeAsyncProposal.push_back(AsyncProposal{sPackSMIDValue, poSMCtx, pCallback, llDeadlineMs});
+        return 0;
+    }
+
+    oLock.unlock();
+
+    StartAsyncCommit(poCommitCtx, sPackSMIDValue, poSMCtx, m_iTimeoutMs, pCallback);
+
+    return 0;
+}
+
+void Committer :: StartAsyncCommit(CommitCtx * poCommitCtx, const std::string & sPackSMIDValue,
+        SMCtx * poSMCtx, const int iTimeoutMs, ProposeCallback pCallback)
+{
+    poCommitCtx->NewAsyncCommit(sPackSMIDValue, poSMCtx, iTimeoutMs, pCallback);
+
+    m_oWaitingCommitCtxQueue.lock();
+    m_oWaitingCommitCtxQueue.add(poCommitCtx);
+    m_oWaitingCommitCtxQueue.unlock();
+
+    m_poIOLoop->AddNotify();
+}
+
+//queued async proposals go before sync proposers waiting for free queue,
+//their timeout count from ProposeAsync, expired ones end with timeout here.
+void Committer :: ReleaseWindowCommitCtx(CommitCtx * poCommitCtx)
+{
+    std::vector<AsyncProposal> vecTimeoutProposal;
+    AsyncProposal oAsyncProposal = {std::string(), nullptr, nullptr, 0};
+    bool bHasAsyncProposal = false;
+    int iLeftTimeoutMs = -1;
+
+    std::unique_lock<std::mutex> oLock(m_oAsyncMutex);
+
+    uint64_t llNowTime = Time::GetSteadyClockMS();
+    while (!m_dequeAsyncProposal.empty())
+    {
+        AsyncProposal & oFront = m_dequeAsyncProposal.front();
+        if (oFront.llDeadlineMs == (uint64_t)-1 || oFront.llDeadlineMs > llNowTime)
+        {
+            iLeftTimeoutMs = oFront.llDeadlineMs == (uint64_t)-1 ? -1 : (int)(oFront.llDeadlineMs - llNowTime);
+            oAsyncProposal = std::move(oFront);
+            m_dequeAsyncProposal.pop_front();
+            bHasAsyncProposal = true;
+            break;
+        }
+
+        vecTimeoutProposal.push_back(std::move(oFront));
+        m_dequeAsyncProposal.pop_front();
+    }
+
+    if (!bHasAsyncProposal)
+    {
+        m_oFreeCommitCtxQueue.lock();
+        m_oFreeCommitCtxQueue.add(poCommitCtx);
+        m_oFreeCommitCtxQueue.unlock();
+    }
+
+    oLock.unlock();
+
+    for (auto & oTimeoutProposal : vecTimeoutProposal)
+    {
+        BP->GetCommiterBP()->NewValueGetLockTimeout();
+        PLGErr("Wait in async propose queue timeout");
+        oTimeoutProposal.pCallback(PaxosTryCommitRet_Timeout, (uint64_t)-1, 0);
+    }
+
+    if (bHasAsyncProposal)
+    {
+        StartAsyncCommit(poCommitCtx, oAsyncProposal.sPackSMIDValue, oAsyncProposal.poSMCtx,
+                iLeftTimeoutMs, oAsyncProposal.pCallback);
+    }
+}
+
 ////////////////////////////////////////////////////
 
 void Committer :: SetTimeoutMs(const int iTimeoutMs)
@@ -167,6 +400,70 @@ void Committer :: SetProposeWaitTimeThresholdMS(const int iWaitTimeThresholdMS)
     m_oWaitLock.SetLockWaitTimeThreshold(iWaitTimeThresholdMS);
 }
 
+bool Committer :: IsUseProposeWindow() const
+{
+    return m_vecWindowCommitCtx.size() > 0;
+}
+
+CommitCtx * Committer :: PopWindowCommitCtx(CommitCtx * poIdleCommitCtx)
+{
+    if (!IsUseProposeWindow())
+    {
+        return poIdleCommitCtx;
+    }
+
+    CommitCtx * poCommitCtx = poIdleCommitCtx;
+
+    m_oWaitingCommitCtxQueue.lock();
+    if (!m_oWaitingCommitCtxQueue.empty())
+    {
+        poCommitCtx = m_oWaitingCommitCtxQueue.peek();
+        m_oWaitingCommitCtxQueue.pop();
+    }
+    m_oWaitingCommitCtxQueue.unlock();
+
+    return poCommitCtx;
+}
+
+bool Committer :: RemoveWaitingCommitCtx(CommitCtx * poCommitCtx)
+{
+    m_oWaitingCommitCtxQueue.lock();
+    bool bIsRemoved = m_oWaitingCommitCtxQueue.remove(poCommitCtx);
+    m_oWaitingCommitCtxQueue.unlock();
+
+    return bIsRemoved;
+}
+
+//called by ioloop thread, or apply thread if state machine execute there.
+void Committer :: OnAsyncCommitEnd(CommitCtx * poCommitCtx)
+{
+    if (poCommitCtx->RetryAsyncCommit())
+    {
+        BP->GetCommiterBP()->NewValueConflict();
+
+        m_oWaitingCommitCtxQueue.lock();
+        m_oWaitingCommitCtxQueue.add(poCommitCtx);
+        m_oWaitingCommitCtxQueue.unlock();
+
+        m_poIOLoop->AddNotify();
+        return;
+    }
+
+    int iCommitRet = poCommitCtx->GetCommitRet();
+    if (iCommitRet == 0)
+    {
+        BP->GetCommiterBP()->NewValueCommitOK(0);
+    }
+    else
+    {
+        BP->GetCommiterBP()->NewValueCommitFail();
+    }
+
+    poCommitCtx->FinishAsyncCommit(iCommitRet);
+
+    ReleaseWindowCommitCtx(poCommitCtx);
+}
+
 ////////////////////////////////////////////////////
 
 void Committer :: LogStatus()
@@ -23,9 +23,15 @@ See the AUTHORS file for names of contributors.
 
 #include <string>
 #include <inttypes.h>
+#include <vector>
+#include <deque>
+#include <mutex>
 #include "comm_include.h"
 #include "sm_base.h"
 #include "config_include.h"
+#include "phxpaxos/node.h"
+
+#define MAX_PROPOSE_WINDOW_SIZE 100
 
 namespace phxpaxos
 {
@@ -36,7 +42,8 @@ class IOLoop;
 class Committer
 {
 public:
-    Committer(Config * poConfig, CommitCtx * poCommitCtx, IOLoop * poIOLoop, SMFac * poSMFac);
+    Committer(Config * poConfig, CommitCtx * poCommitCtx, IOLoop * poIOLoop, SMFac * poSMFac,
+            const int iProposeWindowSize = 0, const int iAsyncProposeQueueSize = 0);
     ~Committer();
 
 public:
@@ -48,6 +55,8 @@ public:
 
     int NewValue(const std::string & sValue);
 
+    int NewValueAsync(const std::string & sValue, SMCtx * poSMCtx, ProposeCallback pCallback);
+
 public:
     void SetTimeoutMs(const int iTimeoutMs);
 
@@ -55,7 +64,27 @@ public:
 
     void SetProposeWaitTimeThresholdMS(const int iWaitTimeThresholdMS);
 
+public:
+    //propose window, only used by ioloop thread.
+    bool IsUseProposeWindow() const;
+
+    CommitCtx * PopWindowCommitCtx(CommitCtx * poIdleCommitCtx);
+
+    void OnAsyncCommitEnd(CommitCtx * poCommitCtx);
+
 private:
+    int NewValueGetIDInWindow(std::string & sPackSMIDValue, SMCtx * poSMCtx,
+            const int iLeftTimeoutMs, uint64_t & llInstanceID);
+
+    //return false if ioloop already take it.
+    bool RemoveWaitingCommitCtx(CommitCtx * poCommitCtx);
+
+    //give a window commit ctx to the first queued async proposal, or back to free queue.
+    void ReleaseWindowCommitCtx(CommitCtx * poCommitCtx);
+
+    void StartAsyncCommit(CommitCtx * poCommitCtx, const std::string & sPackSMIDValue,
+            SMCtx * poSMCtx, const int iTimeoutMs, ProposeCallback pCallback);
+
     void LogStatus();
 
 private:
@@ -68,6 +97,24 @@ private:
     int m_iTimeoutMs;
 
     uint64_t m_llLastLogTime;
+
+    std::vector<CommitCtx *> m_vecWindowCommitCtx;
+    Queue<CommitCtx *> m_oFreeCommitCtxQueue;
+    Queue<CommitCtx *> m_oWaitingCommitCtxQueue;
+
+    struct AsyncProposal
+    {
+        std::string sPackSMIDValue;
+        SMCtx * poSMCtx;
+        ProposeCallback pCallback;
+        uint64_t llDeadlineMs;
+    };
+
+    //async proposals wait here when window is full, m_oAsyncMutex also
+    //guard free queue check of async path so a queued one never miss a free ctx.
+    std::mutex m_oAsyncMutex;
+    std::deque<AsyncProposal> m_dequeAsyncProposal;
+    int m_iAsyncProposeQueueSize;
 };
     
 }
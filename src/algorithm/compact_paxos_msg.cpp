@@ -0,0 +1,158 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "compact_paxos_msg.h"
+#include "commdef.h"
+
+namespace phxpaxos
+{
+
+//bit set means the field is present, so optional fields keep protobuf has_xxx() semantic.
+enum CompactPaxosMsgField
+{
+    CompactPaxosMsgField_InstanceID = 1 << 0,
+    CompactPaxosMsgField_NodeID = 1 << 1,
+    CompactPaxosMsgField_ProposalID = 1 << 2,
+    CompactPaxosMsgField_ProposalNodeID = 1 << 3,
+    CompactPaxosMsgField_Value = 1 << 4,
+    CompactPaxosMsgField_PreAcceptID = 1 << 5,
+    CompactPaxosMsgField_PreAcceptNodeID = 1 << 6,
+    CompactPaxosMsgField_RejectByPromiseID = 1 << 7,
+    CompactPaxosMsgField_LastChecksum = 1 << 8,
+};
+
+struct CompactPaxosMsgHead
+{
+    int32_t iMsgType;
+    uint32_t iFieldMask;
+    uint64_t llInstanceID;
+    uint64_t llNodeID;
+    uint64_t llProposalID;
+    uint64_t llProposalNodeID;
+    uint64_t llPreAcceptID;
+    uint64_t llPreAcceptNodeID;
+    uint64_t llRejectByPromiseID;
+    uint32_t iLastChecksum;
+    uint32_t iValueLen;
+} __attribute__((packed));
+
+bool CompactPaxosMsg :: CanPack(const PaxosMsg & oPaxosMsg)
+{
+    int iMsgType = oPaxosMsg.msgtype();
+    if (iMsgType != MsgType_PaxosPrepare
+            && iMsgType != MsgType_PaxosPrepareReply
+            && iMsgType != MsgType_PaxosAccept
+            && iMsgType != MsgType_PaxosAcceptReply)
+    {
+        return false;
+    }
+
+    return !oPaxosMsg.has_nowinstanceid()
+        && !oPaxosMsg.has_minchoseninstanceid()
+        && !oPaxosMsg.has_flag()
+        && !oPaxosMsg.has_systemvariables()
+        && !oPaxosMsg.has_mastervariables()
+        && oPaxosMsg.learnstates_size() == 0;
+}
+
+void CompactPaxosMsg :: Pack(const PaxosMsg & oPaxosMsg, std::string & sBuffer)
+{
+    CompactPaxosMsgHead oHead;
+    memset(&oHead, 0, sizeof(oHead));
+
+    oHead.iMsgType = oPaxosMsg.msgtype();
+
+#define COMPACT_PACK_FIELD(FIELD, MEMBER, NAME) \
+    if (oPaxosMsg.has_##FIELD()) \
+    { \
+        oHead.iFieldMask |= CompactPaxosMsgField_##NAME; \
+        oHead.MEMBER = oPaxosMsg.FIELD(); \
+    }
+
+    COMPACT_PACK_FIELD(instanceid, llInstanceID, InstanceID);
+    COMPACT_PACK_FIELD(nodeid, llNodeID, NodeID);
+    COMPACT_PACK_FIELD(proposalid, llProposalID, ProposalID);
+    COMPACT_PACK_FIELD(proposalnodeid, llProposalNodeID, ProposalNodeID);
+    COMPACT_PACK_FIELD(preacceptid, llPreAcceptID, PreAcceptID);
+    COMPACT_PACK_FIELD(preacceptnodeid, llPreAcceptNodeID, PreAcceptNodeID);
+    COMPACT_PACK_FIELD(rejectbypromiseid, llRejectByPromiseID, RejectByPromiseID);
+    COMPACT_PACK_FIELD(lastchecksum, iLastChecksum, LastChecksum);
+
+#undef COMPACT_PACK_FIELD
+
+    if (oPaxosMsg.has_value())
+    {
+        oHead.iFieldMask |= CompactPaxosMsgField_Value;
+        oHead.iValueLen = (uint32_t)oPaxosMsg.value().size();
+    }
+
+    sBuffer.reserve(sBuffer.size() + sizeof(oHead) + oHead.iValueLen);
+    sBuffer.append((const char *)&oHead, sizeof(oHead));
+    sBuffer.append(oPaxosMsg.value().data(), oHead.iValueLen);
+}
+
+int CompactPaxosMsg :: UnPack(const char * pcBuffer, const size_t iBufferLen, PaxosMsg & oPaxosMsg)
+{
+    CompactPaxosMsgHead oHead;
+    if (iBufferLen < sizeof(oHead))
+    {
+        NLErr("buffer len %zu less than head len %zu", iBufferLen, sizeof(oHead));
+        return -1;
+    }
+
+    memcpy(&oHead, pcBuffer, sizeof(oHead));
+
+    if (iBufferLen != sizeof(oHead) + oHead.iValueLen)
+    {
+        NLErr("buffer len %zu not match value len %u", iBufferLen, oHead.iValueLen);
+        return -1;
+    }
+
+    oPaxosMsg.Clear();
+    oPaxosMsg.set_msgtype(oHead.iMsgType);
+
+#define COMPACT_UNPACK_FIELD(FIELD, MEMBER, NAME) \
+    if (oHead.iFieldMask & CompactPaxosMsgField_##NAME) \
+    { \
+        oPaxosMsg.set_##FIELD(oHead.MEMBER); \
+    }
+
+    COMPACT_UNPACK_FIELD(instanceid, llInstanceID, InstanceID);
+    COMPACT_UNPACK_FIELD(nodeid, llNodeID, NodeID);
+    COMPACT_UNPACK_FIELD(proposalid, llProposalID, ProposalID);
+    COMPACT_UNPACK_FIELD(proposalnodeid, llProposalNodeID, ProposalNodeID);
+    COMPACT_UNPACK_FIELD(preacceptid, llPreAcceptID, PreAcceptID);
+    COMPACT_UNPACK_FIELD(preacceptnodeid, llPreAcceptNodeID, PreAcceptNodeID);
+    COMPACT_UNPACK_FIELD(rejectbypromiseid, llRejectByPromiseID, RejectByPromiseID);
+    COMPACT_UNPACK_FIELD(lastchecksum, iLastChecksum, LastChecksum);
+
+#undef COMPACT_UNPACK_FIELD
+
+    if (oHead.iFieldMask & CompactPaxosMsgField_Value)
+    {
+        oPaxosMsg.set_value(pcBuffer + sizeof(oHead), oHead.iValueLen);
+    }
+
+    return 0;
+}
+    
+}
+
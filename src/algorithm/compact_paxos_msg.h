@@ -0,0 +1,48 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#pragma once
+
+#include <string>
+#include "comm_include.h"
+
+namespace phxpaxos
+{
+
+//Header.version of frames whose PaxosMsg body is in compact layout.
+#define HEADER_VERSION_COMPACT_PAXOSMSG 2
+
+//prepare, accept and their replies only carry fixed-width ids and the value,
+//so they are packed as a fixed head plus the value blob, without protobuf varint coding.
+//fields use the same host byte order as the rest of the frame(little-endian).
+class CompactPaxosMsg
+{
+public:
+    //only hot msg types without learner/system fields can be packed.
+    static bool CanPack(const PaxosMsg & oPaxosMsg);
+
+    //append to sBuffer, so it can be packed right after the frame header.
+    static void Pack(const PaxosMsg & oPaxosMsg, std::string & sBuffer);
+
+    static int UnPack(const char * pcBuffer, const size_t iBufferLen, PaxosMsg & oPaxosMsg);
+};
+    
+}
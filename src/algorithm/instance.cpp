@@ -35,23 +35,32 @@ Instance :: Instance(
     : m_oSMFac(poConfig->GetMyGroupIdx()),
     m_oIOLoop((Config *)poConfig, this),
     m_oAcceptor(poConfig, poMsgTransport, this, poLogStorage), 
-    m_oLearner(poConfig, poMsgTransport, this, &m_oAcceptor, poLogStorage, &m_oIOLoop, &m_oCheckpointMgr, &m_oSMFac),
+    m_oLearner(poConfig, poMsgTransport, this, &m_oAcceptor, poLogStorage, &m_oIOLoop, &m_oCheckpointMgr, &m_oSMFac,
+            oOptions.iLearnBatchMaxSize),
     m_oProposer(poConfig, poMsgTransport, this, &m_oLearner, &m_oIOLoop),
     m_oPaxosLog(poLogStorage),
     m_oCommitCtx((Config *)poConfig),
-    m_oCommitter((Config *)poConfig, &m_oCommitCtx, &m_oIOLoop, &m_oSMFac),
-    m_oCheckpointMgr((Config *)poConfig, &m_oSMFac, (LogStorage *)poLogStorage, oOptions.bUseCheckpointReplayer),
+    m_oCommitter((Config *)poConfig, &m_oCommitCtx, &m_oIOLoop, &m_oSMFac, oOptions.iProposeWindowSize,
+            oOptions.iAsyncProposeQueueSize),
+    m_oCheckpointMgr((Config *)poConfig, &m_oSMFac, (LogStorage *)poLogStorage, oOptions.bUseCheckpointReplayer,
+            oOptions.iMaxApplyLag > 0),
+    m_oApplier((Config *)poConfig, &m_oSMFac, &m_oCheckpointMgr, &m_oCommitter, &m_oIOLoop, oOptions.iMaxApplyLag),
     m_oOptions(oOptions)
 {
     m_poConfig = (Config *)poConfig;
     m_poMsgTransport = (MsgTransport *)poMsgTransport;
+    m_poCommitCtx = &m_oCommitCtx;
     m_iCommitTimerID = 0;
     m_iLastChecksum = 0;
+    m_llNowInstanceID = 0;
+    m_llLastTraceDumpTimeMs = 0;
+    m_bIsWaitApplier = false;
 }
 
 Instance :: ~Instance()
 {
     m_oIOLoop.Stop();
+    m_oApplier.Stop();
     m_oCheckpointMgr.Stop();
     m_oLearner.Stop();
 
@@ -112,6 +121,7 @@ int Instance :: Init()
 
     m_oLearner.SetInstanceID(llNowInstanceID);
     m_oProposer.SetInstanceID(llNowInstanceID);
+    m_llNowInstanceID = llNowInstanceID;
     m_oProposer.SetStartProposalID(m_oAcceptor.GetAcceptorState()->GetPromiseBallot().m_llProposalID + 1);
 
     m_oCheckpointMgr.SetMaxChosenInstanceID(llNowInstanceID);
@@ -129,14 +139,19 @@ int Instance :: Init()
     return 0;
 }
 
-void Instance :: Start()
+void Instance :: Start(JobScheduler * poScheduler)
 {
     //start learner sender
-    m_oLearner.StartLearnerSender();
+    m_oLearner.StartLearnerSender(poScheduler);
+    //start applier before ioloop
+    m_oApplier.Start(m_oAcceptor.GetInstanceID(), poScheduler);
     //start ioloop
-    m_oIOLoop.start();
+    if (poScheduler == nullptr || m_oIOLoop.StartOnScheduler(poScheduler) != 0)
+    {
+        m_oIOLoop.start();
+    }
     //start checkpoint replayer and cleaner
-    m_oCheckpointMgr.Start();
+    m_oCheckpointMgr.Start(poScheduler);
 }
 
 int Instance :: ProtectionLogic_IsCheckpointInstanceIDCorrect(const uint64_t llCPInstanceID, const uint64_t llLogMaxInstanceID) 
@@ -277,16 +292,45 @@ Replayer * Instance :: GetCheckpointReplayer()
     return m_oCheckpointMgr.GetReplayer();
 }
 
+Applier * Instance :: GetApplier()
+{
+    return &m_oApplier;
+}
+
 ////////////////////////////////////////////////
 
 void Instance :: CheckNewValue()
 {
+    //learned instance wait for applier, applier notify ioloop once it has room.
+    if (m_bIsWaitApplier)
+    {
+        ExecuteLearned();
+        if (m_bIsWaitApplier)
+        {
+            return;
+        }
+    }
+
+    if (m_poCommitCtx == &m_oCommitCtx)
+    {
+        //propose window mode, pick the next waiting commit.
+        m_poCommitCtx = m_oCommitter.PopWindowCommitCtx(&m_oCommitCtx);
+    }
+
     // жһ commit ǷѾ
-    if (!m_oCommitCtx.IsNewCommit())
+    if (!m_poCommitCtx->IsNewCommit())
     {
         return;
     }
 
+    //waited too long in propose window behind slow commits.
+    if (m_poCommitCtx->GetLeftTimeoutMs() == 0)
+    {
+        PLGErr("commit timeout before start, timeout %dms", m_poCommitCtx->GetTimeoutMs());
+        SetCommitResult(PaxosTryCommitRet_Timeout, (uint64_t)-1, "");
+        return;
+    }
+
     // жϵǰ instance ǷµģǣҪ롣
     if (!m_oLearner.IsIMLatest())
     {
@@ -297,30 +341,31 @@ void Instance :: CheckNewValue()
     if (m_poConfig->IsIMFollower())
     {
         PLGErr("I'm follower, skip this new value");
-        m_oCommitCtx.SetResultOnlyRet(PaxosTryCommitRet_Follower_Cannot_Commit);
+        SetCommitResult(PaxosTryCommitRet_Follower_Cannot_Commit, (uint64_t)-1, "");
         return;
     }
 
     if (!m_poConfig->CheckConfig())
     {
         PLGErr("I'm not in membership, skip this new value");
-        m_oCommitCtx.SetResultOnlyRet(PaxosTryCommitRet_Im_Not_In_Membership);
+        SetCommitResult(PaxosTryCommitRet_Im_Not_In_Membership, (uint64_t)-1, "");
         return;
     }
 
-    if ((int)m_oCommitCtx.GetCommitValue().size() > MAX_VALUE_SIZE)
+    if ((int)m_poCommitCtx->GetCommitValue().size() > MAX_VALUE_SIZE)
     {
         PLGErr("value size %zu to large, skip this new value",
-            m_oCommitCtx.GetCommitValue().size());
-        m_oCommitCtx.SetResultOnlyRet(PaxosTryCommitRet_Value_Size_TooLarge);
+            m_poCommitCtx->GetCommitValue().size());
+        SetCommitResult(PaxosTryCommitRet_Value_Size_TooLarge, (uint64_t)-1, "");
         return;
     }
 
-    m_oCommitCtx.StartCommit(m_oProposer.GetInstanceID());
+    m_poCommitCtx->StartCommit(m_oProposer.GetInstanceID());
+    m_poConfig->GetInstanceTrace()->Add(TraceEvent_NewValue, m_oProposer.GetInstanceID(), m_poCommitCtx->GetCommitValue().size());
 
-    if (m_oCommitCtx.GetTimeoutMs() != -1)
+    if (m_poCommitCtx->GetTimeoutMs() != -1)
     {
-        m_oIOLoop.AddTimer(m_oCommitCtx.GetTimeoutMs(), Timer_Instance_Commit_Timeout, m_iCommitTimerID);
+        m_oIOLoop.AddTimer(m_poCommitCtx->GetLeftTimeoutMs(), Timer_Instance_Commit_Timeout, m_iCommitTimerID);
     }
 
     // һͳʱֵ
@@ -344,9 +389,9 @@ void Instance :: CheckNewValue()
     else
     {
         if (m_oOptions.bOpenChangeValueBeforePropose) {
-            m_oSMFac.BeforePropose(m_poConfig->GetMyGroupIdx(), m_oCommitCtx.GetCommitValue());
+            m_oSMFac.BeforePropose(m_poConfig->GetMyGroupIdx(), m_poCommitCtx->GetCommitValue());
         }
-        m_oProposer.NewValue(m_oCommitCtx.GetCommitValue());
+        m_oProposer.NewValue(m_poCommitCtx->GetCommitValue());
     }
 }
 
@@ -357,7 +402,27 @@ void Instance :: OnNewValueCommitTimeout()
     m_oProposer.ExitPrepare();
     m_oProposer.ExitAccept();
 
-    m_oCommitCtx.SetResult(PaxosTryCommitRet_Timeout, m_oProposer.GetInstanceID(), "");
+    SetCommitResult(PaxosTryCommitRet_Timeout, m_oProposer.GetInstanceID(), "");
+}
+
+void Instance :: SetCommitResult(const int iCommitRet, const uint64_t llInstanceID, const std::string & sLearnValue)
+{
+    CommitCtx * poCommitCtx = m_poCommitCtx;
+    bool bIsAsyncCommit = poCommitCtx->IsAsyncCommit();
+
+    bool bIsCommitEnd = poCommitCtx->SetResult(iCommitRet, llInstanceID, sLearnValue);
+    if (bIsCommitEnd)
+    {
+        //window commit ctx may be reused by committer as soon as commit end,
+        //so must not touch it any more.
+        m_poCommitCtx = &m_oCommitCtx;
+
+        //no thread wait on async commit, finish it here.
+        if (bIsAsyncCommit)
+        {
+            m_oCommitter.OnAsyncCommitEnd(poCommitCtx);
+        }
+    }
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -369,6 +434,13 @@ int Instance :: OnReceiveMessage(const char * pcMessage, const int iMessageLen)
     return 0;
 }
 
+int Instance :: OnReceiveMessage(MsgBuffer * poBuffer)
+{
+    m_oIOLoop.AddMessage(poBuffer);
+
+    return 0;
+}
+
 bool Instance :: ReceiveMsgHeaderCheck(const Header & oHeader, const nodeid_t iFromNodeID)
 {
     if (m_poConfig->GetGid() == 0 || oHeader.gid() == 0)
@@ -387,20 +459,20 @@ bool Instance :: ReceiveMsgHeaderCheck(const Header & oHeader, const nodeid_t iF
     return true;
 }
 
-void Instance :: OnReceive(const std::string & sBuffer)
+void Instance :: OnReceive(const char * pcBuffer, const size_t iBufferLen)
 {
     BP->GetInstanceBP()->OnReceive();
 
-    if (sBuffer.size() <= 6)
+    if (iBufferLen <= 6)
     {
-        PLGErr("buffer size %zu too short", sBuffer.size());
+        PLGErr("buffer size %zu too short", iBufferLen);
         return;
     }
 
     Header oHeader;
     size_t iBodyStartPos = 0;
     size_t iBodyLen = 0;
-    int ret = Base::UnPackBaseMsg(sBuffer, oHeader, iBodyStartPos, iBodyLen);
+    int ret = Base::UnPackBaseMsg(pcBuffer, iBufferLen, oHeader, iBodyStartPos, iBodyLen);
     if (ret != 0)
     {
         return;
@@ -416,12 +488,12 @@ void Instance :: OnReceive(const std::string & sBuffer)
             return;
         }
         
-        PaxosMsg oPaxosMsg;
-        bool bSucc = oPaxosMsg.ParseFromArray(sBuffer.data() + iBodyStartPos, iBodyLen);
-        if (!bSucc)
+        PaxosMsg & oPaxosMsg = m_oRecvPaxosMsg;
+        ret = Base::UnPackPaxosMsg(oHeader, pcBuffer + iBodyStartPos, iBodyLen, oPaxosMsg);
+        if (ret != 0)
         {
             BP->GetInstanceBP()->OnReceiveParseError();
-            PLGErr("PaxosMsg.ParseFromArray fail, skip this msg");
+            PLGErr("UnPackPaxosMsg fail, skip this msg");
             return;
         }
 
@@ -434,8 +506,8 @@ void Instance :: OnReceive(const std::string & sBuffer)
     }
     else if (iCmd == MsgCmd_CheckpointMsg)
     {
-        CheckpointMsg oCheckpointMsg;
-        bool bSucc = oCheckpointMsg.ParseFromArray(sBuffer.data() + iBodyStartPos, iBodyLen);
+        CheckpointMsg & oCheckpointMsg = m_oRecvCheckpointMsg;
+        bool bSucc = oCheckpointMsg.ParseFromArray(pcBuffer + iBodyStartPos, iBodyLen);
         if (!bSucc)
         {
             BP->GetInstanceBP()->OnReceiveParseError();
@@ -451,6 +523,26 @@ void Instance :: OnReceive(const std::string & sBuffer)
         //  checkpoint Ϣ
         OnReceiveCheckpointMsg(oCheckpointMsg);
     }
+
+    ShrinkRecvMsg();
+}
+
+void Instance :: ShrinkRecvMsg()
+{
+    if (m_oRecvPaxosMsg.value().capacity() > RECV_MSG_KEEP_BUFFER_LEN
+            || m_oRecvPaxosMsg.systemvariables().capacity() > RECV_MSG_KEEP_BUFFER_LEN
+            || m_oRecvPaxosMsg.mastervariables().capacity() > RECV_MSG_KEEP_BUFFER_LEN)
+    {
+        //swap out and free, clear keeps the capacity.
+        PaxosMsg oEmptyPaxosMsg;
+        m_oRecvPaxosMsg.Swap(&oEmptyPaxosMsg);
+    }
+
+    if (m_oRecvCheckpointMsg.buffer().capacity() > RECV_MSG_KEEP_BUFFER_LEN)
+    {
+        CheckpointMsg oEmptyCheckpointMsg;
+        m_oRecvCheckpointMsg.Swap(&oEmptyCheckpointMsg);
+    }
 }
 
 void Instance :: OnReceiveCheckpointMsg(const CheckpointMsg & oCheckpointMsg)
@@ -529,6 +621,7 @@ int Instance :: OnReceivePaxosMsg(const PaxosMsg & oPaxosMsg, const bool bIsRetr
     // Ϣ learner ȥ
     else if (oPaxosMsg.msgtype() == MsgType_PaxosLearner_AskforLearn
             || oPaxosMsg.msgtype() == MsgType_PaxosLearner_SendLearnValue
+            || oPaxosMsg.msgtype() == MsgType_PaxosLearner_SendLearnValueBatch
             || oPaxosMsg.msgtype() == MsgType_PaxosLearner_ProposerSendSuccess
             || oPaxosMsg.msgtype() == MsgType_PaxosLearner_ComfirmAskforLearn
             || oPaxosMsg.msgtype() == MsgType_PaxosLearner_SendNowInstanceID
@@ -692,6 +785,10 @@ int Instance :: ReceiveMsgForLearner(const PaxosMsg & oPaxosMsg)
     {
         m_oLearner.OnSendLearnValue(oPaxosMsg);
     }
+    else if (oPaxosMsg.msgtype() == MsgType_PaxosLearner_SendLearnValueBatch)
+    {
+        m_oLearner.OnSendLearnValueBatch(oPaxosMsg);
+    }
     else if (oPaxosMsg.msgtype() == MsgType_PaxosLearner_ProposerSendSuccess)
     {
         m_oLearner.OnProposerSendSuccess(oPaxosMsg);
@@ -717,12 +814,33 @@ int Instance :: ReceiveMsgForLearner(const PaxosMsg & oPaxosMsg)
     // MsgType_PaxosLearner_ProposerSendSuccess ͻ LearnValueWithoutWrite ӿ
     //  m_IsLearned Ϊ true 
     // ƺ learner ĽǲҪɫһµġ
-    if (m_oLearner.IsLearned())
+    return ExecuteLearned();
+}
+
+//a learn batch keep the next instance learned after NewInstance, execute them all here.
+int Instance :: ExecuteLearned()
+{
+    while (m_oLearner.IsLearned())
     {
+        bool bIsSystemValue = m_oApplier.IsOpen() && m_oApplier.IsSystemValue(m_oLearner.GetLearnValue());
+
+        //apply lag full, keep it learned and go on with other messages and timers.
+        m_bIsWaitApplier = m_oApplier.IsOpen() && !m_oApplier.CanAdd(bIsSystemValue);
+        if (m_bIsWaitApplier)
+        {
+            return 0;
+        }
+
         BP->GetInstanceBP()->OnInstanceLearned();
 
+        if (m_oAcceptor.GetAcceptedTimeUs() > 0 && m_oAcceptor.GetInstanceID() == m_oLearner.GetInstanceID())
+        {
+            BP->GetLatencyBP()->StageUseTimeUs(m_poConfig->GetMyGroupIdx(), LatencyStage_Learn,
+                    Time::GetSteadyClockUS() - m_oAcceptor.GetAcceptedTimeUs());
+        }
+
         SMCtx * poSMCtx = nullptr;
-        bool bIsMyCommit = m_oCommitCtx.IsMyCommit(m_oLearner.GetInstanceID(), m_oLearner.GetLearnValue(), poSMCtx);
+        bool bIsMyCommit = m_poCommitCtx->IsMyCommit(m_oLearner.GetInstanceID(), m_oLearner.GetLearnValue(), poSMCtx);
 
         if (!bIsMyCommit)
         {
@@ -734,25 +852,39 @@ int Instance :: ReceiveMsgForLearner(const PaxosMsg & oPaxosMsg)
             int iUseTimeMs = m_oTimeStat.Point();
             BP->GetInstanceBP()->OnInstanceLearnedIsMyCommit(iUseTimeMs);
             PLGHead("My commit ok, usetime %dms", iUseTimeMs);
+
+            m_poConfig->GetInstanceTrace()->Add(TraceEvent_Commit, m_oLearner.GetInstanceID(), 0, (uint64_t)iUseTimeMs * 1000);
+            if (m_oOptions.iInstanceTraceDumpThresholdMs > 0 && iUseTimeMs >= m_oOptions.iInstanceTraceDumpThresholdMs)
+            {
+                DumpSlowCommitTrace(iUseTimeMs);
+            }
         }
 
-        if (!SMExecute(m_oLearner.GetInstanceID(), m_oLearner.GetLearnValue(), bIsMyCommit, poSMCtx))
+        if (m_oApplier.IsOpen() && !bIsSystemValue)
+        {
+            AddToApplier(bIsMyCommit, poSMCtx);
+        }
+        else if (!SMExecute(m_oLearner.GetInstanceID(), m_oLearner.GetLearnValue(), bIsMyCommit, poSMCtx))
         {
             BP->GetInstanceBP()->OnInstanceLearnedSMExecuteFail();
 
             PLGErr("SMExecute fail, instanceid %lu, not increase instanceid", m_oLearner.GetInstanceID());
-            m_oCommitCtx.SetResult(PaxosTryCommitRet_ExecuteFail, 
+            SetCommitResult(PaxosTryCommitRet_ExecuteFail, 
                     m_oLearner.GetInstanceID(), m_oLearner.GetLearnValue());
 
             m_oProposer.CancelSkipPrepare();
 
             return -1;
         }
-        
+        else
         {
             //this paxos instance end, tell proposal done
-            m_oCommitCtx.SetResult(PaxosTryCommitRet_OK
-                    , m_oLearner.GetInstanceID(), m_oLearner.GetLearnValue());
+            SetCommitResult(PaxosTryCommitRet_OK, m_oLearner.GetInstanceID(), m_oLearner.GetLearnValue());
+
+            if (bIsSystemValue)
+            {
+                m_oApplier.SetAppliedInstanceID(m_oLearner.GetInstanceID() + 1);
+            }
 
             if (m_iCommitTimerID > 0)
             {
@@ -775,7 +907,10 @@ int Instance :: ReceiveMsgForLearner(const PaxosMsg & oPaxosMsg)
                 "Now.Acceptor.InstanceID %lu Now.Learner.InstanceID %lu",
                 m_oProposer.GetInstanceID(), m_oAcceptor.GetInstanceID(), m_oLearner.GetInstanceID());
 
-        m_oCheckpointMgr.SetMaxChosenInstanceID(m_oAcceptor.GetInstanceID());
+        if (!m_oApplier.IsOpen() || bIsSystemValue)
+        {
+            m_oCheckpointMgr.SetMaxChosenInstanceID(m_oAcceptor.GetInstanceID());
+        }
 
         BP->GetInstanceBP()->NewInstance();
     }
@@ -783,16 +918,65 @@ int Instance :: ReceiveMsgForLearner(const PaxosMsg & oPaxosMsg)
     return 0;
 }
 
+//this paxos instance end, my commit is detached and wait for apply thread to tell proposal done,
+//ioloop go on with the next instance.
+void Instance :: AddToApplier(const bool bIsMyCommit, SMCtx * poSMCtx)
+{
+    CommitCtx * poCommitCtx = nullptr;
+    if (bIsMyCommit && m_poCommitCtx->DetachForApply(m_oLearner.GetInstanceID()))
+    {
+        poCommitCtx = m_poCommitCtx;
+        m_poCommitCtx = &m_oCommitCtx;
+    }
+    else
+    {
+        //other's value chosen on the instance of my commit, end it as conflict,
+        //nothing to wait for apply.
+        SetCommitResult(PaxosTryCommitRet_OK, m_oLearner.GetInstanceID(), m_oLearner.GetLearnValue());
+    }
+
+    if (m_iCommitTimerID > 0)
+    {
+        m_oIOLoop.RemoveTimer(m_iCommitTimerID);
+    }
+
+    m_oApplier.Add(m_oLearner.GetInstanceID(), m_oLearner.GetLearnValue(), poSMCtx, poCommitCtx);
+}
+
 void Instance :: NewInstance()
 {
     m_oAcceptor.NewInstance();
     m_oLearner.NewInstance();
     m_oProposer.NewInstance();
+
+    m_llNowInstanceID.store(m_oAcceptor.GetInstanceID(), std::memory_order_release);
 }
 
 const uint64_t Instance :: GetNowInstanceID()
 {
-    return m_oAcceptor.GetInstanceID();
+    return m_llNowInstanceID.load(std::memory_order_acquire);
+}
+
+const uint64_t Instance :: GetAppliedInstanceID()
+{
+    //execute in ioloop before instance increase.
+    if (!m_oApplier.IsOpen())
+    {
+        return GetNowInstanceID();
+    }
+
+    return m_oApplier.GetAppliedInstanceID();
+}
+
+bool Instance :: WaitApplied(const uint64_t llInstanceID, const int iTimeoutMs)
+{
+    //without applier nothing to wait, instanceid read from GetNowInstanceID is always reached.
+    if (!m_oApplier.IsOpen())
+    {
+        return GetAppliedInstanceID() >= llInstanceID;
+    }
+
+    return m_oApplier.WaitApplied(llInstanceID, iTimeoutMs);
 }
 
 ///////////////////////////////
@@ -834,11 +1018,44 @@ bool Instance :: SMExecute(
         const bool bIsMyCommit,
         SMCtx * poSMCtx)
 {
-    return m_oSMFac.Execute(m_poConfig->GetMyGroupIdx(), llInstanceID, sValue, poSMCtx);
+    uint64_t llBeginTimeUs = Time::GetSteadyClockUS();
+    bool bExecuteRet = m_oSMFac.Execute(m_poConfig->GetMyGroupIdx(), llInstanceID, sValue, poSMCtx);
+    uint64_t llUseTimeUs = Time::GetSteadyClockUS() - llBeginTimeUs;
+    BP->GetLatencyBP()->StageUseTimeUs(m_poConfig->GetMyGroupIdx(), LatencyStage_SMExecute, llUseTimeUs);
+    m_poConfig->GetInstanceTrace()->Add(TraceEvent_SMExecute, llInstanceID, 0, llUseTimeUs);
+
+    return bExecuteRet;
 }
 
 ////////////////////////////////
 
+void Instance :: DumpSlowCommitTrace(const int iUseTimeMs)
+{
+    if (!m_poConfig->GetInstanceTrace()->IsOpen())
+    {
+        return;
+    }
+
+    uint64_t llNowTimeMs = Time::GetSteadyClockMS();
+    if (m_llLastTraceDumpTimeMs > 0 
+            && llNowTimeMs < m_llLastTraceDumpTimeMs + m_oOptions.iInstanceTraceDumpIntervalMs)
+    {
+        return;
+    }
+    m_llLastTraceDumpTimeMs = llNowTimeMs;
+
+    //events during the commit, a bit earlier to include the commit start.
+    uint64_t llNowTimeUs = Time::GetSteadyClockUS();
+    uint64_t llSinceTimeUs = (uint64_t)(iUseTimeMs + 1) * 1000;
+    llSinceTimeUs = llNowTimeUs > llSinceTimeUs ? llNowTimeUs - llSinceTimeUs : 0;
+
+    string sTraceJson;
+    m_poConfig->GetInstanceTrace()->Dump(sTraceJson, llSinceTimeUs);
+
+    InstanceTraceDumper::Instance()->Dump(m_poConfig->GetMyGroupIdx(), m_oOptions.sInstanceTraceDumpPath,
+            m_oLearner.GetInstanceID(), iUseTimeMs, sTraceJson);
+}
+
 void Instance :: ChecksumLogic(const PaxosMsg & oPaxosMsg)
 {
     if (oPaxosMsg.lastchecksum() == 0)
@@ -34,10 +34,15 @@ See the AUTHORS file for names of contributors.
 #include "commitctx.h"
 #include "committer.h"
 #include "cp_mgr.h"
+#include "applier.h"
+#include <atomic>
 
 namespace phxpaxos
 {
 
+//reused receive msg drop its buffers if they grow larger than this, so a big value won't be held forever.
+#define RECV_MSG_KEEP_BUFFER_LEN (1024 * 1024)
+
 class Instance
 {
 public:
@@ -50,12 +55,19 @@ public:
 
     int Init();
 
-    void Start();
+    //run ioloop and background jobs on poScheduler if not null, otherwise on their own threads.
+    void Start(JobScheduler * poScheduler);
 
     int InitLastCheckSum();
 
+    //safe to call from any thread, updated by ioloop when instance increase.
     const uint64_t GetNowInstanceID();
 
+    //state machine executed instances before it.
+    const uint64_t GetAppliedInstanceID();
+
+    bool WaitApplied(const uint64_t llInstanceID, const int iTimeoutMs);
+
     const uint32_t GetLastChecksum();
 
     int GetInstanceValue(const uint64_t llInstanceID, std::string & sValue, int & iSMID);
@@ -67,6 +79,8 @@ public:
 
     Replayer * GetCheckpointReplayer();
 
+    Applier * GetApplier();
+
 public:
     void CheckNewValue();
 
@@ -76,8 +90,10 @@ public:
     //this funciton only enqueue, do nothing.
     int OnReceiveMessage(const char * pcMessage, const int iMessageLen);
 
+    int OnReceiveMessage(MsgBuffer * poBuffer);
+
 public:
-    void OnReceive(const std::string & sBuffer);
+    void OnReceive(const char * pcBuffer, const size_t iBufferLen);
     
     void OnReceiveCheckpointMsg(const CheckpointMsg & oCheckpointMsg);
 
@@ -108,11 +124,22 @@ private:
 
     bool ReceiveMsgHeaderCheck(const Header & oHeader, const nodeid_t iFromNodeID);
 
+    void ShrinkRecvMsg();
+
     int ProtectionLogic_IsCheckpointInstanceIDCorrect(const uint64_t llCPInstanceID, const uint64_t llLogMaxInstanceID);
 
 private:
     void NewInstance();
 
+    void SetCommitResult(const int iCommitRet, const uint64_t llInstanceID, const std::string & sLearnValue);
+
+    int ExecuteLearned();
+
+    void AddToApplier(const bool bIsMyCommit, SMCtx * poSMCtx);
+
+    //hand events of this commit to the process trace dumper, write into Options::sInstanceTraceDumpPath.
+    void DumpSlowCommitTrace(const int iUseTimeMs);
+
 private:
     Config * m_poConfig;
     MsgTransport * m_poMsgTransport;
@@ -129,8 +156,12 @@ private:
 
     uint32_t m_iLastChecksum;
 
+    //copy of acceptor instanceid for readers outside ioloop.
+    std::atomic<uint64_t> m_llNowInstanceID;
+
 private:
     CommitCtx m_oCommitCtx;
+    CommitCtx * m_poCommitCtx;
     uint32_t m_iCommitTimerID;
 
     Committer m_oCommitter;
@@ -138,9 +169,22 @@ private:
 private:
     CheckpointMgr m_oCheckpointMgr;
 
+    Applier m_oApplier;
+
+    //learned instance not executed yet, apply lag is full.
+    bool m_bIsWaitApplier;
+
+    //last slow commit trace dump, at most one every Options::iInstanceTraceDumpIntervalMs.
+    uint64_t m_llLastTraceDumpTimeMs;
+
 private:
     TimeStat m_oTimeStat;
     Options m_oOptions;
+
+private:
+    //reused by OnReceive in ioloop, parse keeps their string capacity, no allocation in steady state.
+    PaxosMsg m_oRecvPaxosMsg;
+    CheckpointMsg m_oRecvCheckpointMsg;
 };
     
 }
@@ -29,7 +29,7 @@ namespace phxpaxos
 {
 
 IOLoop :: IOLoop(Config * poConfig, Instance * poInstance)
-    : m_poConfig(poConfig), m_poInstance(poInstance)
+    : m_oMessageQueue(QUEUE_MAXLENGTH), m_poConfig(poConfig), m_poInstance(poInstance)
 {
     m_bIsEnd = false;
     m_bIsStart = false;
@@ -39,6 +39,11 @@ IOLoop :: IOLoop(Config * poConfig, Instance * poInstance)
 
 IOLoop :: ~IOLoop()
 {
+    MsgBuffer * poBuffer = nullptr;
+    while (m_oMessageQueue.TryPop(poBuffer))
+    {
+        MsgBufferPool::Instance()->Put(poBuffer);
+    }
 }
 
 void IOLoop :: run()
@@ -67,40 +72,72 @@ void IOLoop :: run()
     }
 }
 
+int IOLoop :: RunSlice()
+{
+    BP->GetIOLoopBP()->OneLoop();
+
+    int iNextTimeout = 1000;
+    DealwithTimeout(iNextTimeout);
+
+    //never block, scheduler wakes us up on new message or timer.
+    OneLoop(0);
+
+    if (!m_oMessageQueue.Empty())
+    {
+        return 0;
+    }
+
+    //timers may be added while dealing with messages.
+    iNextTimeout = 1000;
+    int iTimerTimeout = m_oTimer.GetNextTimeout();
+    if (iTimerTimeout >= 0 && iTimerTimeout < iNextTimeout)
+    {
+        iNextTimeout = iTimerTimeout;
+    }
+
+    return iNextTimeout;
+}
+
 void IOLoop :: AddNotify()
 {
-    m_oMessageQueue.lock();
-    m_oMessageQueue.add(nullptr);
-    m_oMessageQueue.unlock();
+    //if queue is full, ioloop is busy and will check new value soon.
+    m_oMessageQueue.Add(nullptr);
+    NotifyScheduler();
 }
 
 int IOLoop :: AddMessage(const char * pcMessage, const int iMessageLen)
 {
-    m_oMessageQueue.lock();
+    MsgBuffer * poBuffer = MsgBufferPool::Instance()->Get(iMessageLen);
+    memcpy(poBuffer->GetPtr(), pcMessage, iMessageLen);
 
+    return AddMessage(poBuffer);
+}
+
+int IOLoop :: AddMessage(MsgBuffer * poBuffer)
+{
     BP->GetIOLoopBP()->EnqueueMsg();
 
-    if ((int)m_oMessageQueue.size() > QUEUE_MAXLENGTH)
+    if (m_iQueueMemSize > MAX_QUEUE_MEM_SIZE)
     {
-        BP->GetIOLoopBP()->EnqueueMsgRejectByFullQueue();
-
-        PLGErr("Queue full, skip msg");
-        m_oMessageQueue.unlock();
+        PLErr("queue memsize %d too large, can't enqueue", (int)m_iQueueMemSize);
+        MsgBufferPool::Instance()->Put(poBuffer);
         return -2;
     }
 
-    if (m_iQueueMemSize > MAX_QUEUE_MEM_SIZE)
+    int iMessageLen = poBuffer->GetLen();
+    m_iQueueMemSize += iMessageLen;
+
+    if (!m_oMessageQueue.Add(poBuffer))
     {
-        PLErr("queue memsize %d too large, can't enqueue", m_iQueueMemSize);
-        m_oMessageQueue.unlock();
+        BP->GetIOLoopBP()->EnqueueMsgRejectByFullQueue();
+
+        PLGErr("Queue full, skip msg");
+        m_iQueueMemSize -= iMessageLen;
+        MsgBufferPool::Instance()->Put(poBuffer);
         return -2;
     }
-    
-    m_oMessageQueue.add(new string(pcMessage, iMessageLen));
-
-    m_iQueueMemSize += iMessageLen;
 
-    m_oMessageQueue.unlock();
+    NotifyScheduler();
 
     return 0;
 }
@@ -122,10 +159,20 @@ int IOLoop :: AddRetryPaxosMsg(const PaxosMsg & oPaxosMsg)
 void IOLoop :: Stop()
 {
     m_bIsEnd = true;
-    if (m_bIsStart)
+    if (IsOnScheduler())
+    {
+        StopOnScheduler();
+        return;
+    }
+
+    if (!m_bIsStart)
     {
-        join();
+        return;
     }
+
+    join();
+
+    m_bIsStart = false;
 }
 
 void IOLoop :: ClearRetryQueue()
@@ -180,43 +227,49 @@ void IOLoop :: DealWithRetry()
     }
 }
 
-void IOLoop :: OneLoop(const int iTimeoutMs)
+void IOLoop :: DealWithMessage(MsgBuffer * poBuffer)
 {
-    std::string * psMessage = nullptr;
-
-    // зֹбⲿ޸ġ
-    m_oMessageQueue.lock();
-    // ʱʱֻʱ¼
-    // 뿪ʼϢʱϡ
-    // 3.29 : ǳֵҲ׳ʱÿζȡ
-    // ڵ¼Ǻó message һһӦġ
-    // ѵǲ?
-    bool bSucc = m_oMessageQueue.peek(psMessage, iTimeoutMs);
-    
-    if (!bSucc)
+    if (poBuffer == nullptr)
     {
-        m_oMessageQueue.unlock();
+        return;
     }
-    else
+
+    if (poBuffer->GetLen() > 0)
     {
-        m_oMessageQueue.pop();
-        m_oMessageQueue.unlock();
+        m_iQueueMemSize -= poBuffer->GetLen();
+        // paxos ĺĽӿڣݲͬϢͽ벻ͬĴڡ
+        m_poInstance->OnReceive(poBuffer->GetPtr(), poBuffer->GetLen());
+    }
 
-        if (psMessage != nullptr && psMessage->size() > 0)
-        {
-            m_iQueueMemSize -= psMessage->size();
-            // paxos ĺĽӿڣݲͬϢͽ벻ͬĴڡ
-            m_poInstance->OnReceive(*psMessage);
-        }
+    MsgBufferPool::Instance()->Put(poBuffer);
+}
 
-        delete psMessage;
+void IOLoop :: OneLoop(const int iTimeoutMs)
+{
+    if (m_oMessageQueue.Empty() && iTimeoutMs > 0)
+    {
+        m_oMessageQueue.WaitTime(iTimeoutMs);
+    }
+
+    //drain a batch, but not too many, timers are checked between loops.
+    int iDealCount = 0;
+    MsgBuffer * poBuffer = nullptr;
+    while (iDealCount < IOLOOP_MAX_DEAL_MSG_PER_LOOP && m_oMessageQueue.TryPop(poBuffer))
+    {
+        DealWithMessage(poBuffer);
 
         BP->GetIOLoopBP()->OutQueueMsg();
+
+        DealWithRetry();
+        iDealCount++;
     }
 
     // ǸĶУ paxos 㷨в retry Ϣ
     // ЩϢظȥԲʹС
-    DealWithRetry();
+    if (iDealCount == 0)
+    {
+        DealWithRetry();
+    }
 
     //must put on here
     //because addtimer on this funciton
@@ -234,34 +287,19 @@ bool IOLoop :: AddTimer(const int iTimeout, const int iType, uint32_t & iTimerID
     uint64_t llAbsTime = Time::GetSteadyClockMS() + iTimeout;
     m_oTimer.AddTimerWithType(llAbsTime, iType, iTimerID);
 
-    m_mapTimerIDExist[iTimerID] = true;
-
     return true;
 }
 
 void IOLoop :: RemoveTimer(uint32_t & iTimerID)
 {
-    auto it = m_mapTimerIDExist.find(iTimerID);
-    if (it != end(m_mapTimerIDExist))
-    {
-        m_mapTimerIDExist.erase(it);
-    }
+    m_oTimer.RemoveTimer(iTimerID);
 
     iTimerID = 0;
 }
 
-// ѾеѾʱҴڶʱУɾ
+//removed timers are dropped by timer, no need to check here.
 void IOLoop :: DealwithTimeoutOne(const uint32_t iTimerID, const int iType)
 {
-    auto it = m_mapTimerIDExist.find(iTimerID);
-    if (it == end(m_mapTimerIDExist))
-    {
-        //PLGErr("Timeout aready remove!, timerid %u iType %d", iTimerID, iType);
-        return;
-    }
-
-    m_mapTimerIDExist.erase(it);
-
     m_poInstance->OnTimeout(iTimerID, iType);
 }
 
@@ -279,14 +317,15 @@ void IOLoop :: DealwithTimeout(int & iNextTimeout)
         if (bHasTimeout)
         {
             DealwithTimeoutOne(iTimerID, iType);
-
-            iNextTimeout = m_oTimer.GetNextTimeout();
-            if (iNextTimeout != 0)
-            {
-                break;
-            }
         }
     }
+
+    //wake up for the next timer, but still check the queue periodically.
+    int iTimerTimeout = m_oTimer.GetNextTimeout();
+    if (iTimerTimeout >= 0 && iTimerTimeout < iNextTimeout)
+    {
+        iNextTimeout = iTimerTimeout;
+    }
 }
 
 }
@@ -27,16 +27,21 @@ See the AUTHORS file for names of contributors.
 #include <string>
 #include "comm_include.h"
 #include <queue>
+#include <atomic>
 #include "config_include.h"
+#include "job_scheduler.h"
 
 namespace phxpaxos
 {
 
 #define RETRY_QUEUE_MAX_LEN 300
 
+//max messages deal in one OneLoop, then go back to check timers.
+#define IOLOOP_MAX_DEAL_MSG_PER_LOOP 32
+
 class Instance;
 
-class IOLoop : public Thread
+class IOLoop : public Thread, public ScheduledJob
 {
 public:
     IOLoop(Config * poConfig, Instance * poInstance);
@@ -46,15 +51,24 @@ public:
 
     void Stop();
 
+    //deal with timers and queued messages without waiting for new ones,
+    //acceptor persist is a blocking region of the slice,
+    //return 0 if messages left, otherwise ms until next timer.
+    int RunSlice();
+
     void OneLoop(const int iTimeoutMs);
 
     void DealWithRetry();
 
     void ClearRetryQueue();
 
+    void DealWithMessage(MsgBuffer * poBuffer);
+
 public:
     int AddMessage(const char * pcMessage, const int iMessageLen);
 
+    int AddMessage(MsgBuffer * poBuffer);
+
     int AddRetryPaxosMsg(const PaxosMsg & oPaxosMsg);
 
     void AddNotify();
@@ -72,12 +86,11 @@ private:
     bool m_bIsEnd;
     bool m_bIsStart;
     Timer m_oTimer;
-    std::map<uint32_t, bool> m_mapTimerIDExist;
 
-    Queue<std::string *> m_oMessageQueue;
+    LockFreeQueue<MsgBuffer *> m_oMessageQueue;
     std::queue<PaxosMsg> m_oRetryQueue;
 
-    int m_iQueueMemSize;
+    std::atomic<int> m_iQueueMemSize;
 
     Config * m_poConfig;
     Instance * m_poInstance;
@@ -100,6 +100,109 @@ int LearnerState :: LearnValue(const uint64_t llInstanceID, const BallotNumber &
     return 0;
 }
 
+//learn continuous instances begin at llNowInstanceID, the value of llNowInstanceID become
+//learned and the rest wait in m_dequeBatchState until instance move on.
+int LearnerState :: LearnValueBatch(const google::protobuf::RepeatedPtrField<AcceptorStateData> & vecState, 
+        const uint64_t llNowInstanceID, const uint32_t iLastChecksum, uint64_t & llEndInstanceID)
+{
+    m_dequeBatchState.clear();
+    llEndInstanceID = llNowInstanceID;
+
+    std::vector<AcceptorStateData> vecLearnState;
+    uint32_t iChecksum = iLastChecksum;
+
+    for (auto & oMsgState : vecState)
+    {
+        if (oMsgState.instanceid() < llEndInstanceID)
+        {
+            continue;
+        }
+
+        if (oMsgState.instanceid() > llEndInstanceID)
+        {
+            break;
+        }
+
+        const std::string & sValue = oMsgState.acceptedvalue();
+
+        uint32_t iNewChecksum = 0;
+        if (llEndInstanceID > 0 && iChecksum == 0)
+        {
+            iNewChecksum = 0;
+        }
+        else if (sValue.size() > 0)
+        {
+            iNewChecksum = crc32(iChecksum, (const uint8_t *)sValue.data(), sValue.size(), CRC32SKIP);
+        }
+
+        //sender chain must be the same as mine, zero means that side's chain is broken.
+        if (oMsgState.checksum() != 0 && iNewChecksum != 0 && oMsgState.checksum() != iNewChecksum)
+        {
+            PLGErr("checksum not same, InstanceID %lu my checksum %u other checksum %u",
+                    llEndInstanceID, iNewChecksum, oMsgState.checksum());
+            llEndInstanceID = llNowInstanceID;
+            return -2;
+        }
+
+        AcceptorStateData oState;
+        oState.set_instanceid(llEndInstanceID);
+        oState.set_acceptedvalue(sValue);
+        oState.set_promiseid(oMsgState.acceptedid());
+        oState.set_promisenodeid(oMsgState.acceptednodeid());
+        oState.set_acceptedid(oMsgState.acceptedid());
+        oState.set_acceptednodeid(oMsgState.acceptednodeid());
+        oState.set_checksum(iNewChecksum);
+        vecLearnState.push_back(oState);
+
+        iChecksum = iNewChecksum;
+        llEndInstanceID++;
+    }
+
+    if (vecLearnState.size() == 0)
+    {
+        return 0;
+    }
+
+    WriteOptions oWriteOptions;
+    oWriteOptions.bSync = false;
+
+    int ret = m_oPaxosLog.WriteStateBatch(oWriteOptions, m_poConfig->GetMyGroupIdx(), vecLearnState);
+    if (ret != 0)
+    {
+        PLGErr("LogStorage.WriteStateBatch fail, InstanceID %lu Count %zu ret %d",
+                llNowInstanceID, vecLearnState.size(), ret);
+        llEndInstanceID = llNowInstanceID;
+        return ret;
+    }
+
+    LearnValueWithoutWrite(llNowInstanceID, vecLearnState[0].acceptedvalue(), vecLearnState[0].checksum());
+    m_dequeBatchState.assign(vecLearnState.begin() + 1, vecLearnState.end());
+
+    PLGDebug("OK, InstanceID %lu Count %zu checksum %u",
+            llNowInstanceID, vecLearnState.size(), iChecksum);
+
+    return 0;
+}
+
+void LearnerState :: LearnNextValueInBatch(const uint64_t llInstanceID)
+{
+    if (m_dequeBatchState.empty())
+    {
+        return;
+    }
+
+    const AcceptorStateData & oState = m_dequeBatchState.front();
+    if (oState.instanceid() != llInstanceID)
+    {
+        //instance jump by other way, like checkpoint.
+        m_dequeBatchState.clear();
+        return;
+    }
+
+    LearnValueWithoutWrite(oState.instanceid(), oState.acceptedvalue(), oState.checksum());
+    m_dequeBatchState.pop_front();
+}
+
 const std::string & LearnerState :: GetLearnValue()
 {
     return m_sLearnedValue;
@@ -120,9 +223,10 @@ Learner :: Learner(
         const LogStorage * poLogStorage,
         const IOLoop * poIOLoop,
         const CheckpointMgr * poCheckpointMgr,
-        const SMFac * poSMFac)
+        const SMFac * poSMFac,
+        const int iLearnBatchMaxSize)
     : Base(poConfig, poMsgTransport, poInstance), m_oLearnerState(poConfig, poLogStorage), 
-    m_oPaxosLog(poLogStorage), m_oLearnerSender((Config *)poConfig, this, &m_oPaxosLog),
+    m_oPaxosLog(poLogStorage), m_oLearnerSender((Config *)poConfig, this, &m_oPaxosLog, iLearnBatchMaxSize),
     m_oCheckpointReceiver((Config *)poConfig, (LogStorage *)poLogStorage)
 {
     m_poAcceptor = (Acceptor *)poAcceptor;
@@ -148,9 +252,12 @@ Learner :: ~Learner()
     delete m_poCheckpointSender;
 }
 
-void Learner :: StartLearnerSender()
+void Learner :: StartLearnerSender(JobScheduler * poScheduler)
 {
-    m_oLearnerSender.start();
+    if (poScheduler == nullptr || m_oLearnerSender.StartOnScheduler(poScheduler) != 0)
+    {
+        m_oLearnerSender.start();
+    }
 }
 
 const bool Learner :: IsLearned()
@@ -166,6 +273,7 @@ const std::string & Learner :: GetLearnValue()
 void Learner :: InitForNewPaxosInstance()
 {
     m_oLearnerState.Init();
+    m_oLearnerState.LearnNextValueInBatch(GetInstanceID());
 }
 
 const uint32_t Learner :: GetNewChecksum() const
@@ -239,6 +347,7 @@ void Learner :: AskforLearn_Noop(const bool bIsStart)
 void Learner :: AskforLearn()
 {
     BP->GetLearnerBP()->AskforLearn();
+    m_poConfig->GetInstanceTrace()->Add(TraceEvent_AskforLearn, GetInstanceID());
 
     PLGHead("START");
 
@@ -505,6 +614,8 @@ void Learner :: OnSendLearnValue(const PaxosMsg & oPaxosMsg)
             return;
         }
         
+        m_poConfig->GetInstanceTrace()->Add(TraceEvent_LearnFromOther, oPaxosMsg.instanceid(), oPaxosMsg.nodeid());
+
         PLGHead("END LearnValue OK, proposalid %lu proposalid_nodeid %lu valueLen %zu", 
                 oPaxosMsg.proposalid(), oPaxosMsg.nodeid(), oPaxosMsg.value().size());
     }
@@ -518,12 +629,81 @@ void Learner :: OnSendLearnValue(const PaxosMsg & oPaxosMsg)
     }
 }
 
+int Learner :: SendLearnValueBatch(
+        const nodeid_t iSendNodeID,
+        const std::vector<AcceptorStateData> & vecState,
+        const uint32_t iLastChecksum)
+{
+    BP->GetLearnerBP()->SendLearnValue();
+
+    PaxosMsg oPaxosMsg;
+    
+    oPaxosMsg.set_msgtype(MsgType_PaxosLearner_SendLearnValueBatch);
+    oPaxosMsg.set_instanceid(vecState.front().instanceid());
+    oPaxosMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oPaxosMsg.set_lastchecksum(iLastChecksum);
+    oPaxosMsg.set_flag(PaxosMsgFlagType_SendLearnValue_NeedAck);
+
+    for (auto & oState : vecState)
+    {
+        *oPaxosMsg.add_learnstates() = oState;
+    }
+
+    return SendMessage(iSendNodeID, oPaxosMsg, Message_SendType_TCP);
+}
+
+void Learner :: OnSendLearnValueBatch(const PaxosMsg & oPaxosMsg)
+{
+    BP->GetLearnerBP()->OnSendLearnValue();
+
+    PLGHead("START Msg.InstanceID %lu Now.InstanceID %lu Msg.from_nodeid %lu Msg.Count %d",
+            oPaxosMsg.instanceid(), GetInstanceID(), oPaxosMsg.nodeid(), oPaxosMsg.learnstates_size());
+
+    if (oPaxosMsg.instanceid() > GetInstanceID())
+    {
+        PLGDebug("[Latest Msg] i can't learn");
+        return;
+    }
+
+    uint64_t llEndInstanceID = GetInstanceID();
+    int ret = m_oLearnerState.LearnValueBatch(oPaxosMsg.learnstates(), GetInstanceID(), GetLastChecksum(), llEndInstanceID);
+    if (ret != 0)
+    {
+        PLGErr("LearnState.LearnValueBatch fail, ret %d", ret);
+        return;
+    }
+
+    if (llEndInstanceID == GetInstanceID())
+    {
+        PLGDebug("[Lag Msg] no need to learn");
+    }
+    else
+    {
+        m_poConfig->GetInstanceTrace()->Add(TraceEvent_LearnFromOther, GetInstanceID(), oPaxosMsg.nodeid());
+
+        PLGHead("END LearnValueBatch OK, InstanceID %lu EndInstanceID %lu", GetInstanceID(), llEndInstanceID);
+    }
+
+    if (oPaxosMsg.flag() == PaxosMsgFlagType_SendLearnValue_NeedAck)
+    {
+        Reset_AskforLearn_Noop();
+
+        //whole batch is written, ack the end so that sender can go on with next batch.
+        SendLearnValue_Ack(oPaxosMsg.nodeid(), llEndInstanceID);
+    }
+}
+
 void Learner :: SendLearnValue_Ack(const nodeid_t iSendNodeID)
 {
-    PLGHead("START LastAck.Instanceid %lu Now.Instanceid %lu", m_llLastAckInstanceID, GetInstanceID());
+    SendLearnValue_Ack(iSendNodeID, GetInstanceID());
+}
+
+void Learner :: SendLearnValue_Ack(const nodeid_t iSendNodeID, const uint64_t llAckInstanceID)
+{
+    PLGHead("START LastAck.Instanceid %lu Ack.Instanceid %lu", m_llLastAckInstanceID, llAckInstanceID);
 
     // ÿ LearnerReceiver_ACK_LEAD ŷһظ
-    if (GetInstanceID() < m_llLastAckInstanceID + LearnerReceiver_ACK_LEAD)
+    if (llAckInstanceID < m_llLastAckInstanceID + LearnerReceiver_ACK_LEAD)
     {
         PLGImp("No need to ack");
         return;
@@ -531,10 +711,10 @@ void Learner :: SendLearnValue_Ack(const nodeid_t iSendNodeID)
     
     BP->GetLearnerBP()->SendLearnValue_Ack();
 
-    m_llLastAckInstanceID = GetInstanceID();
+    m_llLastAckInstanceID = llAckInstanceID;
 
     PaxosMsg oPaxosMsg;
-    oPaxosMsg.set_instanceid(GetInstanceID());
+    oPaxosMsg.set_instanceid(llAckInstanceID);
     oPaxosMsg.set_msgtype(MsgType_PaxosLearner_SendLearnValue_Ack);
     oPaxosMsg.set_nodeid(m_poConfig->GetMyNodeID());
 
@@ -641,6 +821,7 @@ void Learner :: OnProposerSendSuccess(const PaxosMsg & oPaxosMsg)
             m_poAcceptor->GetAcceptorState()->GetChecksum());
     
     BP->GetLearnerBP()->OnProposerSendSuccessSuccessLearn();
+    m_poConfig->GetInstanceTrace()->Add(TraceEvent_LearnFromProposer, oPaxosMsg.instanceid(), oPaxosMsg.nodeid());
 
     PLGHead("END Learn value OK, value %zu", m_poAcceptor->GetAcceptorState()->GetAcceptedValue().size());
 
@@ -23,6 +23,8 @@ See the AUTHORS file for names of contributors.
 
 #include "base.h"
 #include <string>
+#include <vector>
+#include <deque>
 #include "commdef.h"
 #include "comm_include.h"
 #include "paxos_log.h"
@@ -48,6 +50,11 @@ public:
     void LearnValueWithoutWrite(const uint64_t llInstanceID, 
             const std::string & sValue, const uint32_t iNewChecksum);
 
+    int LearnValueBatch(const google::protobuf::RepeatedPtrField<AcceptorStateData> & vecState, 
+            const uint64_t llNowInstanceID, const uint32_t iLastChecksum, uint64_t & llEndInstanceID);
+
+    void LearnNextValueInBatch(const uint64_t llInstanceID);
+
     const std::string & GetLearnValue();
 
     const bool GetIsLearned();
@@ -59,6 +66,9 @@ private:
     bool m_bIsLearned;
     uint32_t m_iNewChecksum;
 
+    //written but not yet executed instances of the last learn batch.
+    std::deque<AcceptorStateData> m_dequeBatchState;
+
     Config * m_poConfig;
     PaxosLog m_oPaxosLog;
 };
@@ -81,10 +91,11 @@ public:
             const LogStorage * poLogStorage,
             const IOLoop * poIOLoop,
             const CheckpointMgr * poCheckpointMgr,
-            const SMFac * poSMFac);
+            const SMFac * poSMFac,
+            const int iLearnBatchMaxSize = 0);
     virtual ~Learner();
 
-    void StartLearnerSender();
+    void StartLearnerSender(JobScheduler * poScheduler);
 
     virtual void InitForNewPaxosInstance();
 
@@ -124,8 +135,17 @@ public:
 
     void OnSendLearnValue(const PaxosMsg & oPaxosMsg);
 
+    int SendLearnValueBatch(
+            const nodeid_t iSendNodeID,
+            const std::vector<AcceptorStateData> & vecState,
+            const uint32_t iLastChecksum);
+
+    void OnSendLearnValueBatch(const PaxosMsg & oPaxosMsg);
+
     void SendLearnValue_Ack(const nodeid_t iSendNodeID);
 
+    void SendLearnValue_Ack(const nodeid_t iSendNodeID, const uint64_t llAckInstanceID);
+
     void OnSendLearnValue_Ack(const PaxosMsg & oPaxosMsg);
 
     //success learn
@@ -25,10 +25,20 @@ See the AUTHORS file for names of contributors.
 namespace phxpaxos
 {
 
-LearnerSender :: LearnerSender(Config * poConfig, Learner * poLearner, PaxosLog * poPaxosLog)
+LearnerSender :: LearnerSender(Config * poConfig, Learner * poLearner, PaxosLog * poPaxosLog, const int iBatchMaxSize)
     : m_poConfig(poConfig), m_poLearner(poLearner), m_poPaxosLog(poPaxosLog)
 {
     m_iAckLead = LearnerSender_ACK_LEAD; 
+    m_iBatchMaxSize = iBatchMaxSize;
+    m_llNextBatchInstanceID = (uint64_t)-1;
+    m_bIsSendingValue = false;
+    m_bIsWaitingAck = false;
+    m_llSendInstanceID = 0;
+    m_iSendingToNodeID = nullnode;
+    m_iLastChecksum = 0;
+    m_iLastSendCount = 0;
+    m_iSendCount = 0;
+    m_llNextSendTime = 0;
     m_bIsEnd = false;
     m_bIsStart = false;
     SendDone();
@@ -40,6 +50,12 @@ LearnerSender :: ~LearnerSender()
 
 void LearnerSender :: Stop()
 {
+    if (IsOnScheduler())
+    {
+        StopOnScheduler();
+        return;
+    }
+
     // е߳·
     if (m_bIsStart)
     {
@@ -52,20 +68,39 @@ void LearnerSender :: run()
 {
     m_bIsStart = true;
 
-    while (true)
+    while (!m_bIsEnd)
     {
-        WaitToSend();
+        int iWaitMs = RunSlice();
+        if (iWaitMs <= 0)
+        {
+            continue;
+        }
 
-        if (m_bIsEnd)
+        //comfirm and ack interupt the wait.
+        m_oLock.Lock();
+        if (m_bIsSendingValue || !m_bIsComfirmed)
         {
-            PLGHead("Learner.Sender [END]");
-            return;
+            m_oLock.WaitTime(iWaitMs);
         }
+        m_oLock.UnLock();
+    }
 
-        SendLearnedValue(m_llBeginInstanceID, m_iSendToNodeID);
+    PLGHead("Learner.Sender [END]");
+}
 
-        SendDone();
+int LearnerSender :: RunSlice()
+{
+    if (!m_bIsSendingValue)
+    {
+        if (!IsComfirmed())
+        {
+            return LEARNER_SENDER_IDLE_WAIT_MS;
+        }
+
+        BeginSend();
     }
+
+    return SendSlice();
 }
 
 ////////////////////////////////////////
@@ -105,7 +140,7 @@ void LearnerSender :: CutAckLead()
     }
 }
 
-const bool LearnerSender :: CheckAck(const uint64_t llSendInstanceID)
+int LearnerSender :: CheckAck(const uint64_t llSendInstanceID)
 {
     m_oLock.Lock();
 
@@ -116,10 +151,10 @@ const bool LearnerSender :: CheckAck(const uint64_t llSendInstanceID)
         PLGImp("Already catch up, ack instanceid %lu now send instanceid %lu", 
                 m_llAckInstanceID, llSendInstanceID);
         m_oLock.UnLock();
-        return false;
+        return -1;
     }
 
-    while (llSendInstanceID > m_llAckInstanceID + m_iAckLead)
+    if (llSendInstanceID > m_llAckInstanceID + m_iAckLead)
     {
         uint64_t llNowTime = Time::GetSteadyClockMS();
         uint64_t llPassTime = llNowTime > m_llAbsLastAckTime ? llNowTime - m_llAbsLastAckTime : 0;
@@ -132,7 +167,7 @@ const bool LearnerSender :: CheckAck(const uint64_t llSendInstanceID)
             // ʱҳ趨Ĳֵټɡ
             CutAckLead();
             m_oLock.UnLock();
-            return false;
+            return -1;
         }
 
         BP->GetLearnerBP()->SenderAckDelay();
@@ -140,12 +175,13 @@ const bool LearnerSender :: CheckAck(const uint64_t llSendInstanceID)
                 //llSendInstanceID, m_llAckInstanceID);
 
         // ûгʱ򵥵ص 20 msöԷѧϰٶ׷Լ
-        m_oLock.WaitTime(20);
+        m_oLock.UnLock();
+        return LEARNER_SENDER_ACK_WAIT_MS;
     }
 
     m_oLock.UnLock();
 
-    return true;
+    return 0;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -193,11 +229,18 @@ const bool LearnerSender :: Comfirm(const uint64_t llBeginInstanceID, const node
 
     m_oLock.UnLock();
 
+    if (bComfirmRet)
+    {
+        NotifyScheduler();
+    }
+
     return bComfirmRet;
 }
 
 void LearnerSender :: Ack(const uint64_t llAckInstanceID, const nodeid_t iFromNodeID)
 {
+    bool bIsNewAck = false;
+
     m_oLock.Lock();
 
     if (IsIMSending() && m_bIsComfirmed)
@@ -209,84 +252,134 @@ void LearnerSender :: Ack(const uint64_t llAckInstanceID, const nodeid_t iFromNo
                 m_llAckInstanceID = llAckInstanceID;
                 m_llAbsLastAckTime = Time::GetSteadyClockMS();
                 m_oLock.Interupt();
+                bIsNewAck = true;
             }
         }
     }
 
     m_oLock.UnLock();
+
+    if (bIsNewAck)
+    {
+        NotifyScheduler();
+    }
 }    
 
 ///////////////////////////////////////////////
 
-void LearnerSender :: WaitToSend()
+const bool LearnerSender :: IsComfirmed()
 {
     m_oLock.Lock();
-    // νȷϾҪȴԷ֪Լ chosen Ϣ֮ѾȷҪԼ
-    // ĽڵȥѧϰܷԼݵǸѾȷϹĽڵ㡣
-    while (!m_bIsComfirmed)
-    {
-        // ȴ 1000ms 
-        m_oLock.WaitTime(1000);
-        if (m_bIsEnd)
-        {
-            break;
-        }
-    }
+    bool bIsComfirmed = m_bIsComfirmed;
     m_oLock.UnLock();
+
+    return bIsComfirmed;
 }
 
-void LearnerSender :: SendLearnedValue(const uint64_t llBeginInstanceID, const nodeid_t iSendToNodeID)
+void LearnerSender :: BeginSend()
 {
-    PLGHead("BeginInstanceID %lu SendToNodeID %lu", llBeginInstanceID, iSendToNodeID);
+    m_oLock.Lock();
+    m_llSendInstanceID = m_llBeginInstanceID;
+    m_iSendingToNodeID = m_iSendToNodeID;
+    m_oLock.UnLock();
 
-    uint64_t llSendInstanceID = llBeginInstanceID;
-    int ret = 0;
-    
-    uint32_t iLastChecksum = 0;
+    PLGHead("BeginInstanceID %lu SendToNodeID %lu", m_llSendInstanceID, m_iSendingToNodeID);
 
+    m_bIsSendingValue = true;
+    m_bIsWaitingAck = false;
+    m_iLastChecksum = 0;
+    m_iLastSendCount = 0;
+    m_iSendCount = 0;
+    m_llNextSendTime = 0;
+    m_llNextBatchInstanceID = (uint64_t)-1;
+}
+
+void LearnerSender :: EndSend()
+{
+    m_bIsSendingValue = false;
+    SendDone();
+}
+
+int LearnerSender :: SendSlice()
+{
     //control send speed to avoid affecting the network too much.
     int iSendQps = LearnerSender_SEND_QPS;
-	
     // ѵд? Ϊʲô qps ԽߣߵʱԽ?
     // 3.27 : ߻ظˣۻˣӦڵٵʱ򱣳ָʱ䡣
     int iSleepMs = iSendQps > 1000 ? 1 : 1000 / iSendQps;
-	
+
     // ָÿγֵʱ learn ̻߳һֹԴռù
     int iSendInterval = iSendQps > 1000 ? iSendQps / 1000 + 1 : 1; 
 
-    PLGDebug("SendQps %d SleepMs %d SendInterval %d AckLead %d",
-            iSendQps, iSleepMs, iSendInterval, m_iAckLead);
+    //woken up by ack before the speed control wait end.
+    uint64_t llNowTime = Time::GetSteadyClockMS();
+    if (llNowTime < m_llNextSendTime)
+    {
+        return (int)(m_llNextSendTime - llNowTime);
+    }
 
-    int iSendCount = 0;
-    while (llSendInstanceID < m_poLearner->GetInstanceID())
-    {    
-        ret = SendOne(llSendInstanceID, iSendToNodeID, iLastChecksum);
-        if (ret != 0)
+    while (true)
+    {
+        if (m_bIsWaitingAck)
         {
-            PLGErr("SendOne fail, SendInstanceID %lu SendToNodeID %lu ret %d",
-                    llSendInstanceID, iSendToNodeID, ret);
-            return;
+            //ack lead count from the begin of the batch, receiver ack the end of it.
+            int iAckWaitMs = CheckAck(m_llSendInstanceID);
+            if (iAckWaitMs < 0)
+            {
+                EndSend();
+                return LEARNER_SENDER_IDLE_WAIT_MS;
+            }
+            else if (iAckWaitMs > 0)
+            {
+                return iAckWaitMs;
+            }
+
+            m_bIsWaitingAck = false;
+            m_iSendCount += m_iLastSendCount;
+            m_llSendInstanceID += m_iLastSendCount;
+            ReleshSending();
+
+            if (m_iSendCount >= iSendInterval)
+            {
+                m_iSendCount = 0;
+                m_llNextSendTime = Time::GetSteadyClockMS() + iSleepMs;
+                return iSleepMs;
+            }
         }
 
-        if (!CheckAck(llSendInstanceID))
+        if (m_llSendInstanceID >= m_poLearner->GetInstanceID())
         {
-            return;
+            break;
         }
 
-        iSendCount++;
-        llSendInstanceID++;
-        ReleshSending();
+        int ret = 0;
+        m_iLastSendCount = 1;
+        if (m_iBatchMaxSize > 0)
+        {
+            ret = SendBatch(m_llSendInstanceID, m_iSendingToNodeID, m_iLastChecksum, m_iLastSendCount);
+        }
+        else
+        {
+            ret = SendOne(m_llSendInstanceID, m_iSendingToNodeID, m_iLastChecksum);
+        }
 
-        if (iSendCount >= iSendInterval)
+        if (ret != 0)
         {
-            iSendCount = 0;
-            Time::MsSleep(iSleepMs);
+            PLGErr("Send fail, SendInstanceID %lu SendToNodeID %lu ret %d",
+                    m_llSendInstanceID, m_iSendingToNodeID, ret);
+            EndSend();
+            return LEARNER_SENDER_IDLE_WAIT_MS;
         }
+
+        m_bIsWaitingAck = true;
     }
 
     //succ send, reset ack lead.
     m_iAckLead = LearnerSender_ACK_LEAD;
-    PLGImp("SendDone, SendEndInstanceID %lu", llSendInstanceID);
+    PLGImp("SendDone, SendEndInstanceID %lu", m_llSendInstanceID);
+
+    EndSend();
+    return LEARNER_SENDER_IDLE_WAIT_MS;
 }
 
 int LearnerSender :: SendOne(const uint64_t llSendInstanceID, const nodeid_t iSendToNodeID, uint32_t & iLastChecksum)
@@ -309,6 +402,61 @@ int LearnerSender :: SendOne(const uint64_t llSendInstanceID, const nodeid_t iSe
     return ret;
 }
 
+//pack continuous instances up to m_iBatchMaxSize bytes into one message, at least one.
+int LearnerSender :: SendBatch(const uint64_t llBeginInstanceID, const nodeid_t iSendToNodeID, 
+        uint32_t & iLastChecksum, int & iSendCount)
+{
+    std::vector<AcceptorStateData> vecState;
+    int iBatchSize = 0;
+
+    for (uint64_t llSendInstanceID = llBeginInstanceID; 
+            llSendInstanceID < m_poLearner->GetInstanceID(); llSendInstanceID++)
+    {
+        AcceptorStateData oState;
+        if (llSendInstanceID == m_llNextBatchInstanceID)
+        {
+            oState.Swap(&m_oNextBatchState);
+            m_llNextBatchInstanceID = (uint64_t)-1;
+        }
+        else
+        {
+            int ret = m_poPaxosLog->ReadState(m_poConfig->GetMyGroupIdx(), llSendInstanceID, oState);
+            if (ret != 0)
+            {
+                return ret;
+            }
+        }
+
+        int iStateSize = (int)oState.ByteSizeLong();
+        if (vecState.size() > 0 && iBatchSize + iStateSize > m_iBatchMaxSize)
+        {
+            m_oNextBatchState.Swap(&oState);
+            m_llNextBatchInstanceID = llSendInstanceID;
+            break;
+        }
+
+        BP->GetLearnerBP()->SenderSendOnePaxosLog();
+
+        iBatchSize += iStateSize;
+        vecState.push_back(oState);
+    }
+
+    if (vecState.size() == 0)
+    {
+        return -1;
+    }
+
+    int ret = m_poLearner->SendLearnValueBatch(iSendToNodeID, vecState, iLastChecksum);
+
+    iLastChecksum = vecState.back().checksum();
+    iSendCount = (int)vecState.size();
+
+    PLGDebug("BeginInstanceID %lu Count %d BatchSize %d ret %d", 
+            llBeginInstanceID, iSendCount, iBatchSize, ret);
+
+    return ret;
+}
+
 void LearnerSender :: SendDone()
 {
     m_oLock.Lock();
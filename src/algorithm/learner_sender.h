@@ -25,22 +25,31 @@ See the AUTHORS file for names of contributors.
 #include "comm_include.h"
 #include "config_include.h"
 #include "paxos_log.h"
+#include "job_scheduler.h"
 
 namespace phxpaxos
 {
 
 class Learner;
 
-class LearnerSender : public Thread
+//idle sender check for a comfirmed send at least this often.
+#define LEARNER_SENDER_IDLE_WAIT_MS 1000
+//sender too far ahead of ack, check again after this.
+#define LEARNER_SENDER_ACK_WAIT_MS 20
+
+class LearnerSender : public Thread, public ScheduledJob
 {
 public:
-    LearnerSender(Config * poConfig, Learner * poLearner, PaxosLog * poPaxosLog);
+    LearnerSender(Config * poConfig, Learner * poLearner, PaxosLog * poPaxosLog, const int iBatchMaxSize = 0);
     ~LearnerSender();
 
     void run();
 
     void Stop();
 
+    //send learned values a slice at a time, return ms until next slice.
+    int RunSlice();
+
 public:
     const bool Prepare(const uint64_t llBeginInstanceID, const nodeid_t iSendToNodeID);
 
@@ -49,19 +58,27 @@ public:
     void Ack(const uint64_t llAckInstanceID, const nodeid_t iFromNodeID);
 
 private:
-    void WaitToSend();
+    const bool IsComfirmed();
+
+    void BeginSend();
 
-    void SendLearnedValue(const uint64_t llBeginInstanceID, const nodeid_t iSendToNodeID);
+    int SendSlice();
+
+    void EndSend();
 
     int SendOne(const uint64_t llSendInstanceID, const nodeid_t iSendToNodeID, uint32_t & iLastChecksum);
 
+    int SendBatch(const uint64_t llBeginInstanceID, const nodeid_t iSendToNodeID, 
+            uint32_t & iLastChecksum, int & iSendCount);
+
     void SendDone();
 
     const bool IsIMSending();
 
     void ReleshSending();
 
-    const bool CheckAck(const uint64_t llSendInstanceID);
+    //return -1 if stop sending, 0 if can go on, otherwise ms to wait for ack.
+    int CheckAck(const uint64_t llSendInstanceID);
 
     void CutAckLead();
 
@@ -82,6 +99,21 @@ private:
     uint64_t m_llAckInstanceID;
     uint64_t m_llAbsLastAckTime;
     int m_iAckLead;
+    int m_iBatchMaxSize;
+
+    //state read but over the batch size, it begins the next batch without read again.
+    AcceptorStateData m_oNextBatchState;
+    uint64_t m_llNextBatchInstanceID;
+
+    //a comfirmed send in progress, only used by sender slices.
+    bool m_bIsSendingValue;
+    bool m_bIsWaitingAck;
+    uint64_t m_llSendInstanceID;
+    nodeid_t m_iSendingToNodeID;
+    uint32_t m_iLastChecksum;
+    int m_iLastSendCount;
+    int m_iSendCount;
+    uint64_t m_llNextSendTime;
 
     bool m_bIsEnd;
     bool m_bIsStart;
@@ -143,6 +143,8 @@ Proposer :: Proposer(
     m_iAcceptTimerID = 0;
     m_llTimeoutInstanceID = 0;
 
+    m_llStageBeginTimeUs = 0;
+
     m_iLastPrepareTimeoutMs = m_poConfig->GetPrepareTimeoutMs();
     m_iLastAcceptTimeoutMs = m_poConfig->GetAcceptTimeoutMs();
 
@@ -301,6 +303,7 @@ void Proposer :: Prepare(const bool bNeedNewBallot)
 
     BP->GetProposerBP()->Prepare();
     m_oTimeStat.Point();
+    m_llStageBeginTimeUs = Time::GetSteadyClockUS();
     
     ExitAccept();
     m_bIsPreparing = true;
@@ -327,6 +330,8 @@ void Proposer :: Prepare(const bool bNeedNewBallot)
     // ǰ prepare 뵽ʱȥ
     AddPrepareTimer();
 
+    m_poConfig->GetInstanceTrace()->Add(TraceEvent_Prepare, GetInstanceID(), m_oProposerState.GetProposalID());
+
     PLGHead("END OK");
 
     // 㲥еĽڵ㳢 prepare 
@@ -384,6 +389,10 @@ void Proposer :: OnPrepareReply(const PaxosMsg & oPaxosMsg)
     {
         int iUseTimeMs = m_oTimeStat.Point();
         BP->GetProposerBP()->PreparePass(iUseTimeMs);
+        uint64_t llUseTimeUs = Time::GetSteadyClockUS() - m_llStageBeginTimeUs;
+        BP->GetLatencyBP()->StageUseTimeUs(m_poConfig->GetMyGroupIdx(), LatencyStage_Prepare, llUseTimeUs);
+        m_poConfig->GetInstanceTrace()->Add(TraceEvent_PreparePass, GetInstanceID(),
+                m_oProposerState.GetProposalID(), llUseTimeUs);
         PLGImp("[Pass] start accept, usetime %dms", iUseTimeMs);
 
         // 3.21 : ´ٴ proposer ʱҪٽ prepare ׶ˡ
@@ -398,6 +407,7 @@ void Proposer :: OnPrepareReply(const PaxosMsg & oPaxosMsg)
             || m_oMsgCounter.IsAllReceiveOnThisRound())
     {
         BP->GetProposerBP()->PrepareNotPass();
+        m_poConfig->GetInstanceTrace()->Add(TraceEvent_PrepareNotPass, GetInstanceID(), m_oProposerState.GetProposalID());
         PLGImp("[Not Pass] wait 30ms and restart prepare");
         AddPrepareTimer(OtherUtils::FastRand() % 30 + 10);
     }
@@ -423,6 +433,7 @@ void Proposer :: Accept()
 
     BP->GetProposerBP()->Accept();
     m_oTimeStat.Point();
+    m_llStageBeginTimeUs = Time::GetSteadyClockUS();
 
     // Ѿ accept ״̬ prepare ׶εı־λͶʱ
     ExitPrepare();
@@ -441,6 +452,8 @@ void Proposer :: Accept()
 
     AddAcceptTimer();
 
+    m_poConfig->GetInstanceTrace()->Add(TraceEvent_Accept, GetInstanceID(), m_oProposerState.GetProposalID());
+
     PLGHead("END");
 
     // 3.27 : ͸еĽڵ㳢 accept Լٳԣʲôô?
@@ -491,6 +504,10 @@ void Proposer :: OnAcceptReply(const PaxosMsg & oPaxosMsg)
     {
         int iUseTimeMs = m_oTimeStat.Point();
         BP->GetProposerBP()->AcceptPass(iUseTimeMs);
+        uint64_t llUseTimeUs = Time::GetSteadyClockUS() - m_llStageBeginTimeUs;
+        BP->GetLatencyBP()->StageUseTimeUs(m_poConfig->GetMyGroupIdx(), LatencyStage_Accept, llUseTimeUs);
+        m_poConfig->GetInstanceTrace()->Add(TraceEvent_AcceptPass, GetInstanceID(),
+                m_oProposerState.GetProposalID(), llUseTimeUs);
         PLGImp("[Pass] Start send learn, usetime %dms", iUseTimeMs);
         ExitAccept();
         m_poLearner->ProposerSendSuccess(GetInstanceID(), m_oProposerState.GetProposalID());
@@ -499,6 +516,7 @@ void Proposer :: OnAcceptReply(const PaxosMsg & oPaxosMsg)
             || m_oMsgCounter.IsAllReceiveOnThisRound())
     {
         BP->GetProposerBP()->AcceptNotPass();
+        m_poConfig->GetInstanceTrace()->Add(TraceEvent_AcceptNotPass, GetInstanceID(), m_oProposerState.GetProposalID());
         PLGImp("[Not pass] wait 30ms and Restart prepare");
         
         // 趨һʱ´ loop ʱȥ
@@ -531,6 +549,7 @@ void Proposer :: OnPrepareTimeout()
     }
 
     BP->GetProposerBP()->PrepareTimeout();
+    m_poConfig->GetInstanceTrace()->Add(TraceEvent_PrepareTimeout, GetInstanceID());
 
     // Ϊڵ㷢ͻ· proposalID ֵ
     Prepare(m_bWasRejectBySomeone);
@@ -548,6 +567,7 @@ void Proposer :: OnAcceptTimeout()
     }
     
     BP->GetProposerBP()->AcceptTimeout();
+    m_poConfig->GetInstanceTrace()->Add(TraceEvent_AcceptTimeout, GetInstanceID());
 
     // ͬ
     Prepare(m_bWasRejectBySomeone);
@@ -139,6 +139,7 @@ public:
     bool m_bWasRejectBySomeone;
 
     TimeStat m_oTimeStat;
+    uint64_t m_llStageBeginTimeUs;
 };
     
 }
@@ -0,0 +1,422 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "loopback_network.h"
+#include "bench_sm.h"
+#include "phxpaxos/node.h"
+#include "phxpaxos/options.h"
+#include "utils_include.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace bench;
+using namespace phxpaxos;
+using namespace std;
+
+#define LOOPBACK_BASE_PORT 21000
+
+struct BenchConfig
+{
+    int iReplicaCount;
+    vector<int> vecGroupCount;
+    vector<int> vecValueSize;
+    vector<int> vecBatchCount;
+    int iConcurrentCount;
+    int iWriteCount;
+    int iLatencyUs;
+    int iJitterUs;
+    int iLossPerTenThousand;
+};
+
+static uint64_t GetSteadyClockUS()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int parse_int_list(const char * pcStr, vector<int> & vecValue)
+{
+    vecValue.clear();
+    string sStr = pcStr;
+    size_t iPos = 0;
+    while (iPos <= sStr.size())
+    {
+        size_t iEnd = sStr.find(',', iPos);
+        if (iEnd == string::npos)
+        {
+            iEnd = sStr.size();
+        }
+
+        string sItem = sStr.substr(iPos, iEnd - iPos);
+        if (sItem.empty())
+        {
+            return -1;
+        }
+
+        vecValue.push_back(atoi(sItem.c_str()));
+        iPos = iEnd + 1;
+    }
+
+    return 0;
+}
+
+//3 or 5 replicas running in this process, connected by one LoopbackHub.
+class LoopbackCluster
+{
+public:
+    LoopbackCluster(LoopbackHub * poHub) : m_poHub(poHub) { }
+
+    ~LoopbackCluster()
+    {
+        Stop();
+    }
+
+    int Run(const int iReplicaCount, const int iGroupCount, const int iBatchCount, const string & sLogPath)
+    {
+        NodeInfoList vecNodeInfoList;
+        for (int i = 0; i < iReplicaCount; i++)
+        {
+            vecNodeInfoList.push_back(NodeInfo("127.0.0.1", LOOPBACK_BASE_PORT + i));
+        }
+
+        for (int i = 0; i < iReplicaCount; i++)
+        {
+            const NodeInfo & oMyNode = vecNodeInfoList[i];
+
+            Options oOptions;
+            oOptions.sLogStoragePath = sLogPath + "/node_" + to_string(i);
+            if (mkdir(oOptions.sLogStoragePath.c_str(), S_IRWXU) == -1)
+            {
+                printf("create dir fail, path %s\n", oOptions.sLogStoragePath.c_str());
+                return -1;
+            }
+
+            LoopbackNetWork * poNetWork = new LoopbackNetWork(m_poHub, oMyNode);
+            m_vecNetWork.push_back(poNetWork);
+
+            oOptions.poNetWork = poNetWork;
+            oOptions.iGroupCount = iGroupCount;
+            oOptions.oMyNode = oMyNode;
+            oOptions.vecNodeInfoList = vecNodeInfoList;
+            oOptions.bUseBatchPropose = iBatchCount > 0;
+
+            for (int iGroupIdx = 0; iGroupIdx < iGroupCount; iGroupIdx++)
+            {
+                BenchSM * poBenchSM = new BenchSM(oMyNode.GetNodeID(), iGroupIdx);
+                m_vecSMList.push_back(poBenchSM);
+
+                GroupSMInfo oSMInfo;
+                oSMInfo.iGroupIdx = iGroupIdx;
+                oSMInfo.vecSMList.push_back(poBenchSM);
+                oOptions.vecGroupSMInfoList.push_back(oSMInfo);
+            }
+
+            Node * poNode = nullptr;
+            int ret = Node::RunNode(oOptions, poNode);
+            if (ret != 0)
+            {
+                printf("run node %d fail, ret %d\n", i, ret);
+                return ret;
+            }
+            m_vecNode.push_back(poNode);
+
+            for (int iGroupIdx = 0; iGroupIdx < iGroupCount; iGroupIdx++)
+            {
+                poNode->SetBatchDelayTimeMs(iGroupIdx, 1);
+                poNode->SetBatchCount(iGroupIdx, iBatchCount);
+            }
+        }
+
+        return 0;
+    }
+
+    void Stop()
+    {
+        //network first, then no message reach a deleted node.
+        for (auto & poNetWork : m_vecNetWork)
+        {
+            poNetWork->StopNetWork();
+        }
+
+        for (auto & poNode : m_vecNode)
+        {
+            delete poNode;
+        }
+        m_vecNode.clear();
+
+        for (auto & poNetWork : m_vecNetWork)
+        {
+            delete poNetWork;
+        }
+        m_vecNetWork.clear();
+
+        for (auto & poBenchSM : m_vecSMList)
+        {
+            delete poBenchSM;
+        }
+        m_vecSMList.clear();
+    }
+
+    Node * GetProposeNode()
+    {
+        return m_vecNode[0];
+    }
+
+private:
+    LoopbackHub * m_poHub;
+    vector<LoopbackNetWork *> m_vecNetWork;
+    vector<Node *> m_vecNode;
+    vector<BenchSM *> m_vecSMList;
+};
+
+class LoopbackBenchClient : public phxpaxos::Thread
+{
+public:
+    LoopbackBenchClient(Node * poNode, const int iGroupCount, const bool bUseBatch,
+            const int iWriteCount, const int iValueSize) :
+        m_poNode(poNode), m_iGroupCount(iGroupCount), m_bUseBatch(bUseBatch),
+        m_iWriteCount(iWriteCount), m_iValueSize(iValueSize), m_iFailCount(0) { }
+
+    ~LoopbackBenchClient() { }
+
+    void run()
+    {
+        string sValue(m_iValueSize, 'a');
+        m_vecLatencyUs.reserve(m_iWriteCount);
+
+        SMCtx oCtx;
+        //smid must same to BenchSM.SMID().
+        oCtx.m_iSMID = 1;
+        oCtx.m_pCtx = nullptr;
+
+        for (int i = 0; i < m_iWriteCount; i++)
+        {
+            int iGroupIdx = i % m_iGroupCount;
+            uint64_t llInstanceID = 0;
+            uint32_t iBatchIndex = 0;
+
+            uint64_t llBeginUs = GetSteadyClockUS();
+            int ret = 0;
+            if (m_bUseBatch)
+            {
+                ret = m_poNode->BatchPropose(iGroupIdx, sValue, llInstanceID, iBatchIndex, &oCtx);
+            }
+            else
+            {
+                ret = m_poNode->Propose(iGroupIdx, sValue, llInstanceID, &oCtx);
+            }
+
+            if (ret != 0)
+            {
+                m_iFailCount++;
+                continue;
+            }
+
+            m_vecLatencyUs.push_back(GetSteadyClockUS() - llBeginUs);
+        }
+    }
+
+    const vector<uint64_t> & GetLatencyUs() const { return m_vecLatencyUs; }
+
+    int GetFailCount() const { return m_iFailCount; }
+
+private:
+    Node * m_poNode;
+    int m_iGroupCount;
+    bool m_bUseBatch;
+    int m_iWriteCount;
+    int m_iValueSize;
+
+    vector<uint64_t> m_vecLatencyUs;
+    int m_iFailCount;
+};
+
+uint64_t Percentile(const vector<uint64_t> & vecSorted, const double dRatio)
+{
+    if (vecSorted.empty())
+    {
+        return 0;
+    }
+
+    size_t iIdx = (size_t)(dRatio * (vecSorted.size() - 1));
+    return vecSorted[iIdx];
+}
+
+int BenchOne(const BenchConfig & oConfig, const int iGroupCount, const int iValueSize, const int iBatchCount,
+        const string & sLogPath)
+{
+    LoopbackHub oHub(oConfig.iLatencyUs, oConfig.iJitterUs, oConfig.iLossPerTenThousand);
+    oHub.start();
+
+    int ret = 0;
+    {
+        LoopbackCluster oCluster(&oHub);
+        ret = oCluster.Run(oConfig.iReplicaCount, iGroupCount, iBatchCount, sLogPath);
+        if (ret == 0)
+        {
+            Node * poNode = oCluster.GetProposeNode();
+
+            //first propose of each group runs prepare, keep it out of the result.
+            for (int iGroupIdx = 0; iGroupIdx < iGroupCount; iGroupIdx++)
+            {
+                uint64_t llInstanceID = 0;
+                poNode->Propose(iGroupIdx, "start bench", llInstanceID);
+            }
+
+            uint64_t llBeginUs = GetSteadyClockUS();
+
+            vector<LoopbackBenchClient *> vecClient;
+            for (int i = 0; i < oConfig.iConcurrentCount; i++)
+            {
+                LoopbackBenchClient * poClient = new LoopbackBenchClient(poNode, iGroupCount, iBatchCount > 0,
+                        oConfig.iWriteCount, iValueSize);
+                poClient->start();
+                vecClient.push_back(poClient);
+            }
+
+            vector<uint64_t> vecLatencyUs;
+            int iFailCount = 0;
+            for (auto & poClient : vecClient)
+            {
+                poClient->join();
+                vecLatencyUs.insert(end(vecLatencyUs), begin(poClient->GetLatencyUs()), end(poClient->GetLatencyUs()));
+                iFailCount += poClient->GetFailCount();
+            }
+
+            uint64_t llRunTimeUs = GetSteadyClockUS() - llBeginUs;
+
+            for (auto & poClient : vecClient)
+            {
+                delete poClient;
+            }
+
+            sort(begin(vecLatencyUs), end(vecLatencyUs));
+            uint64_t llQPS = llRunTimeUs > 0 ? (uint64_t)vecLatencyUs.size() * 1000000 / llRunTimeUs : 0;
+
+            printf("replicas %d groups %d value_size %d batch %d | qps %lu p50 %luus p99 %luus p999 %luus fail %d\n",
+                    oConfig.iReplicaCount, iGroupCount, iValueSize, iBatchCount, llQPS,
+                    Percentile(vecLatencyUs, 0.5), Percentile(vecLatencyUs, 0.99), Percentile(vecLatencyUs, 0.999),
+                    iFailCount);
+        }
+    }
+
+    oHub.Stop();
+
+    return ret;
+}
+
+void Usage(const char * pcProgram)
+{
+    printf("%s [-r replicas] [-g groupcount,...] [-s valuesize,...] [-b batchcount,...] "
+            "[-c concurrent] [-n writes per client] [-l latency us] [-j jitter us] [-p loss per ten thousand]\n", pcProgram);
+    printf("batchcount 0 means propose without batch.\n");
+}
+
+int main(int argc, char ** argv)
+{
+    BenchConfig oConfig;
+    oConfig.iReplicaCount = 3;
+    oConfig.vecGroupCount = {1};
+    oConfig.vecValueSize = {100};
+    oConfig.vecBatchCount = {0};
+    oConfig.iConcurrentCount = 32;
+    oConfig.iWriteCount = 1000;
+    oConfig.iLatencyUs = 0;
+    oConfig.iJitterUs = 0;
+    oConfig.iLossPerTenThousand = 0;
+
+    int iOpt = 0;
+    while ((iOpt = getopt(argc, argv, "r:g:s:b:c:n:l:j:p:h")) != -1)
+    {
+        int ret = 0;
+        switch (iOpt)
+        {
+            case 'r': oConfig.iReplicaCount = atoi(optarg); break;
+            case 'g': ret = parse_int_list(optarg, oConfig.vecGroupCount); break;
+            case 's': ret = parse_int_list(optarg, oConfig.vecValueSize); break;
+            case 'b': ret = parse_int_list(optarg, oConfig.vecBatchCount); break;
+            case 'c': oConfig.iConcurrentCount = atoi(optarg); break;
+            case 'n': oConfig.iWriteCount = atoi(optarg); break;
+            case 'l': oConfig.iLatencyUs = atoi(optarg); break;
+            case 'j': oConfig.iJitterUs = atoi(optarg); break;
+            case 'p': oConfig.iLossPerTenThousand = atoi(optarg); break;
+            default: Usage(argv[0]); return -1;
+        }
+
+        if (ret != 0)
+        {
+            Usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (oConfig.iReplicaCount < 1 || oConfig.iConcurrentCount < 1 || oConfig.iWriteCount < 1)
+    {
+        Usage(argv[0]);
+        return -1;
+    }
+
+    char sLogPath[128] = {0};
+    snprintf(sLogPath, sizeof(sLogPath), "./loopback_logpath_%d", (int)getpid());
+    if (mkdir(sLogPath, S_IRWXU) == -1)
+    {
+        printf("create dir fail, path %s\n", sLogPath);
+        return -1;
+    }
+
+    int iRunIdx = 0;
+    int ret = 0;
+    for (int iGroupCount : oConfig.vecGroupCount)
+    {
+        for (int iValueSize : oConfig.vecValueSize)
+        {
+            for (int iBatchCount : oConfig.vecBatchCount)
+            {
+                //fresh replicas for every run, no state left by the previous one.
+                string sRunLogPath = string(sLogPath) + "/run_" + to_string(iRunIdx++);
+                if (mkdir(sRunLogPath.c_str(), S_IRWXU) == -1)
+                {
+                    printf("create dir fail, path %s\n", sRunLogPath.c_str());
+                    ret = -1;
+                    break;
+                }
+
+                ret = BenchOne(oConfig, iGroupCount, iValueSize, iBatchCount, sRunLogPath);
+                FileUtils::DeleteDir(sRunLogPath);
+                if (ret != 0)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    FileUtils::DeleteDir(sLogPath);
+
+    return ret;
+}
+
@@ -0,0 +1,221 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "loopback_network.h"
+#include <chrono>
+
+using namespace phxpaxos;
+using namespace std;
+
+namespace bench
+{
+
+static uint64_t GetSteadyClockUS()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+LoopbackHub :: LoopbackHub(const int iLatencyUs, const int iJitterUs, const int iLossPerTenThousand)
+    : m_iLatencyUs(iLatencyUs), m_iJitterUs(iJitterUs), m_iLossPerTenThousand(iLossPerTenThousand),
+    m_oRand(std::random_device()()), m_llSeq(0), m_bIsEnd(false)
+{
+}
+
+LoopbackHub :: ~LoopbackHub()
+{
+}
+
+void LoopbackHub :: Stop()
+{
+    {
+        std::lock_guard<std::mutex> oLock(m_oQueueMutex);
+        m_bIsEnd = true;
+    }
+    m_oQueueCond.notify_all();
+
+    join();
+}
+
+void LoopbackHub :: Register(const nodeid_t iNodeID, LoopbackNetWork * poNetWork)
+{
+    std::lock_guard<std::mutex> oLock(m_oNodeMutex);
+    m_mapNetWork[iNodeID] = poNetWork;
+}
+
+void LoopbackHub :: Unregister(const nodeid_t iNodeID)
+{
+    std::lock_guard<std::mutex> oLock(m_oNodeMutex);
+    m_mapNetWork.erase(iNodeID);
+}
+
+int LoopbackHub :: Send(const nodeid_t iFromNodeID, const std::string & sIp, const int iPort,
+        const SharedMessage & poMessage)
+{
+    nodeid_t iToNodeID = NodeInfo(sIp, iPort).GetNodeID();
+
+    std::lock_guard<std::mutex> oLock(m_oQueueMutex);
+    if (m_bIsEnd)
+    {
+        return -1;
+    }
+
+    if (m_iLossPerTenThousand > 0 && (int)(m_oRand() % 10000) < m_iLossPerTenThousand)
+    {
+        //dropped on the wire, sender won't know.
+        return 0;
+    }
+
+    uint64_t llDeliverTimeUs = GetSteadyClockUS() + m_iLatencyUs;
+    if (m_iJitterUs > 0)
+    {
+        llDeliverTimeUs += m_oRand() % m_iJitterUs;
+    }
+
+    uint64_t & llLinkLastDeliverTimeUs = m_mapLinkLastDeliverTimeUs[std::make_pair(iFromNodeID, iToNodeID)];
+    if (llDeliverTimeUs < llLinkLastDeliverTimeUs)
+    {
+        llDeliverTimeUs = llLinkLastDeliverTimeUs;
+    }
+    llLinkLastDeliverTimeUs = llDeliverTimeUs;
+
+    Packet oPacket;
+    oPacket.llDeliverTimeUs = llDeliverTimeUs;
+    oPacket.llSeq = m_llSeq++;
+    oPacket.iToNodeID = iToNodeID;
+    oPacket.poMessage = poMessage;
+
+    //wake up deliver thread only if this packet is due earlier than all queued.
+    bool bNeedWakeUp = m_oPacketQueue.empty() || m_oPacketQueue.top() > oPacket;
+    m_oPacketQueue.push(oPacket);
+
+    if (bNeedWakeUp)
+    {
+        m_oQueueCond.notify_one();
+    }
+
+    return 0;
+}
+
+void LoopbackHub :: run()
+{
+    vector<Packet> vecDuePacket;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> oLock(m_oQueueMutex);
+            while (!m_bIsEnd)
+            {
+                if (m_oPacketQueue.empty())
+                {
+                    m_oQueueCond.wait(oLock);
+                    continue;
+                }
+
+                uint64_t llNowUs = GetSteadyClockUS();
+                if (m_oPacketQueue.top().llDeliverTimeUs <= llNowUs)
+                {
+                    break;
+                }
+
+                m_oQueueCond.wait_for(oLock, std::chrono::microseconds(m_oPacketQueue.top().llDeliverTimeUs - llNowUs));
+            }
+
+            if (m_bIsEnd)
+            {
+                break;
+            }
+
+            uint64_t llNowUs = GetSteadyClockUS();
+            while (!m_oPacketQueue.empty() && m_oPacketQueue.top().llDeliverTimeUs <= llNowUs)
+            {
+                vecDuePacket.push_back(m_oPacketQueue.top());
+                m_oPacketQueue.pop();
+            }
+        }
+
+        //deliver out of queue lock, senders are not blocked by receivers.
+        {
+            std::lock_guard<std::mutex> oLock(m_oNodeMutex);
+            for (auto & oPacket : vecDuePacket)
+            {
+                auto it = m_mapNetWork.find(oPacket.iToNodeID);
+                if (it != end(m_mapNetWork))
+                {
+                    it->second->OnReceiveMessage(oPacket.poMessage->data(), (int)oPacket.poMessage->size());
+                }
+            }
+        }
+
+        vecDuePacket.clear();
+    }
+}
+
+////////////////////////////////////////////////////////
+
+LoopbackNetWork :: LoopbackNetWork(LoopbackHub * poHub, const NodeInfo & oMyNode)
+    : m_poHub(poHub), m_iMyNodeID(oMyNode.GetNodeID()), m_bIsRunning(false)
+{
+}
+
+LoopbackNetWork :: ~LoopbackNetWork()
+{
+    StopNetWork();
+}
+
+void LoopbackNetWork :: RunNetWork()
+{
+    m_poHub->Register(m_iMyNodeID, this);
+    m_bIsRunning = true;
+}
+
+void LoopbackNetWork :: StopNetWork()
+{
+    if (m_bIsRunning)
+    {
+        m_poHub->Unregister(m_iMyNodeID);
+        m_bIsRunning = false;
+    }
+}
+
+int LoopbackNetWork :: SendMessageTCP(const std::string & sIp, const int iPort, const std::string & sMessage)
+{
+    return m_poHub->Send(m_iMyNodeID, sIp, iPort, std::make_shared<const std::string>(sMessage));
+}
+
+int LoopbackNetWork :: SendMessageUDP(const std::string & sIp, const int iPort, const std::string & sMessage)
+{
+    return m_poHub->Send(m_iMyNodeID, sIp, iPort, std::make_shared<const std::string>(sMessage));
+}
+
+int LoopbackNetWork :: SendMessageTCP(const std::string & sIp, const int iPort, const SharedMessage & poMessage)
+{
+    return m_poHub->Send(m_iMyNodeID, sIp, iPort, poMessage);
+}
+
+int LoopbackNetWork :: SendMessageUDP(const std::string & sIp, const int iPort, const SharedMessage & poMessage)
+{
+    return m_poHub->Send(m_iMyNodeID, sIp, iPort, poMessage);
+}
+
+}
+
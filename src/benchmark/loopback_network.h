@@ -0,0 +1,119 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#pragma once
+
+#include "phxpaxos/network.h"
+#include "phxpaxos/options.h"
+#include "utils_include.h"
+#include <map>
+#include <queue>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <random>
+
+namespace bench
+{
+
+class LoopbackNetWork;
+
+//in-memory switch for all replicas in one process.
+//every message is delayed by latency plus a random jitter and may be dropped,
+//messages on the same link are still delivered in order like a tcp connection.
+class LoopbackHub : public phxpaxos::Thread
+{
+public:
+    LoopbackHub(const int iLatencyUs, const int iJitterUs, const int iLossPerTenThousand);
+    ~LoopbackHub();
+
+    void Stop();
+
+    void run();
+
+    void Register(const phxpaxos::nodeid_t iNodeID, LoopbackNetWork * poNetWork);
+
+    //after return, no message will be delivered to this node.
+    void Unregister(const phxpaxos::nodeid_t iNodeID);
+
+    int Send(const phxpaxos::nodeid_t iFromNodeID, const std::string & sIp, const int iPort,
+            const phxpaxos::SharedMessage & poMessage);
+
+private:
+    struct Packet
+    {
+        uint64_t llDeliverTimeUs;
+        uint64_t llSeq;
+        phxpaxos::nodeid_t iToNodeID;
+        phxpaxos::SharedMessage poMessage;
+
+        bool operator > (const Packet & other) const
+        {
+            if (llDeliverTimeUs == other.llDeliverTimeUs)
+            {
+                return llSeq > other.llSeq;
+            }
+
+            return llDeliverTimeUs > other.llDeliverTimeUs;
+        }
+    };
+
+    int m_iLatencyUs;
+    int m_iJitterUs;
+    int m_iLossPerTenThousand;
+
+    std::mutex m_oQueueMutex;
+    std::condition_variable m_oQueueCond;
+    std::priority_queue<Packet, std::vector<Packet>, std::greater<Packet> > m_oPacketQueue;
+    std::map<std::pair<phxpaxos::nodeid_t, phxpaxos::nodeid_t>, uint64_t> m_mapLinkLastDeliverTimeUs;
+    std::mt19937 m_oRand;
+    uint64_t m_llSeq;
+    bool m_bIsEnd;
+
+    std::mutex m_oNodeMutex;
+    std::map<phxpaxos::nodeid_t, LoopbackNetWork *> m_mapNetWork;
+};
+
+class LoopbackNetWork : public phxpaxos::NetWork
+{
+public:
+    LoopbackNetWork(LoopbackHub * poHub, const phxpaxos::NodeInfo & oMyNode);
+    ~LoopbackNetWork();
+
+    void RunNetWork();
+
+    void StopNetWork();
+
+    int SendMessageTCP(const std::string & sIp, const int iPort, const std::string & sMessage);
+
+    int SendMessageUDP(const std::string & sIp, const int iPort, const std::string & sMessage);
+
+    int SendMessageTCP(const std::string & sIp, const int iPort, const phxpaxos::SharedMessage & poMessage);
+
+    int SendMessageUDP(const std::string & sIp, const int iPort, const phxpaxos::SharedMessage & poMessage);
+
+private:
+    LoopbackHub * m_poHub;
+    phxpaxos::nodeid_t m_iMyNodeID;
+    bool m_bIsRunning;
+};
+    
+}
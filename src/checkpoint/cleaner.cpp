@@ -25,6 +25,7 @@ See the AUTHORS file for names of contributors.
 #include "config_include.h"
 #include "cp_mgr.h"
 #include "sm_base.h"
+#include <algorithm>
 
 namespace phxpaxos
 {
@@ -38,7 +39,6 @@ Cleaner :: Cleaner(
     m_poSMFac(poSMFac), 
     m_poLogStorage(poLogStorage), 
     m_poCheckpointMgr(poCheckpointMgr),
-    m_llLastSave(0),
     m_bCanrun(false),
     m_bIsPaused(true),
     m_bIsEnd(false),
@@ -53,6 +53,12 @@ Cleaner :: ~Cleaner()
 
 void Cleaner :: Stop()
 {
+    if (IsOnScheduler())
+    {
+        StopOnScheduler();
+        return;
+    }
+
     m_bIsEnd = true;
     if (m_bIsStart)
     {
@@ -60,9 +66,21 @@ void Cleaner :: Stop()
     }
 }
 
+void Cleaner :: Start(JobScheduler * poScheduler)
+{
+    if (poScheduler != nullptr && StartOnScheduler(poScheduler) == 0)
+    {
+        Continue();
+        return;
+    }
+
+    start();
+}
+
 void Cleaner :: Pause()
 {
     m_bCanrun = false;
+    NotifyScheduler();
 }
 
 void Cleaner :: Continue()
@@ -81,70 +99,90 @@ void Cleaner :: run()
     m_bIsStart = true;
     Continue();
 
-    //control delete speed to avoid affecting the io too much.
-    int iDeleteQps = Cleaner_DELETE_QPS;
-    int iSleepMs = iDeleteQps > 1000 ? 1 : 1000 / iDeleteQps;
-    int iDeleteInterval = iDeleteQps > 1000 ? iDeleteQps / 1000 + 1 : 1; 
-
-    PLGDebug("DeleteQps %d SleepMs %d DeleteInterval %d",
-            iDeleteQps, iSleepMs, iDeleteInterval);
-
-    while (true)
+    while (!m_bIsEnd)
     {
-        if (m_bIsEnd)
+        int iSleepMs = RunSlice();
+        if (m_bIsPaused)
         {
-            PLGHead("Checkpoint.Cleaner [END]");
-            return;
+            Time::MsSleep(iSleepMs);
         }
-        
-        if (!m_bCanrun)
+        else
         {
-            PLGImp("Pausing, sleep");
-            m_bIsPaused = true;
-            Time::MsSleep(1000);
-            continue;
+            SleepUnlessPause(iSleepMs);
         }
+    }
 
-        uint64_t llInstanceID = m_poCheckpointMgr->GetMinChosenInstanceID();
-        uint64_t llCPInstanceID = m_poSMFac->GetCheckpointInstanceID(m_poConfig->GetMyGroupIdx()) + 1;
-        uint64_t llMaxChosenInstanceID = m_poCheckpointMgr->GetMaxChosenInstanceID();
+    PLGHead("Checkpoint.Cleaner [END]");
+}
 
-        int iDeleteCount = 0;
-        while ((llInstanceID + m_llHoldCount < llCPInstanceID)
-                && (llInstanceID + m_llHoldCount < llMaxChosenInstanceID))
-        {
-            bool bDeleteRet = DeleteOne(llInstanceID);
-            if (bDeleteRet)
-            {
-                //PLGImp("delete one done, instanceid %lu", llInstanceID);
-                llInstanceID++;
-                iDeleteCount++;
-                if (iDeleteCount >= iDeleteInterval)
-                {
-                    iDeleteCount = 0;
-                    Time::MsSleep(iSleepMs);
-                }
-            }
-            else
-            {
-                PLGDebug("delete system fail, instanceid %lu", llInstanceID);
-                break;
-            }
-        }
+int Cleaner :: RunSlice()
+{
+    if (!m_bCanrun)
+    {
+        PLGImp("Pausing, sleep");
+        m_bIsPaused = true;
+        return 1000;
+    }
 
-        if (llCPInstanceID == 0)
+    //control delete speed to avoid affecting the io too much.
+    int iDeleteQps = Cleaner_DELETE_QPS;
+
+    uint64_t llInstanceID = m_poCheckpointMgr->GetMinChosenInstanceID();
+    uint64_t llCPInstanceID = m_poSMFac->GetCheckpointInstanceID(m_poConfig->GetMyGroupIdx()) + 1;
+    uint64_t llMaxChosenInstanceID = m_poCheckpointMgr->GetMaxChosenInstanceID();
+
+    if ((llInstanceID + m_llHoldCount < llCPInstanceID)
+            && (llInstanceID + m_llHoldCount < llMaxChosenInstanceID))
+    {
+        uint64_t llEndInstanceID = std::min(llCPInstanceID, llMaxChosenInstanceID) - m_llHoldCount;
+        llEndInstanceID = std::min(llEndInstanceID, llInstanceID + DELETE_SAVE_INTERVAL);
+
+        bool bDeleteRet = DeleteRange(llInstanceID, llEndInstanceID);
+        if (bDeleteRet)
         {
-            PLGStatus("sleep a while, max deleted instanceid %lu checkpoint instanceid (no checkpoint) now instanceid %lu",
-                    llInstanceID, m_poCheckpointMgr->GetMaxChosenInstanceID());
+            int iDeleteCount = (int)(llEndInstanceID - llInstanceID);
+            return (int)((uint64_t)iDeleteCount * 1000 / iDeleteQps);
         }
-        else
+
+        PLGDebug("delete system fail, instanceid %lu", llInstanceID);
+        return GetIdleSleepMs();
+    }
+
+    if (llCPInstanceID == 0)
+    {
+        PLGStatus("sleep a while, max deleted instanceid %lu checkpoint instanceid (no checkpoint) now instanceid %lu",
+                llInstanceID, m_poCheckpointMgr->GetMaxChosenInstanceID());
+    }
+    else
+    {
+        PLGStatus("sleep a while, max deleted instanceid %lu checkpoint instanceid %lu now instanceid %lu",
+                llInstanceID, llCPInstanceID, m_poCheckpointMgr->GetMaxChosenInstanceID());
+    }
+
+    return GetIdleSleepMs();
+}
+
+const int Cleaner :: GetIdleSleepMs() const
+{
+    return OtherUtils::FastRand() % 500 + 500;
+}
+
+bool Cleaner :: SleepUnlessPause(const int iSleepMs)
+{
+    int iLeftMs = iSleepMs;
+    while (iLeftMs > 0)
+    {
+        if (m_bIsEnd || !m_bCanrun)
         {
-            PLGStatus("sleep a while, max deleted instanceid %lu checkpoint instanceid %lu now instanceid %lu",
-                    llInstanceID, llCPInstanceID, m_poCheckpointMgr->GetMaxChosenInstanceID());
+            return false;
         }
 
-        Time::MsSleep(OtherUtils::FastRand() % 500 + 500);
+        int iSliceMs = std::min(iLeftMs, CLEANER_SLEEP_SLICE_MS);
+        Time::MsSleep(iSliceMs);
+        iLeftMs -= iSliceMs;
     }
+
+    return !m_bIsEnd && m_bCanrun;
 }
 
 int Cleaner :: FixMinChosenInstanceID(const uint64_t llOldMinChosenInstanceID)
@@ -195,37 +233,35 @@ int Cleaner :: FixMinChosenInstanceID(const uint64_t llOldMinChosenInstanceID)
     return 0;
 }
 
-bool Cleaner :: DeleteOne(const uint64_t llInstanceID)
+bool Cleaner :: DeleteRange(const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID)
 {
     WriteOptions oWriteOptions;
     oWriteOptions.bSync = false;
 
-    int ret = m_poLogStorage->Del(oWriteOptions, m_poConfig->GetMyGroupIdx(), llInstanceID);
+    int ret = 0;
+    {
+        //a range is many deletes, other jobs of the scheduler run meanwhile.
+        SchedulerBlockingGuard oBlockingGuard;
+        ret = m_poLogStorage->DelRange(oWriteOptions, m_poConfig->GetMyGroupIdx(), llBeginInstanceID, llEndInstanceID);
+    }
+
     if (ret != 0)
     {
         return false;
     }
 
-    // ɾĿ϶Ѿ chosen  instance Сŵֵ
-    m_poCheckpointMgr->SetMinChosenInstanceIDCache(llInstanceID);
-
-    // ĿǰѾ chosen С instance ID д뵽 paxos log УΪҪ + 1̫
-    // дϸͬģԿֱܴһֹдƵ
-    if (llInstanceID >= m_llLastSave + DELETE_SAVE_INTERVAL)
+    //save once per range, range is no more than DELETE_SAVE_INTERVAL,
+    //so FixMinChosenInstanceID can fix it if crash before save.
+    ret = m_poCheckpointMgr->SetMinChosenInstanceID(llEndInstanceID);
+    if (ret != 0)
     {
-        int ret = m_poCheckpointMgr->SetMinChosenInstanceID(llInstanceID + 1);
-        if (ret != 0)
-        {
-            PLGErr("SetMinChosenInstanceID fail, now delete instanceid %lu", llInstanceID);
-            return false;
-        }
-
-        m_llLastSave = llInstanceID;
-
-        PLGImp("delete %d instance done, now minchosen instanceid %lu", 
-                DELETE_SAVE_INTERVAL, llInstanceID + 1);
+        PLGErr("SetMinChosenInstanceID fail, now delete instanceid [%lu, %lu)", llBeginInstanceID, llEndInstanceID);
+        return false;
     }
 
+    PLGImp("delete %lu instance done, now minchosen instanceid %lu", 
+            llEndInstanceID - llBeginInstanceID, llEndInstanceID);
+
     return true;
 }
 
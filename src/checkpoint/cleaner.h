@@ -23,19 +23,24 @@ See the AUTHORS file for names of contributors.
 
 #include <typeinfo>
 #include "utils_include.h"
+#include "job_scheduler.h"
 
 namespace phxpaxos
 {
 
 #define CAN_DELETE_DELTA 1000000 
-#define DELETE_SAVE_INTERVAL 100
+//instances deleted in one range, min chosen instanceid is saved once per range,
+//FixMinChosenInstanceID scan this many instances after a crash in the middle.
+#define DELETE_SAVE_INTERVAL 10000
+//long sleeps are cut into slices, so pause and stop don't wait for them.
+#define CLEANER_SLEEP_SLICE_MS 100
 
 class Config;
 class SMFac;
 class LogStorage;
 class CheckpointMgr;
 
-class Cleaner : public Thread
+class Cleaner : public Thread, public ScheduledJob
 {
 public:
     Cleaner(
@@ -48,8 +53,14 @@ public:
 
     void Stop();
 
+    //run on scheduler if it is not null, otherwise on its own thread.
+    void Start(JobScheduler * poScheduler);
+
     void run();
 
+    //delete one range of old instances, return ms to wait before next call.
+    int RunSlice();
+
     void Pause();
 
     void Continue();
@@ -62,7 +73,13 @@ public:
     int FixMinChosenInstanceID(const uint64_t llOldMinChosenInstanceID);
 
 private:
-    bool DeleteOne(const uint64_t llInstanceID);
+    bool DeleteRange(const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID);
+
+    //return false if woken up by pause or stop.
+    bool SleepUnlessPause(const int iSleepMs);
+
+    //random wait between cleans with nothing to delete.
+    const int GetIdleSleepMs() const;
 
 private:
     Config * m_poConfig;
@@ -70,8 +87,6 @@ private:
     LogStorage * m_poLogStorage;
     CheckpointMgr * m_poCheckpointMgr;
 
-    uint64_t m_llLastSave;
-
     bool m_bCanrun;
     bool m_bIsPaused;
 
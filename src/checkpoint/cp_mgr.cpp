@@ -32,7 +32,8 @@ CheckpointMgr :: CheckpointMgr(
         Config * poConfig,
         SMFac * poSMFac, 
         LogStorage * poLogStorage,
-        const bool bUseCheckpointReplayer) 
+        const bool bUseCheckpointReplayer,
+        const bool bReplayInApplier) 
     : m_poConfig(poConfig),
     m_poLogStorage(poLogStorage),
     m_poSMFac(poSMFac),
@@ -41,7 +42,8 @@ CheckpointMgr :: CheckpointMgr(
     m_llMinChosenInstanceID(0),
     m_llMaxChosenInstanceID(0),
     m_bInAskforCheckpointMode(false),
-    m_bUseCheckpointReplayer(bUseCheckpointReplayer)
+    m_bUseCheckpointReplayer(bUseCheckpointReplayer),
+    m_bReplayInApplier(bReplayInApplier)
 {
     m_llLastAskforCheckpointTime = 0;
 }
@@ -67,20 +69,23 @@ int CheckpointMgr :: Init()
     return 0;
 }
 
-void CheckpointMgr :: Start()
+void CheckpointMgr :: Start(JobScheduler * poScheduler)
 {
-    if (m_bUseCheckpointReplayer)
+    if (m_bUseCheckpointReplayer && !m_bReplayInApplier)
     {
         // ͨ checkpoint طš
-        m_oReplayer.start();
+        if (poScheduler == nullptr || m_oReplayer.StartOnScheduler(poScheduler) != 0)
+        {
+            m_oReplayer.start();
+        }
     }
     // ߳Ǳؿ
-    m_oCleaner.start();
+    m_oCleaner.Start(poScheduler);
 }
 
 void CheckpointMgr :: Stop()
 {
-    if (m_bUseCheckpointReplayer)
+    if (m_bUseCheckpointReplayer && !m_bReplayInApplier)
     {
         m_oReplayer.Stop();
     }
@@ -92,6 +97,11 @@ Replayer * CheckpointMgr :: GetReplayer()
     return &m_oReplayer;
 }
 
+const bool CheckpointMgr :: IsReplayInApplier() const
+{
+    return m_bUseCheckpointReplayer && m_bReplayInApplier;
+}
+
 Cleaner * CheckpointMgr :: GetCleaner()
 {
     return &m_oCleaner;
@@ -36,18 +36,22 @@ public:
             Config * poConfig,
             SMFac * poSMFac, 
             LogStorage * poLogStorage,
-            const bool bUseCheckpointReplayer);
+            const bool bUseCheckpointReplayer,
+            const bool bReplayInApplier = false);
 
     ~CheckpointMgr();
 
     int Init();
 
-    void Start();
+    void Start(JobScheduler * poScheduler = nullptr);
 
     void Stop();
 
     Replayer * GetReplayer();
 
+    //replayer is driven by apply thread instead of its own thread.
+    const bool IsReplayInApplier() const;
+
     Cleaner * GetCleaner();
 
 public:
@@ -87,6 +91,7 @@ private:
     uint64_t m_llLastAskforCheckpointTime;
 
     bool m_bUseCheckpointReplayer;
+    bool m_bReplayInApplier;
 };
 
 }
@@ -38,6 +38,7 @@ Replayer :: Replayer(
     m_poSMFac(poSMFac), 
     m_oPaxosLog(poLogStorage), 
     m_poCheckpointMgr(poCheckpointMgr),
+    m_llInstanceID((uint64_t)-1),
     m_bCanrun(false),
     m_bIsPaused(true),
     m_bIsEnd(false)
@@ -50,6 +51,12 @@ Replayer :: ~Replayer()
 
 void Replayer :: Stop()
 {
+    if (IsOnScheduler())
+    {
+        StopOnScheduler();
+        return;
+    }
+
     m_bIsEnd = true;
     join();
 }
@@ -73,7 +80,6 @@ const bool Replayer:: IsPaused() const
 void Replayer :: run()
 {
     PLGHead("Checkpoint.Replayer [START]");
-    uint64_t llInstanceID = m_poSMFac->GetCheckpointInstanceID(m_poConfig->GetMyGroupIdx()) + 1;
 
     while (true)
     {
@@ -82,37 +88,89 @@ void Replayer :: run()
             PLGHead("Checkpoint.Replayer [END]");
             return;
         }
-        
-        if (!m_bCanrun)
-        {
-            //PLGImp("Pausing, sleep");
-            m_bIsPaused = true;
-            Time::MsSleep(1000);
-            continue;
-        }
-        
-        if (llInstanceID >= m_poCheckpointMgr->GetMaxChosenInstanceID())
-        {
-            //PLGImp("now maxchosen instanceid %lu small than excute instanceid %lu, wait", 
-                    //m_poCheckpointMgr->GetMaxChosenInstanceID(), llInstanceID);
-            Time::MsSleep(1000);
-            continue;
-        }
-        
-        bool bPlayRet = PlayOne(llInstanceID);
-        if (bPlayRet)
-        {
-            PLGImp("Play one done, instanceid %lu", llInstanceID);
-            llInstanceID++;
-        }
-        else
+
+        int iWaitMs = PlayStep();
+        if (iWaitMs > 0)
         {
-            PLGErr("Play one fail, instanceid %lu", llInstanceID);
-            Time::MsSleep(500);
+            Time::MsSleep(iWaitMs);
         }
     }
 }
 
+int Replayer :: RunSlice()
+{
+    return PlayStep();
+}
+
+void Replayer :: InitInstanceID()
+{
+    if (m_llInstanceID == (uint64_t)-1)
+    {
+        m_llInstanceID = m_poSMFac->GetCheckpointInstanceID(m_poConfig->GetMyGroupIdx()) + 1;
+    }
+}
+
+int Replayer :: PlayStep()
+{
+    InitInstanceID();
+
+    if (!m_bCanrun)
+    {
+        //PLGImp("Pausing, sleep");
+        m_bIsPaused = true;
+        return 1000;
+    }
+
+    if (m_llInstanceID >= m_poCheckpointMgr->GetMaxChosenInstanceID())
+    {
+        //PLGImp("now maxchosen instanceid %lu small than excute instanceid %lu, wait", 
+                //m_poCheckpointMgr->GetMaxChosenInstanceID(), m_llInstanceID);
+        return 1000;
+    }
+
+    bool bPlayRet = PlayOne(m_llInstanceID);
+    if (bPlayRet)
+    {
+        PLGImp("Play one done, instanceid %lu", m_llInstanceID);
+        m_llInstanceID++;
+        return 0;
+    }
+
+    PLGErr("Play one fail, instanceid %lu", m_llInstanceID);
+    return 500;
+}
+
+void Replayer :: OnApplied(const uint64_t llInstanceID, const std::string & sValue)
+{
+    InitInstanceID();
+
+    if (!m_bCanrun)
+    {
+        m_bIsPaused = true;
+        return;
+    }
+
+    //instances missed while paused are read from log first.
+    while (m_llInstanceID < llInstanceID && PlayOne(m_llInstanceID))
+    {
+        m_llInstanceID++;
+    }
+
+    if (m_llInstanceID != llInstanceID)
+    {
+        return;
+    }
+
+    SchedulerBlockingGuard oBlockingGuard;
+    if (!m_poSMFac->ExecuteForCheckpoint(m_poConfig->GetMyGroupIdx(), llInstanceID, sValue))
+    {
+        PLGErr("Checkpoint sm excute fail, instanceid %lu", llInstanceID);
+        return;
+    }
+
+    m_llInstanceID++;
+}
+
 bool Replayer :: PlayOne(const uint64_t llInstanceID)
 {
     AcceptorStateData oState; 
@@ -122,6 +180,8 @@ bool Replayer :: PlayOne(const uint64_t llInstanceID)
         return false;
     }
 
+    //checkpoint state machine may be slow, other jobs of the scheduler run meanwhile.
+    SchedulerBlockingGuard oBlockingGuard;
     bool bExecuteRet = m_poSMFac->ExecuteForCheckpoint(
             m_poConfig->GetMyGroupIdx(), llInstanceID, oState.acceptedvalue());
     if (!bExecuteRet)
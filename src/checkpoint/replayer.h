@@ -23,6 +23,7 @@ See the AUTHORS file for names of contributors.
 
 #include "utils_include.h"
 #include "paxos_log.h"
+#include "job_scheduler.h"
 
 namespace phxpaxos
 {
@@ -32,7 +33,7 @@ class SMFac;
 class LogStorage;
 class CheckpointMgr;
     
-class Replayer : public Thread
+class Replayer : public Thread, public ScheduledJob
 {
 public:
     Replayer(
@@ -47,6 +48,15 @@ public:
 
     void run();
 
+    //play chosen instances from log, return ms to wait before next call.
+    int PlayStep();
+
+    int RunSlice();
+
+    //with applier, replay run in apply thread right after each execute,
+    //the applied value is played without reading log again.
+    void OnApplied(const uint64_t llInstanceID, const std::string & sValue);
+
     void Pause();
 
     void Continue();
@@ -56,12 +66,17 @@ public:
 private:
     bool PlayOne(const uint64_t llInstanceID);
 
+    void InitInstanceID();
+
 private:
     Config * m_poConfig;
     SMFac * m_poSMFac;
     PaxosLog m_oPaxosLog;
     CheckpointMgr * m_poCheckpointMgr;
 
+    //next instance to play.
+    uint64_t m_llInstanceID;
+
     bool m_bCanrun;
     bool m_bIsPaused;
     bool m_bIsEnd;
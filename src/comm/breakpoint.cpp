@@ -100,6 +100,11 @@ MasterBP * Breakpoint :: GetMasterBP()
 {
     return &m_oMasterBP;
 }
+
+LatencyBP * Breakpoint :: GetLatencyBP()
+{
+    return &m_oLatencyBP;
+}
     
 }
 
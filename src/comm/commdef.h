@@ -67,6 +67,9 @@ namespace phxpaxos
 //max queue memsize
 #define MAX_QUEUE_MEM_SIZE 209715200
 
+//master lease left less than this is uncertain for local read.
+#define MASTER_LEASE_READ_MARGIN_MS 100
+
 enum MsgCmd
 {
     MsgCmd_PaxosMsg = 1,
@@ -88,6 +91,7 @@ enum PaxosMsgType
     MsgType_PaxosLearner_SendLearnValue_Ack = 11,
     MsgType_PaxosLearner_AskforCheckpoint = 12,
     MsgType_PaxosLearner_OnAskforCheckpoint = 13,
+    MsgType_PaxosLearner_SendLearnValueBatch = 14,
 };
 
 enum PaxosMsgFlagType
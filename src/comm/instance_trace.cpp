@@ -0,0 +1,297 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "instance_trace.h"
+#include "utils_include.h"
+#include "commdef.h"
+#include <stdio.h>
+
+namespace phxpaxos
+{
+
+struct TraceEventInfo
+{
+    const char * pcName;
+    const char * pcCategory;
+    const char * pcArgName;
+};
+
+static const TraceEventInfo s_arrTraceEventInfo[TraceEvent_Max] =
+{
+    {"NewValue", "instance", "valuesize"},
+    {"Commit", "instance", nullptr},
+    {"SMExecute", "instance", nullptr},
+    {"Prepare", "proposer", "proposalid"},
+    {"PreparePass", "proposer", "proposalid"},
+    {"PrepareNotPass", "proposer", "proposalid"},
+    {"PrepareTimeout", "proposer", nullptr},
+    {"Accept", "proposer", "proposalid"},
+    {"AcceptPass", "proposer", "proposalid"},
+    {"AcceptNotPass", "proposer", "proposalid"},
+    {"AcceptTimeout", "proposer", nullptr},
+    {"OnPrepare", "acceptor", "fromnodeid"},
+    {"OnAccept", "acceptor", "fromnodeid"},
+    {"Persist", "acceptor", nullptr},
+    {"AskforLearn", "learner", nullptr},
+    {"LearnFromProposer", "learner", "fromnodeid"},
+    {"LearnFromOther", "learner", "fromnodeid"},
+};
+
+InstanceTrace :: InstanceTrace(const int iGroupIdx)
+    : m_iGroupIdx(iGroupIdx), m_pSlots(nullptr), m_llRingMask(0), m_llWritePos(0)
+{
+}
+
+InstanceTrace :: ~InstanceTrace()
+{
+    delete [] m_pSlots;
+}
+
+void InstanceTrace :: Open(const int iRingSize)
+{
+    if (iRingSize <= 0 || m_pSlots != nullptr)
+    {
+        return;
+    }
+
+    uint64_t llRingSize = 1;
+    while (llRingSize < (uint64_t)iRingSize)
+    {
+        llRingSize <<= 1;
+    }
+
+    TraceSlot * pSlots = new TraceSlot[llRingSize];
+    for (uint64_t i = 0; i < llRingSize; i++)
+    {
+        pSlots[i].llSeq.store(0, std::memory_order_relaxed);
+    }
+
+    m_llRingMask = llRingSize - 1;
+    m_llWritePos.store(0, std::memory_order_relaxed);
+    m_pSlots = pSlots;
+}
+
+void InstanceTrace :: Record(const int iEvent, const uint64_t llInstanceID, const uint64_t llArg, const uint64_t llDurationUs)
+{
+    uint64_t llPos = m_llWritePos.fetch_add(1, std::memory_order_relaxed);
+    TraceSlot & oSlot = m_pSlots[llPos & m_llRingMask];
+
+    oSlot.llSeq.store(2 * llPos + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    oSlot.llTimeUs.store(Time::GetSteadyClockUS(), std::memory_order_relaxed);
+    oSlot.llInstanceID.store(llInstanceID, std::memory_order_relaxed);
+    oSlot.llArg.store(llArg, std::memory_order_relaxed);
+    oSlot.llDurationUs.store(llDurationUs, std::memory_order_relaxed);
+    oSlot.iEvent.store(iEvent, std::memory_order_relaxed);
+
+    oSlot.llSeq.store(2 * llPos + 2, std::memory_order_release);
+}
+
+void InstanceTrace :: Dump(std::string & sJson, const uint64_t llSinceTimeUs) const
+{
+    sJson = "{\"traceEvents\":[";
+
+    if (m_pSlots != nullptr)
+    {
+        uint64_t llEndPos = m_llWritePos.load(std::memory_order_acquire);
+        uint64_t llBeginPos = llEndPos > m_llRingMask + 1 ? llEndPos - m_llRingMask - 1 : 0;
+
+        bool bIsFirst = true;
+        char sBuf[512] = {0};
+        for (uint64_t llPos = llBeginPos; llPos < llEndPos; llPos++)
+        {
+            const TraceSlot & oSlot = m_pSlots[llPos & m_llRingMask];
+
+            uint64_t llSeq = oSlot.llSeq.load(std::memory_order_acquire);
+            if (llSeq != 2 * llPos + 2)
+            {
+                //still writing or already overwritten.
+                continue;
+            }
+
+            uint64_t llTimeUs = oSlot.llTimeUs.load(std::memory_order_relaxed);
+            uint64_t llInstanceID = oSlot.llInstanceID.load(std::memory_order_relaxed);
+            uint64_t llArg = oSlot.llArg.load(std::memory_order_relaxed);
+            uint64_t llDurationUs = oSlot.llDurationUs.load(std::memory_order_relaxed);
+            int iEvent = oSlot.iEvent.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (oSlot.llSeq.load(std::memory_order_relaxed) != llSeq)
+            {
+                continue;
+            }
+
+            if (llTimeUs < llSinceTimeUs || iEvent < 0 || iEvent >= TraceEvent_Max)
+            {
+                continue;
+            }
+
+            const TraceEventInfo & oInfo = s_arrTraceEventInfo[iEvent];
+
+            int iLen = 0;
+            if (llDurationUs > 0)
+            {
+                //complete event, begin at ts and last dur.
+                iLen = snprintf(sBuf, sizeof(sBuf),
+                        "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%" PRIu64 ",\"dur\":%" PRIu64
+                        ",\"pid\":%d,\"tid\":%" PRIu64 ",\"args\":{\"instanceid\":%" PRIu64,
+                        bIsFirst ? "" : ",", oInfo.pcName, oInfo.pcCategory,
+                        llTimeUs > llDurationUs ? llTimeUs - llDurationUs : 0, llDurationUs,
+                        m_iGroupIdx, llInstanceID, llInstanceID);
+            }
+            else
+            {
+                iLen = snprintf(sBuf, sizeof(sBuf),
+                        "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%" PRIu64
+                        ",\"pid\":%d,\"tid\":%" PRIu64 ",\"args\":{\"instanceid\":%" PRIu64,
+                        bIsFirst ? "" : ",", oInfo.pcName, oInfo.pcCategory, llTimeUs,
+                        m_iGroupIdx, llInstanceID, llInstanceID);
+            }
+            sJson.append(sBuf, iLen);
+
+            if (oInfo.pcArgName != nullptr)
+            {
+                iLen = snprintf(sBuf, sizeof(sBuf), ",\"%s\":%" PRIu64, oInfo.pcArgName, llArg);
+                sJson.append(sBuf, iLen);
+            }
+            sJson.append("}}");
+
+            bIsFirst = false;
+        }
+    }
+
+    sJson.append("],\"displayTimeUnit\":\"ms\"}");
+}
+
+////////////////////////////////////////////////////////////////////
+
+InstanceTraceDumper * InstanceTraceDumper :: Instance()
+{
+    static InstanceTraceDumper oInstanceTraceDumper;
+    return &oInstanceTraceDumper;
+}
+
+InstanceTraceDumper :: InstanceTraceDumper()
+    : m_bIsStarted(false), m_bIsEnd(false)
+{
+}
+
+InstanceTraceDumper :: ~InstanceTraceDumper()
+{
+    if (!m_bIsStarted)
+    {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> oLock(m_oMutex);
+        m_bIsEnd = true;
+        m_oCond.notify_one();
+    }
+
+    join();
+}
+
+void InstanceTraceDumper :: Dump(const int iGroupIdx, const std::string & sDumpPath, 
+        const uint64_t llInstanceID, const int iUseTimeMs, std::string & sJson)
+{
+    char sFilePath[512] = {0};
+    snprintf(sFilePath, sizeof(sFilePath), "%s/trace_g%d_i%" PRIu64 "_%" PRIu64 ".json", sDumpPath.c_str(),
+            iGroupIdx, llInstanceID, Time::GetTimestampMS());
+
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+
+    if (m_bIsEnd || m_dequeTask.size() >= INSTANCE_TRACE_DUMP_MAX_PENDING)
+    {
+        return;
+    }
+
+    if (!m_bIsStarted)
+    {
+        m_bIsStarted = true;
+        start();
+    }
+
+    m_dequeTask.push_back(DumpTask());
+    DumpTask & oTask = m_dequeTask.back();
+    oTask.iGroupIdx = iGroupIdx;
+    oTask.sFilePath = sFilePath;
+    oTask.iUseTimeMs = iUseTimeMs;
+    oTask.sJson.swap(sJson);
+
+    m_oCond.notify_one();
+}
+
+void InstanceTraceDumper :: run()
+{
+    while (true)
+    {
+        DumpTask oTask;
+
+        {
+            std::unique_lock<std::mutex> oLock(m_oMutex);
+            while (m_dequeTask.empty() && !m_bIsEnd)
+            {
+                m_oCond.wait(oLock);
+            }
+
+            if (m_dequeTask.empty())
+            {
+                break;
+            }
+
+            oTask.iGroupIdx = m_dequeTask.front().iGroupIdx;
+            oTask.sFilePath.swap(m_dequeTask.front().sFilePath);
+            oTask.iUseTimeMs = m_dequeTask.front().iUseTimeMs;
+            oTask.sJson.swap(m_dequeTask.front().sJson);
+            m_dequeTask.pop_front();
+        }
+
+        WriteFile(oTask);
+    }
+}
+
+void InstanceTraceDumper :: WriteFile(const DumpTask & oTask)
+{
+    const int m_iMyGroupIdx = oTask.iGroupIdx;
+
+    FILE * fp = fopen(oTask.sFilePath.c_str(), "w");
+    if (fp == nullptr)
+    {
+        PLG1Err("open trace file %s fail, usetime %dms", oTask.sFilePath.c_str(), oTask.iUseTimeMs);
+        return;
+    }
+
+    size_t iWriteLen = fwrite(oTask.sJson.data(), 1, oTask.sJson.size(), fp);
+    fclose(fp);
+
+    if (iWriteLen != oTask.sJson.size())
+    {
+        PLG1Err("write trace file %s fail, writelen %zu tracelen %zu", 
+                oTask.sFilePath.c_str(), iWriteLen, oTask.sJson.size());
+        return;
+    }
+
+    PLG1Imp("slow commit usetime %dms, trace dump to %s", oTask.iUseTimeMs, oTask.sFilePath.c_str());
+}
+    
+}
@@ -0,0 +1,151 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <inttypes.h>
+#include "utils_include.h"
+
+namespace phxpaxos
+{
+
+enum TraceEvent
+{
+    //instance
+    TraceEvent_NewValue = 0,        //commit start propose, arg is value size.
+    TraceEvent_Commit,              //my commit learned, duration is whole commit.
+    TraceEvent_SMExecute,           //state machine execute, duration.
+    //proposer
+    TraceEvent_Prepare,             //send prepare, arg is proposalid.
+    TraceEvent_PreparePass,         //duration from send prepare.
+    TraceEvent_PrepareNotPass,      //rejected, will retry.
+    TraceEvent_PrepareTimeout,
+    TraceEvent_Accept,              //send accept, arg is proposalid.
+    TraceEvent_AcceptPass,          //duration from send accept.
+    TraceEvent_AcceptNotPass,       //rejected, will retry by prepare.
+    TraceEvent_AcceptTimeout,
+    //acceptor
+    TraceEvent_OnPrepare,           //arg is from nodeid.
+    TraceEvent_OnAccept,            //arg is from nodeid.
+    TraceEvent_Persist,             //write acceptor state, duration.
+    //learner
+    TraceEvent_AskforLearn,
+    TraceEvent_LearnFromProposer,   //arg is from nodeid.
+    TraceEvent_LearnFromOther,      //learn value sent by learner sender, arg is from nodeid.
+
+    TraceEvent_Max,
+};
+
+//fixed size ring of trace events, each slot guarded by its own sequence, so Add never block
+//and never allocate, Dump can run in any thread and skip slots being overwritten.
+//when ring size is 0 trace is closed, Add only test a pointer.
+class InstanceTrace
+{
+public:
+    InstanceTrace(const int iGroupIdx);
+    ~InstanceTrace();
+
+    //ring size round up to power of 2, call before ioloop start.
+    void Open(const int iRingSize);
+
+    inline const bool IsOpen() const
+    {
+        return m_pSlots != nullptr;
+    }
+
+    inline void Add(const int iEvent, const uint64_t llInstanceID, const uint64_t llArg = 0, const uint64_t llDurationUs = 0)
+    {
+        if (m_pSlots != nullptr)
+        {
+            Record(iEvent, llInstanceID, llArg, llDurationUs);
+        }
+    }
+
+    //chrome trace json(chrome://tracing or perfetto), one row per instance.
+    //only events ended after llSinceTimeUs(steady clock) are dumped, 0 means all in ring.
+    void Dump(std::string & sJson, const uint64_t llSinceTimeUs = 0) const;
+
+private:
+    struct TraceSlot
+    {
+        //2 * pos + 1 while writing, 2 * pos + 2 when done.
+        std::atomic<uint64_t> llSeq;
+        std::atomic<uint64_t> llTimeUs;
+        std::atomic<uint64_t> llInstanceID;
+        std::atomic<uint64_t> llArg;
+        std::atomic<uint64_t> llDurationUs;
+        std::atomic<int> iEvent;
+    };
+
+    void Record(const int iEvent, const uint64_t llInstanceID, const uint64_t llArg, const uint64_t llDurationUs);
+
+private:
+    int m_iGroupIdx;
+    TraceSlot * m_pSlots;
+    uint64_t m_llRingMask;
+    std::atomic<uint64_t> m_llWritePos;
+};
+
+//max dumps waiting to be written, more are dropped, disk is too slow.
+#define INSTANCE_TRACE_DUMP_MAX_PENDING 16
+
+//write slow commit traces of all groups into files on one thread of the process,
+//so ioloop never wait for disk. the thread starts at the first dump.
+class InstanceTraceDumper : public Thread
+{
+public:
+    static InstanceTraceDumper * Instance();
+
+    //called by ioloop, take sJson and write it later.
+    void Dump(const int iGroupIdx, const std::string & sDumpPath, 
+            const uint64_t llInstanceID, const int iUseTimeMs, std::string & sJson);
+
+    void run();
+
+private:
+    InstanceTraceDumper();
+    ~InstanceTraceDumper();
+
+    struct DumpTask
+    {
+        int iGroupIdx;
+        std::string sFilePath;
+        int iUseTimeMs;
+        std::string sJson;
+    };
+
+    void WriteFile(const DumpTask & oTask);
+
+private:
+    std::mutex m_oMutex;
+    std::condition_variable m_oCond;
+    std::deque<DumpTask> m_dequeTask;
+
+    bool m_bIsStarted;
+    bool m_bIsEnd;
+};
+    
+}
@@ -0,0 +1,373 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "job_scheduler.h"
+#include "utils_include.h"
+#include "comm_include.h"
+
+using namespace std;
+
+namespace phxpaxos
+{
+
+//idle worker still wakes up periodically.
+#define JOB_SCHEDULER_MAX_WAIT_MS 1000
+
+//scheduler of the worker thread running now, blocking regions nest.
+static thread_local JobScheduler * t_poWorkerScheduler = nullptr;
+static thread_local int t_iBlockingDepth = 0;
+
+ScheduledJob :: ScheduledJob()
+    : m_poScheduler(nullptr), m_iJobIdx(-1), m_bIsOnScheduler(false)
+{
+}
+
+ScheduledJob :: ~ScheduledJob()
+{
+}
+
+int ScheduledJob :: StartOnScheduler(JobScheduler * poScheduler)
+{
+    m_poScheduler = poScheduler;
+    m_iJobIdx = poScheduler->AddJob(this);
+    if (m_iJobIdx == -1)
+    {
+        m_poScheduler = nullptr;
+        return -1;
+    }
+
+    m_bIsOnScheduler = true;
+    return 0;
+}
+
+void ScheduledJob :: StopOnScheduler()
+{
+    if (!m_bIsOnScheduler)
+    {
+        return;
+    }
+
+    //keep m_poScheduler, late Notify on a removed job is ignored by scheduler.
+    m_poScheduler->RemoveJob(m_iJobIdx);
+    m_bIsOnScheduler = false;
+}
+
+const bool ScheduledJob :: IsOnScheduler() const
+{
+    return m_bIsOnScheduler;
+}
+
+void ScheduledJob :: NotifyScheduler()
+{
+    if (m_poScheduler != nullptr)
+    {
+        m_poScheduler->Notify(m_iJobIdx);
+    }
+}
+
+////////////////////////////////////////////////////
+
+JobScheduler :: JobScheduler()
+    : m_bIsEnd(false), m_iThreadCount(0), m_iMaxWorkerCount(0), m_iRunningCount(0), m_iIdleCount(0)
+{
+}
+
+JobScheduler :: ~JobScheduler()
+{
+    Stop();
+
+    for (auto & poJobCtx : m_vecJobList)
+    {
+        delete poJobCtx;
+    }
+}
+
+void JobScheduler :: Start(const int iThreadCount, const int iMaxJobCount)
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+
+    m_bIsEnd = false;
+    m_vecJobList.reserve(iMaxJobCount);
+
+    //each job blocks at most one worker, so spare workers never exceed job count.
+    m_iThreadCount = iThreadCount;
+    m_iMaxWorkerCount = iThreadCount + iMaxJobCount;
+
+    for (int i = 0; i < iThreadCount; i++)
+    {
+        AddWorker();
+    }
+
+    PLImp("OK, worker count %d max job count %d", iThreadCount, iMaxJobCount);
+}
+
+void JobScheduler :: Stop()
+{
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        m_bIsEnd = true;
+    }
+    m_oCond.notify_all();
+
+    //no worker is added after end.
+    for (auto & poWorker : m_vecWorkerList)
+    {
+        poWorker->join();
+        delete poWorker;
+    }
+    m_vecWorkerList.clear();
+}
+
+const bool JobScheduler :: IsStart() const
+{
+    return !m_vecWorkerList.empty();
+}
+
+//must hold lock.
+void JobScheduler :: AddWorker()
+{
+    if (m_bIsEnd || (int)m_vecWorkerList.size() >= m_iMaxWorkerCount)
+    {
+        return;
+    }
+
+    m_vecWorkerList.push_back(new std::thread(&JobScheduler::WorkerRun, this));
+}
+
+int JobScheduler :: AddJob(ScheduledJob * poJob)
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    if (m_vecJobList.size() >= m_vecJobList.capacity())
+    {
+        PLErr("too many jobs, max %zu", m_vecJobList.capacity());
+        return -1;
+    }
+
+    JobCtx * poJobCtx = new JobCtx();
+    poJobCtx->m_poJob = poJob;
+    poJobCtx->m_iState = JobState_Idle;
+    poJobCtx->m_bRemoved = false;
+    poJobCtx->m_iTimerID = 0;
+    poJobCtx->m_bPending = true;
+
+    int iJobIdx = (int)m_vecJobList.size();
+    m_vecJobList.push_back(poJobCtx);
+
+    //run once at start, the job may have work already.
+    PushReady(iJobIdx);
+    m_oCond.notify_one();
+    return iJobIdx;
+}
+
+void JobScheduler :: RemoveJob(const int iJobIdx)
+{
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+    JobCtx * poJobCtx = m_vecJobList[iJobIdx];
+    poJobCtx->m_bRemoved = true;
+
+    //ready queue skip removed job, only need to wait the running slice.
+    while (poJobCtx->m_iState == JobState_Running)
+    {
+        m_oRemoveCond.wait(oLock);
+    }
+
+    if (poJobCtx->m_iTimerID != 0)
+    {
+        m_oTimer.RemoveTimer(poJobCtx->m_iTimerID);
+        poJobCtx->m_iTimerID = 0;
+    }
+
+    poJobCtx->m_iState = JobState_Idle;
+    poJobCtx->m_poJob = nullptr;
+}
+
+void JobScheduler :: Notify(const int iJobIdx)
+{
+    JobCtx * poJobCtx = m_vecJobList[iJobIdx];
+
+    //already pending, the worker will see the new event before or after this slice.
+    if (poJobCtx->m_bPending.exchange(true))
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        if (poJobCtx->m_bRemoved || poJobCtx->m_iState != JobState_Idle)
+        {
+            return;
+        }
+
+        PushReady(iJobIdx);
+    }
+
+    m_oCond.notify_one();
+}
+
+void JobScheduler :: EnterBlocking()
+{
+    if (t_poWorkerScheduler != nullptr && t_iBlockingDepth++ == 0)
+    {
+        t_poWorkerScheduler->OnEnterBlocking();
+    }
+}
+
+void JobScheduler :: ExitBlocking()
+{
+    if (t_poWorkerScheduler != nullptr && --t_iBlockingDepth == 0)
+    {
+        t_poWorkerScheduler->OnExitBlocking();
+    }
+}
+
+//give this worker's slot to others, start a spare worker if no one is idle.
+void JobScheduler :: OnEnterBlocking()
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    m_iRunningCount--;
+
+    if (m_iIdleCount == 0)
+    {
+        AddWorker();
+    }
+    else if (!m_dequeReady.empty())
+    {
+        m_oCond.notify_one();
+    }
+}
+
+//may run over m_iThreadCount for a while, workers wait before next slice until it drops.
+void JobScheduler :: OnExitBlocking()
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    m_iRunningCount++;
+}
+
+//must hold lock.
+void JobScheduler :: PushReady(const int iJobIdx)
+{
+    JobCtx * poJobCtx = m_vecJobList[iJobIdx];
+    if (poJobCtx->m_iTimerID != 0)
+    {
+        m_oTimer.RemoveTimer(poJobCtx->m_iTimerID);
+        poJobCtx->m_iTimerID = 0;
+    }
+
+    poJobCtx->m_iState = JobState_Ready;
+    m_dequeReady.push_back(iJobIdx);
+}
+
+//must hold lock.
+void JobScheduler :: DealwithTimeout()
+{
+    uint32_t iTimerID = 0;
+    int iType = 0;
+    int iJobIdx = 0;
+    while (m_oTimer.PopTimeout(iTimerID, iType, iJobIdx))
+    {
+        JobCtx * poJobCtx = m_vecJobList[iJobIdx];
+        poJobCtx->m_iTimerID = 0;
+        if (!poJobCtx->m_bRemoved && poJobCtx->m_iState == JobState_Idle)
+        {
+            PushReady(iJobIdx);
+        }
+    }
+}
+
+void JobScheduler :: WorkerRun()
+{
+    t_poWorkerScheduler = this;
+
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+    while (!m_bIsEnd)
+    {
+        DealwithTimeout();
+
+        if (m_dequeReady.empty() || m_iRunningCount >= m_iThreadCount)
+        {
+            int iWaitMs = m_oTimer.GetNextTimeout();
+            if (iWaitMs < 0 || iWaitMs > JOB_SCHEDULER_MAX_WAIT_MS)
+            {
+                iWaitMs = JOB_SCHEDULER_MAX_WAIT_MS;
+            }
+
+            m_iIdleCount++;
+            m_oCond.wait_for(oLock, std::chrono::milliseconds(iWaitMs));
+            m_iIdleCount--;
+            continue;
+        }
+
+        int iJobIdx = m_dequeReady.front();
+        m_dequeReady.pop_front();
+        if (!m_dequeReady.empty())
+        {
+            m_oCond.notify_one();
+        }
+
+        JobCtx * poJobCtx = m_vecJobList[iJobIdx];
+        if (poJobCtx->m_bRemoved)
+        {
+            poJobCtx->m_iState = JobState_Idle;
+            continue;
+        }
+
+        poJobCtx->m_iState = JobState_Running;
+        poJobCtx->m_bPending = false;
+        m_iRunningCount++;
+
+        oLock.unlock();
+        int iNextTimeout = poJobCtx->m_poJob->RunSlice();
+        oLock.lock();
+
+        m_iRunningCount--;
+
+        if (poJobCtx->m_bRemoved)
+        {
+            poJobCtx->m_iState = JobState_Idle;
+            m_oRemoveCond.notify_all();
+            continue;
+        }
+
+        if (iNextTimeout == 0 || poJobCtx->m_bPending)
+        {
+            //more work left, go to the tail so other jobs get their turn.
+            PushReady(iJobIdx);
+            continue;
+        }
+
+        poJobCtx->m_iState = JobState_Idle;
+        m_oTimer.AddTimerWithData(Time::GetSteadyClockMS() + iNextTimeout, 0, iJobIdx, poJobCtx->m_iTimerID);
+    }
+}
+
+////////////////////////////////////////////////////
+
+SchedulerBlockingGuard :: SchedulerBlockingGuard()
+{
+    JobScheduler::EnterBlocking();
+}
+
+SchedulerBlockingGuard :: ~SchedulerBlockingGuard()
+{
+    JobScheduler::ExitBlocking();
+}
+    
+}
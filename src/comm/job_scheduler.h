@@ -0,0 +1,154 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "timer.h"
+
+namespace phxpaxos
+{
+
+class JobScheduler;
+
+//work of a group run by JobScheduler slice by slice on shared threads, instead of its own thread.
+class ScheduledJob
+{
+public:
+    ScheduledJob();
+    virtual ~ScheduledJob();
+
+    //do some work without waiting, return 0 if work left, otherwise ms until next slice.
+    virtual int RunSlice() = 0;
+
+    //return -1 if scheduler is full, then the job should run on its own thread.
+    int StartOnScheduler(JobScheduler * poScheduler);
+
+    //after return, RunSlice won't be called anymore.
+    void StopOnScheduler();
+
+    const bool IsOnScheduler() const;
+
+    //called by producers after a new event, run the job soon if it is idle.
+    void NotifyScheduler();
+
+private:
+    JobScheduler * m_poScheduler;
+    int m_iJobIdx;
+    bool m_bIsOnScheduler;
+};
+
+//run many groups' jobs (ioloop, learner sender, cleaner, replayer, applier, master)
+//on a few shared worker threads.
+//a job is scheduled when it is notified or its timer is due, and runs one slice at a time,
+//so a job never runs on two workers at once and its state keeps single-threaded.
+//a slice is not preemptive, so slices mark where they may block (fsync, state machine,
+//sync propose) with SchedulerBlockingGuard, and another worker runs other jobs meanwhile.
+class JobScheduler
+{
+public:
+    JobScheduler();
+    ~JobScheduler();
+
+    //jobs can be added at most iMaxJobCount, so Notify can index jobs without lock.
+    void Start(const int iThreadCount, const int iMaxJobCount);
+
+    void Stop();
+
+    const bool IsStart() const;
+
+    //return job index used by Notify and RemoveJob, -1 if too many jobs.
+    int AddJob(ScheduledJob * poJob);
+
+    //after return, the job won't be run anymore.
+    void RemoveJob(const int iJobIdx);
+
+    //wake up the job if it is idle.
+    void Notify(const int iJobIdx);
+
+    //called by a slice before and after it may block, no-op outside worker threads.
+    static void EnterBlocking();
+
+    static void ExitBlocking();
+
+private:
+    void WorkerRun();
+
+    void AddWorker();
+
+    void PushReady(const int iJobIdx);
+
+    void DealwithTimeout();
+
+    void OnEnterBlocking();
+
+    void OnExitBlocking();
+
+private:
+    enum JobState
+    {
+        JobState_Idle = 0,
+        JobState_Ready = 1,
+        JobState_Running = 2,
+    };
+
+    struct JobCtx
+    {
+        ScheduledJob * m_poJob;
+        int m_iState;
+        bool m_bRemoved;
+        uint32_t m_iTimerID;
+        std::atomic<bool> m_bPending;
+    };
+
+    std::mutex m_oMutex;
+    std::condition_variable m_oCond;
+    std::condition_variable m_oRemoveCond;
+
+    std::vector<JobCtx *> m_vecJobList;
+    std::deque<int> m_dequeReady;
+    Timer m_oTimer;
+
+    std::vector<std::thread *> m_vecWorkerList;
+    bool m_bIsEnd;
+
+    //at most m_iThreadCount slices run outside blocking regions at the same time,
+    //blocked slices may take more workers, up to m_iMaxWorkerCount.
+    int m_iThreadCount;
+    int m_iMaxWorkerCount;
+    int m_iRunningCount;
+    int m_iIdleCount;
+};
+
+//mark a slice may block in its scope.
+class SchedulerBlockingGuard
+{
+public:
+    SchedulerBlockingGuard();
+    ~SchedulerBlockingGuard();
+};
+    
+}
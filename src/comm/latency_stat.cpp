@@ -0,0 +1,202 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "phxpaxos/latency_stat.h"
+
+namespace phxpaxos
+{
+
+LatencyHistogram :: LatencyHistogram()
+{
+    Reset();
+}
+
+int LatencyHistogram :: GetBucketIdx(const uint64_t llValueUs)
+{
+    if (llValueUs < LATENCY_HISTOGRAM_SUB_COUNT)
+    {
+        return (int)llValueUs;
+    }
+
+    if (llValueUs >> LATENCY_HISTOGRAM_MAX_BITS)
+    {
+        return LATENCY_HISTOGRAM_BUCKET_COUNT - 1;
+    }
+
+    //highest bit position, then the next SUB_BITS bits pick the sub bucket.
+    int iHighBit = 63 - __builtin_clzll(llValueUs);
+    int iShift = iHighBit - LATENCY_HISTOGRAM_SUB_BITS;
+    int iSub = (int)((llValueUs >> iShift) & (LATENCY_HISTOGRAM_SUB_COUNT - 1));
+
+    return (iShift + 1) * LATENCY_HISTOGRAM_SUB_COUNT + iSub;
+}
+
+uint64_t LatencyHistogram :: GetBucketMaxValue(const int iBucketIdx)
+{
+    if (iBucketIdx < LATENCY_HISTOGRAM_SUB_COUNT)
+    {
+        return iBucketIdx;
+    }
+
+    int iShift = iBucketIdx / LATENCY_HISTOGRAM_SUB_COUNT - 1;
+    uint64_t llSub = iBucketIdx % LATENCY_HISTOGRAM_SUB_COUNT;
+
+    return ((LATENCY_HISTOGRAM_SUB_COUNT + llSub + 1) << iShift) - 1;
+}
+
+void LatencyHistogram :: Record(const uint64_t llValueUs)
+{
+    m_arrCount[GetBucketIdx(llValueUs)].fetch_add(1, std::memory_order_relaxed);
+    m_llSumUs.fetch_add(llValueUs, std::memory_order_relaxed);
+}
+
+void LatencyHistogram :: Merge(const LatencyHistogram & oOther)
+{
+    for (int i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        m_arrCount[i].fetch_add(oOther.m_arrCount[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    m_llSumUs.fetch_add(oOther.m_llSumUs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void LatencyHistogram :: Reset()
+{
+    for (auto & llCount : m_arrCount)
+    {
+        llCount.store(0, std::memory_order_relaxed);
+    }
+
+    m_llSumUs.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram :: GetPercentile(const std::vector<uint64_t> & vecCount, const uint64_t llTotal, const double dRatio) const
+{
+    //smallest bucket that covers ceil(total * ratio) values.
+    uint64_t llRank = (uint64_t)(llTotal * dRatio);
+    if (llRank < llTotal * dRatio || llRank == 0)
+    {
+        llRank++;
+    }
+
+    uint64_t llSeen = 0;
+    for (int i = 0; i < (int)vecCount.size(); i++)
+    {
+        llSeen += vecCount[i];
+        if (llSeen >= llRank)
+        {
+            return GetBucketMaxValue(i);
+        }
+    }
+
+    return 0;
+}
+
+void LatencyHistogram :: Snapshot(LatencySnapshot & oSnapshot) const
+{
+    std::vector<uint64_t> vecCount(LATENCY_HISTOGRAM_BUCKET_COUNT, 0);
+    uint64_t llTotal = 0;
+    int iMaxBucketIdx = -1;
+    for (int i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        vecCount[i] = m_arrCount[i].load(std::memory_order_relaxed);
+        llTotal += vecCount[i];
+        if (vecCount[i] > 0)
+        {
+            iMaxBucketIdx = i;
+        }
+    }
+
+    oSnapshot.llCount = llTotal;
+    oSnapshot.llSumUs = m_llSumUs.load(std::memory_order_relaxed);
+    oSnapshot.llP50Us = GetPercentile(vecCount, llTotal, 0.5);
+    oSnapshot.llP90Us = GetPercentile(vecCount, llTotal, 0.9);
+    oSnapshot.llP99Us = GetPercentile(vecCount, llTotal, 0.99);
+    oSnapshot.llP999Us = GetPercentile(vecCount, llTotal, 0.999);
+    oSnapshot.llMaxUs = iMaxBucketIdx >= 0 ? GetBucketMaxValue(iMaxBucketIdx) : 0;
+}
+
+////////////////////////////////////////////////////////////
+
+LatencyStatBP :: LatencyStatBP(const int iGroupCount)
+    : m_iGroupCount(iGroupCount)
+{
+    for (int i = 0; i < m_iGroupCount * LatencyStage_Max; i++)
+    {
+        m_vecHistogram.push_back(new LatencyHistogram());
+    }
+}
+
+LatencyStatBP :: ~LatencyStatBP()
+{
+    for (auto & poHistogram : m_vecHistogram)
+    {
+        delete poHistogram;
+    }
+}
+
+void LatencyStatBP :: StageUseTimeUs(const int iGroupIdx, const int iStage, const uint64_t llUseTimeUs)
+{
+    if (iGroupIdx < 0 || iGroupIdx >= m_iGroupCount || iStage < 0 || iStage >= LatencyStage_Max)
+    {
+        return;
+    }
+
+    m_vecHistogram[iGroupIdx * LatencyStage_Max + iStage]->Record(llUseTimeUs);
+}
+
+int LatencyStatBP :: GetSnapshot(const int iGroupIdx, const int iStage, LatencySnapshot & oSnapshot) const
+{
+    if (iGroupIdx < 0 || iGroupIdx >= m_iGroupCount || iStage < 0 || iStage >= LatencyStage_Max)
+    {
+        return -2;
+    }
+
+    m_vecHistogram[iGroupIdx * LatencyStage_Max + iStage]->Snapshot(oSnapshot);
+    return 0;
+}
+
+int LatencyStatBP :: GetSnapshot(const int iStage, LatencySnapshot & oSnapshot) const
+{
+    if (iStage < 0 || iStage >= LatencyStage_Max)
+    {
+        return -2;
+    }
+
+    LatencyHistogram oMerged;
+    for (int iGroupIdx = 0; iGroupIdx < m_iGroupCount; iGroupIdx++)
+    {
+        oMerged.Merge(*m_vecHistogram[iGroupIdx * LatencyStage_Max + iStage]);
+    }
+
+    oMerged.Snapshot(oSnapshot);
+    return 0;
+}
+
+void LatencyStatBP :: Reset()
+{
+    for (auto & poHistogram : m_vecHistogram)
+    {
+        poHistogram->Reset();
+    }
+}
+    
+}
@@ -22,6 +22,7 @@ See the AUTHORS file for names of contributors.
 #pragma once
 
 #include "phxpaxos/options.h"
+#include "phxpaxos/network.h"
 
 namespace phxpaxos
 {
@@ -40,13 +41,14 @@ public:
     virtual int SendMessage(const nodeid_t iSendtoNodeID, const std::string & sBuffer, 
             const int iSendType = Message_SendType_UDP) = 0;
 
-    virtual int BroadcastMessage(const std::string & sBuffer, 
+    //buffer is shared by all receivers, not copied for each one.
+    virtual int BroadcastMessage(const SharedMessage & poBuffer, 
             const int iSendType = Message_SendType_UDP) = 0;
     
-    virtual int BroadcastMessageFollower(const std::string & sBuffer, 
+    virtual int BroadcastMessageFollower(const SharedMessage & poBuffer, 
             const int iSendType = Message_SendType_UDP) = 0;
     
-    virtual int BroadcastMessageTempNode(const std::string & sBuffer, 
+    virtual int BroadcastMessageTempNode(const SharedMessage & poBuffer, 
             const int iSendType = Message_SendType_UDP) = 0;
 };
     
@@ -115,6 +115,8 @@ Options :: Options()
     poLogStorage = nullptr;
     bSync = true;
     iSyncInterval = 0;
+    bUseLogMmapRead = false;
+    bUseLogMemIndex = false;
     poNetWork = nullptr;
     iUDPMaxSize = 4096;
     iGroupCount = 1;
@@ -126,7 +128,18 @@ Options :: Options()
     eLogLevel = LogLevel::LogLevel_None;
     bUseCheckpointReplayer = false;
     bUseBatchPropose = false;
+    bUseAdaptiveBatchPropose = false;
     bOpenChangeValueBeforePropose = false;
+    iProposeWindowSize = 0;
+    iAsyncProposeQueueSize = 10000;
+    iLearnBatchMaxSize = 0;
+    iMaxApplyLag = 0;
+    iTcpIOThreadCount = 1;
+    iIOLoopThreadCount = 0;
+    bUseCompactPaxosMsg = false;
+    iInstanceTraceRingSize = 0;
+    iInstanceTraceDumpThresholdMs = 0;
+    iInstanceTraceDumpIntervalMs = 10000;
 }
     
 }
@@ -39,8 +39,9 @@ Communicate :: ~Communicate()
 {
 }
 
+//poMessage is the shared copy of sMessage if any, network can hold it without copy.
 int Communicate :: Send(const nodeid_t iNodeID, const NodeInfo & oNodeInfo, 
-        const std::string & sMessage, const int iSendType)
+        const std::string & sMessage, const SharedMessage & poMessage, const int iSendType)
 {
     if ((int)sMessage.size() > MAX_VALUE_SIZE)
     {
@@ -56,21 +57,29 @@ int Communicate :: Send(const nodeid_t iNodeID, const NodeInfo & oNodeInfo,
     if (sMessage.size() > m_iUDPMaxSize || iSendType == Message_SendType_TCP)
     {
         BP->GetNetworkBP()->SendTcp(sMessage);
+        if (poMessage != nullptr)
+        {
+            return m_poNetwork->SendMessageTCP(oNodeInfo.GetIP(), oNodeInfo.GetPort(), poMessage);
+        }
         return m_poNetwork->SendMessageTCP(oNodeInfo.GetIP(), oNodeInfo.GetPort(), sMessage);
     }
     else
     {
         BP->GetNetworkBP()->SendUdp(sMessage);
+        if (poMessage != nullptr)
+        {
+            return m_poNetwork->SendMessageUDP(oNodeInfo.GetIP(), oNodeInfo.GetPort(), poMessage);
+        }
         return m_poNetwork->SendMessageUDP(oNodeInfo.GetIP(), oNodeInfo.GetPort(), sMessage);
     }
 }
 
 int Communicate :: SendMessage(const nodeid_t iSendtoNodeID, const std::string & sMessage, const int iSendType)
 {
-    return Send(iSendtoNodeID, NodeInfo(iSendtoNodeID), sMessage, iSendType);
+    return Send(iSendtoNodeID, NodeInfo(iSendtoNodeID), sMessage, nullptr, iSendType);
 }
 
-int Communicate :: BroadcastMessage(const std::string & sMessage, const int iSendType)
+int Communicate :: BroadcastMessage(const SharedMessage & poMessage, const int iSendType)
 {
     const std::set<nodeid_t> & setNodeInfo = m_poConfig->GetSystemVSM()->GetMembershipMap();
     
@@ -78,14 +87,14 @@ int Communicate :: BroadcastMessage(const std::string & sMessage, const int iSen
     {
         if (it != m_iMyNodeID)
         {
-            Send(it, NodeInfo(it), sMessage, iSendType);
+            Send(it, NodeInfo(it), *poMessage, poMessage, iSendType);
         }
     }
 
     return 0;
 }
 
-int Communicate :: BroadcastMessageFollower(const std::string & sMessage, const int iSendType)
+int Communicate :: BroadcastMessageFollower(const SharedMessage & poMessage, const int iSendType)
 {
     const std::map<nodeid_t, uint64_t> & mapFollowerNodeInfo = m_poConfig->GetMyFollowerMap(); 
     
@@ -93,7 +102,7 @@ int Communicate :: BroadcastMessageFollower(const std::string & sMessage, const
     {
         if (it.first != m_iMyNodeID)
         {
-            Send(it.first, NodeInfo(it.first), sMessage, iSendType);
+            Send(it.first, NodeInfo(it.first), *poMessage, poMessage, iSendType);
         }
     }
     
@@ -102,7 +111,7 @@ int Communicate :: BroadcastMessageFollower(const std::string & sMessage, const
     return 0;
 }
 
-int Communicate :: BroadcastMessageTempNode(const std::string & sMessage, const int iSendType)
+int Communicate :: BroadcastMessageTempNode(const SharedMessage & poMessage, const int iSendType)
 {
     const std::map<nodeid_t, uint64_t> & mapTempNode = m_poConfig->GetTmpNodeMap(); 
     
@@ -110,7 +119,7 @@ int Communicate :: BroadcastMessageTempNode(const std::string & sMessage, const
     {
         if (it.first != m_iMyNodeID)
         {
-            Send(it.first, NodeInfo(it.first), sMessage, iSendType);
+            Send(it.first, NodeInfo(it.first), *poMessage, poMessage, iSendType);
         }
     }
     
@@ -43,20 +43,21 @@ public:
     int SendMessage(const nodeid_t iSendtoNodeID, const std::string & sMessage,
             const int iSendType = Message_SendType_UDP);
 
-    int BroadcastMessage(const std::string & sMessage,
+    int BroadcastMessage(const SharedMessage & poMessage,
             const int iSendType = Message_SendType_UDP);
 
-    int BroadcastMessageFollower(const std::string & sMessage,
+    int BroadcastMessageFollower(const SharedMessage & poMessage,
             const int iSendType = Message_SendType_UDP);
     
-    int BroadcastMessageTempNode(const std::string & sMessage,
+    int BroadcastMessageTempNode(const SharedMessage & poMessage,
             const int iSendType = Message_SendType_UDP);
 
 public:
     void SetUDPMaxSize(const size_t iUDPMaxSize);
 
 private:
-    int Send(const nodeid_t iNodeID, const NodeInfo & tNodeInfo, const std::string & sMessage, const int iSendType);
+    int Send(const nodeid_t iNodeID, const NodeInfo & tNodeInfo, const std::string & sMessage, 
+            const SharedMessage & poMessage, const int iSendType);
 
 private:
     Config * m_poConfig;
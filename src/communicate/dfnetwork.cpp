@@ -41,7 +41,7 @@ void DFNetWork :: StopNetWork()
     m_oTcpIOThread.Stop();
 }
 
-int DFNetWork :: Init(const std::string & sListenIp, const int iListenPort) 
+int DFNetWork :: Init(const std::string & sListenIp, const int iListenPort, const int iIOThreadCount) 
 {
     // Ĭʼȳʼ UDP send ģ顣
     int ret = m_oUDPSend.Init();
@@ -57,7 +57,7 @@ int DFNetWork :: Init(const std::string & sListenIp, const int iListenPort)
     }
 
     // ʼ TCP ģ飬Ҫעʹ TCP ʱʹ epoll ģ͡
-    ret = m_oTcpIOThread.Init(sListenIp, iListenPort);
+    ret = m_oTcpIOThread.Init(sListenIp, iListenPort, iIOThreadCount);
     if (ret != 0)
     {
         PLErr("m_oTcpIOThread Init fail, ret %d", ret);
@@ -76,12 +76,22 @@ void DFNetWork :: RunNetWork()
 
 int DFNetWork :: SendMessageTCP(const std::string & sIp, const int iPort, const std::string & sMessage)
 {
-    return m_oTcpIOThread.AddMessage(sIp, iPort, sMessage);
+    return m_oTcpIOThread.AddMessage(sIp, iPort, std::make_shared<const std::string>(sMessage));
 }
 
 int DFNetWork :: SendMessageUDP(const std::string & sIp, const int iPort, const std::string & sMessage)
 {
-    return m_oUDPSend.AddMessage(sIp, iPort, sMessage);
+    return m_oUDPSend.AddMessage(sIp, iPort, std::make_shared<const std::string>(sMessage));
+}
+
+int DFNetWork :: SendMessageTCP(const std::string & sIp, const int iPort, const SharedMessage & poMessage)
+{
+    return m_oTcpIOThread.AddMessage(sIp, iPort, poMessage);
+}
+
+int DFNetWork :: SendMessageUDP(const std::string & sIp, const int iPort, const SharedMessage & poMessage)
+{
+    return m_oUDPSend.AddMessage(sIp, iPort, poMessage);
 }
 
 }
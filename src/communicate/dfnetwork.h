@@ -35,7 +35,7 @@ public:
     DFNetWork();
     virtual ~DFNetWork();
 
-    int Init(const std::string & sListenIp, const int iListenPort);
+    int Init(const std::string & sListenIp, const int iListenPort, const int iIOThreadCount);
 
     void RunNetWork();
 
@@ -45,6 +45,10 @@ public:
 
     int SendMessageUDP(const std::string & sIp, const int iPort, const std::string & sMessage);
 
+    int SendMessageTCP(const std::string & sIp, const int iPort, const SharedMessage & poMessage);
+
+    int SendMessageUDP(const std::string & sIp, const int iPort, const SharedMessage & poMessage);
+
 private:
     UDPRecv m_oUDPRecv;
     UDPSend m_oUDPSend;
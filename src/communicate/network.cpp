@@ -22,6 +22,7 @@ See the AUTHORS file for names of contributors.
 #include "phxpaxos/network.h"
 #include "phxpaxos/node.h"
 #include "commdef.h"
+#include "msg_buffer.h"
 
 namespace phxpaxos
 {
@@ -30,6 +31,16 @@ NetWork :: NetWork() : m_poNode(nullptr)
 {
 }
     
+int NetWork :: SendMessageTCP(const std::string & sIp, const int iPort, const SharedMessage & poMessage)
+{
+    return SendMessageTCP(sIp, iPort, *poMessage);
+}
+
+int NetWork :: SendMessageUDP(const std::string & sIp, const int iPort, const SharedMessage & poMessage)
+{
+    return SendMessageUDP(sIp, iPort, *poMessage);
+}
+
 int NetWork :: OnReceiveMessage(const char * pcMessage, const int iMessageLen)
 {
     if (m_poNode != nullptr)
@@ -44,6 +55,21 @@ int NetWork :: OnReceiveMessage(const char * pcMessage, const int iMessageLen)
     return 0;
 }
 
+int NetWork :: OnReceiveMessage(MsgBuffer * poBuffer)
+{
+    if (m_poNode != nullptr)
+    {
+        m_poNode->OnReceiveMessage(poBuffer);
+    }
+    else
+    {
+        PLHead("receive msglen %d", poBuffer->GetLen());
+        MsgBufferPool::Instance()->Put(poBuffer);
+    }
+
+    return 0;
+}
+
 }
 
 
@@ -160,7 +160,7 @@ void EventLoop :: StartLoop()
         //deal with accept fds
         if (m_poTcpAcceptor != nullptr)
         {
-            m_poTcpAcceptor->CreateEvent();
+            m_poTcpAcceptor->CreateEvent(this);
         }
 
         if (m_poTcpClient != nullptr)
@@ -271,35 +271,18 @@ bool EventLoop :: AddTimer(const Event * poEvent, const int iTimeout, const int
     }
 
     uint64_t llAbsTime = Time::GetSteadyClockMS() + iTimeout;
-    m_oTimer.AddTimerWithType(llAbsTime, iType, iTimerID);
-
-    m_mapTimerID2FD[iTimerID] = poEvent->GetSocketFd();
+    m_oTimer.AddTimerWithData(llAbsTime, iType, poEvent->GetSocketFd(), iTimerID);
 
     return true;
 }
 
 void EventLoop :: RemoveTimer(const uint32_t iTimerID)
 {
-    auto it = m_mapTimerID2FD.find(iTimerID);
-    if (it != end(m_mapTimerID2FD))
-    {
-        m_mapTimerID2FD.erase(it);
-    }
+    m_oTimer.RemoveTimer(iTimerID);
 }
 
-void EventLoop :: DealwithTimeoutOne(const uint32_t iTimerID, const int iType)
+void EventLoop :: DealwithTimeoutOne(const uint32_t iTimerID, const int iType, const int iSocketFd)
 {
-    auto it = m_mapTimerID2FD.find(iTimerID);
-    if (it == end(m_mapTimerID2FD))
-    {
-        //PLErr("Timeout aready remove!, timerid %u iType %d", iTimerID, iType);
-        return;
-    }
-
-    int iSocketFd = it->second;
-
-    m_mapTimerID2FD.erase(it);
-
     auto eventIt = m_mapEvent.find(iSocketFd);
     if (eventIt == end(m_mapEvent))
     {
@@ -317,19 +300,21 @@ void EventLoop :: DealwithTimeout(int & iNextTimeout)
     {
         uint32_t iTimerID = 0;
         int iType = 0;
-        bHasTimeout = m_oTimer.PopTimeout(iTimerID, iType);
+        int iSocketFd = 0;
+        bHasTimeout = m_oTimer.PopTimeout(iTimerID, iType, iSocketFd);
 
         if (bHasTimeout)
         {
-            DealwithTimeoutOne(iTimerID, iType);
-
-            iNextTimeout = m_oTimer.GetNextTimeout();
-            if (iNextTimeout != 0)
-            {
-                break;
-            }
+            DealwithTimeoutOne(iTimerID, iType, iSocketFd);
         }
     }
+
+    //wake up for the next timer, but still check the sockets periodically.
+    int iTimerTimeout = m_oTimer.GetNextTimeout();
+    if (iTimerTimeout >= 0 && iTimerTimeout < iNextTimeout)
+    {
+        iNextTimeout = iTimerTimeout;
+    }
 }
 
 }
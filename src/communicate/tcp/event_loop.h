@@ -69,7 +69,7 @@ public:
 
     void DealwithTimeout(int & iNextTimeout);
 
-    void DealwithTimeoutOne(const uint32_t iTimerID, const int iType);
+    void DealwithTimeoutOne(const uint32_t iTimerID, const int iType, const int iSocketFd);
 
 public:
     typedef struct EventCtx
@@ -90,8 +90,8 @@ protected:
     Notify * m_poNotify;
 
 protected:
+    //timer data is the socket fd of the event.
     Timer m_oTimer;
-    std::map<uint32_t, int> m_mapTimerID2FD;
 };
     
 }
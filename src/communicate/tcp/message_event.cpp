@@ -24,6 +24,7 @@ See the AUTHORS file for names of contributors.
 #include "phxpaxos/network.h"
 #include "event_loop.h"
 #include "comm_include.h"
+#include <sys/uio.h>
 
 namespace phxpaxos
 {
@@ -38,11 +39,11 @@ MessageEvent :: MessageEvent(
 {
     m_iType = iType;
 
+    m_poReadBuffer = nullptr;
     m_iLeftReadLen = 0;
     m_iLastReadPos = 0;
 
-    m_iLeftWriteLen = 0;
-    m_iLastWritePos = 0;
+    m_iWriteOffset = 0;
 
     memset(m_sReadHeadBuffer, 0, sizeof(m_sReadHeadBuffer));
     m_iLastReadHeadPos = 0;
@@ -62,11 +63,10 @@ MessageEvent :: ~MessageEvent()
 {
     while (!m_oInQueue.empty())
     {
-        QueueData tData = m_oInQueue.front();
         m_oInQueue.pop();
-
-        delete tData.psValue;
     }
+
+    MsgBufferPool::Instance()->Put(m_poReadBuffer);
 }
 
 int MessageEvent :: GetSocketFd() const
@@ -91,7 +91,7 @@ const bool MessageEvent :: IsActive()
     return true;
 }
 
-int MessageEvent :: AddMessage(const std::string & sMessage)
+int MessageEvent :: AddMessage(const SharedMessage & poMessage)
 {
     m_llLastActiveTime = Time::GetSteadyClockMS();
     std::unique_lock<std::mutex> oLock(m_oMutex);
@@ -111,10 +111,10 @@ int MessageEvent :: AddMessage(const std::string & sMessage)
 
     QueueData tData;
     tData.llEnqueueAbsTime = Time::GetSteadyClockMS();
-    tData.psValue = new string(sMessage);
+    tData.poMessage = poMessage;
     m_oInQueue.push(tData);
 
-    m_iQueueMemSize += sMessage.size();
+    m_iQueueMemSize += poMessage->size();
 
     oLock.unlock();
 
@@ -123,10 +123,14 @@ int MessageEvent :: AddMessage(const std::string & sMessage)
     return 0;
 }
 
-void MessageEvent :: ReadDone(BytesBuffer & oBytesBuffer, const int iLen)
+void MessageEvent :: ReadDone()
 {
+    int iLen = m_poReadBuffer->GetLen();
+
     //PLHead("ok, len %d", iLen);
-    m_poNetWork->OnReceiveMessage(oBytesBuffer.GetPtr(), iLen);
+    //buffer is handed to the network with its ownership.
+    m_poNetWork->OnReceiveMessage(m_poReadBuffer);
+    m_poReadBuffer = nullptr;
 
     BP->GetNetworkBP()->TcpReadOneMessageOk(iLen);
 }
@@ -134,7 +138,7 @@ void MessageEvent :: ReadDone(BytesBuffer & oBytesBuffer, const int iLen)
 int MessageEvent :: ReadLeft()
 {
     bool bAgain = false;
-    int iReadLen = m_oSocket.receive(m_oReadCacheBuffer.GetPtr() + m_iLastReadPos, m_iLeftReadLen, &bAgain);
+    int iReadLen = m_oSocket.receive(m_poReadBuffer->GetPtr() + m_iLastReadPos, m_iLeftReadLen, &bAgain);
     //PLImp("readlen %d", iReadLen);
     if (iReadLen == 0)
     {
@@ -147,7 +151,7 @@ int MessageEvent :: ReadLeft()
 
     if (m_iLeftReadLen == 0)
     {
-        ReadDone(m_oReadCacheBuffer, m_iLastReadPos);
+        ReadDone();
         m_iLeftReadLen = 0;
         m_iLastReadPos = 0;
     }
@@ -189,14 +193,21 @@ int MessageEvent :: OnRead()
         return -2; 
     }
 
-    m_oReadCacheBuffer.Ready(iLen);
+    if (m_poReadBuffer == nullptr)
+    {
+        m_poReadBuffer = MsgBufferPool::Instance()->Get(iLen);
+    }
+    else
+    {
+        m_poReadBuffer->Ready(iLen);
+    }
 
     m_iLeftReadLen = iLen;
     m_iLastReadPos = 0;
     
     //second read maybe no data read, so readlen == 0 is ok.
     bool bAgain = false;
-    iReadLen = m_oSocket.receive(m_oReadCacheBuffer.GetPtr(), iLen, &bAgain);
+    iReadLen = m_oSocket.receive(m_poReadBuffer->GetPtr(), iLen, &bAgain);
     if (iReadLen == 0)
     {
         if (!bAgain)
@@ -213,7 +224,7 @@ int MessageEvent :: OnRead()
 
     if (iReadLen == iLen)
     {
-        ReadDone(m_oReadCacheBuffer, iLen);
+        ReadDone();
         m_iLeftReadLen = 0;
         m_iLastReadPos = 0;
     }
@@ -258,29 +269,66 @@ void MessageEvent :: WriteDone()
 
 int MessageEvent :: WriteLeft()
 {
-    int iWriteLen = m_oSocket.send(m_oWriteCacheBuffer.GetPtr() + m_iLastWritePos, m_iLeftWriteLen);
-    //PLImp("writelen %d", iWriteLen);
+    struct iovec arrIovecs[TCP_WRITEV_MAX_MSGS * 2];
+    int iIovCount = 0;
+    int iOffset = m_iWriteOffset;
+    for (auto & tData : m_dequeWriteList)
+    {
+        if (iOffset < (int)sizeof(int))
+        {
+            arrIovecs[iIovCount].iov_base = (char *)&tData.iNetLen + iOffset;
+            arrIovecs[iIovCount].iov_len = sizeof(int) - iOffset;
+            iIovCount++;
+            iOffset = sizeof(int);
+        }
+
+        arrIovecs[iIovCount].iov_base = (char *)tData.poMessage->data() + (iOffset - sizeof(int));
+        arrIovecs[iIovCount].iov_len = tData.poMessage->size() - (iOffset - sizeof(int));
+        iIovCount++;
+        iOffset = 0;
+    }
+
+    ssize_t iWriteLen = 0;
+    do
+    {
+        iWriteLen = writev(m_oSocket.getSocketHandle(), arrIovecs, iIovCount);
+    } while (iWriteLen < 0 && errno == EINTR);
+
     if (iWriteLen < 0)
     {
+        if (errno == EAGAIN)
+        {
+            //no buffer to write, wait next epoll_wait
+            AddEvent(EPOLLOUT);
+            return 1;
+        }
+
+        PLErr("fail, errno %d ip %s port %d", errno, m_oAddr.getHost().c_str(), m_oAddr.getPort());
         return -1; 
     }
 
-    if (iWriteLen == 0)
+    //pop the messages fully written, partial write may stop at any message.
+    size_t iLeftLen = (size_t)iWriteLen;
+    while (iLeftLen > 0 && !m_dequeWriteList.empty())
     {
-        //no buffer to write, wait next epoll_wait
-        //need wait next write
-        AddEvent(EPOLLOUT);
+        size_t iRemainLen = sizeof(int) + m_dequeWriteList.front().poMessage->size() - m_iWriteOffset;
+        if (iLeftLen < iRemainLen)
+        {
+            m_iWriteOffset += (int)iLeftLen;
+            break;
+        }
 
-        return 1;
+        iLeftLen -= iRemainLen;
+        m_dequeWriteList.pop_front();
+        m_iWriteOffset = 0;
     }
 
-    m_iLeftWriteLen -= iWriteLen;
-    m_iLastWritePos += iWriteLen;
-
-    if (m_iLeftWriteLen == 0)
+    if (!m_dequeWriteList.empty())
     {
-        m_iLeftWriteLen = 0;
-        m_iLastWritePos = 0;
+        //socket buffer is full, need wait next write
+        PLImp("write len %zd, %zu messages left", iWriteLen, m_dequeWriteList.size());
+        AddEvent(EPOLLOUT);
+        return 1;
     }
 
     return 0;
@@ -289,7 +337,7 @@ int MessageEvent :: WriteLeft()
 int MessageEvent :: OnWrite()
 {
     int ret = 0;
-    while (!m_oInQueue.empty() || m_iLeftWriteLen > 0)
+    while (!m_oInQueue.empty() || !m_dequeWriteList.empty())
     {
         ret = DoOnWrite();
         if (ret != 0 && ret != 1)
@@ -308,88 +356,52 @@ int MessageEvent :: OnWrite()
     return 0;
 }
 
-int MessageEvent :: DoOnWrite()
+void MessageEvent :: FillWriteList()
 {
-    if (m_iLeftWriteLen > 0)
-    {
-        return WriteLeft();
-    }
+    QueueData arrDataList[TCP_WRITEV_MAX_MSGS];
+    int iCount = 0;
 
     m_oMutex.lock();
-    if (m_oInQueue.empty())
+    while (!m_oInQueue.empty() && (int)m_dequeWriteList.size() + iCount < TCP_WRITEV_MAX_MSGS)
     {
-        m_oMutex.unlock();
-        return 0;
+        arrDataList[iCount] = m_oInQueue.front();
+        m_oInQueue.pop();
+        m_iQueueMemSize -= arrDataList[iCount].poMessage->size();
+        iCount++;
     }
-    QueueData tData = m_oInQueue.front();
-    m_oInQueue.pop();
-    m_iQueueMemSize -= tData.psValue->size();
     m_oMutex.unlock();
 
-    std::string * poMessage = tData.psValue;
     uint64_t llNowTime = Time::GetSteadyClockMS();
-    int iDelayMs = llNowTime > tData.llEnqueueAbsTime ? (int)(llNowTime - tData.llEnqueueAbsTime) : 0;
-    BP->GetNetworkBP()->TcpOutQueue(iDelayMs);
-    if (iDelayMs > TCP_OUTQUEUE_DROP_TIMEMS)
-    {
-        //PLErr("drop request because enqueue timeout, nowtime %lu unqueuetime %lu",
-                //llNowTime, tData.llEnqueueAbsTime);
-        delete poMessage;
-        return 0;
-    }
-
-    int iBuffLen = poMessage->size();
-    int niBuffLen = htonl(iBuffLen + 4);
-
-    int iLen = iBuffLen + 4;
-    m_oWriteCacheBuffer.Ready(iLen);
-    memcpy(m_oWriteCacheBuffer.GetPtr(), &niBuffLen, 4);
-    memcpy(m_oWriteCacheBuffer.GetPtr() + 4, poMessage->c_str(), iBuffLen);
-
-    m_iLeftWriteLen = iLen;
-    m_iLastWritePos = 0;
-
-    delete poMessage;
-
-    //PLImp("write len %d ip %s port %d", iLen, m_oAddr.getHost().c_str(), m_oAddr.getPort());
-
-    int iWriteLen = m_oSocket.send(m_oWriteCacheBuffer.GetPtr(), iLen);
-    if (iWriteLen < 0)
-    {
-        PLErr("fail, write len %d ip %s port %d",
-                iWriteLen, m_oAddr.getHost().c_str(), m_oAddr.getPort());
-        return -1;
-    }
-
-    if (iWriteLen == 0)
+    for (int i = 0; i < iCount; i++)
     {
-        //need wait next write
-        AddEvent(EPOLLOUT);
+        QueueData & tData = arrDataList[i];
+        int iDelayMs = llNowTime > tData.llEnqueueAbsTime ? (int)(llNowTime - tData.llEnqueueAbsTime) : 0;
+        BP->GetNetworkBP()->TcpOutQueue(iDelayMs);
+        if (iDelayMs > TCP_OUTQUEUE_DROP_TIMEMS)
+        {
+            //PLErr("drop request because enqueue timeout, nowtime %lu unqueuetime %lu",
+                    //llNowTime, tData.llEnqueueAbsTime);
+            continue;
+        }
 
-        return 1;
+        WriteData tWriteData;
+        tWriteData.iNetLen = htonl((int)tData.poMessage->size() + 4);
+        tWriteData.poMessage = std::move(tData.poMessage);
+        m_dequeWriteList.push_back(std::move(tWriteData));
     }
+}
 
-    //PLImp("real write len %d", iWriteLen);
-
-    if (iWriteLen == iLen)
-    {
-        m_iLeftWriteLen = 0;
-        m_iLastWritePos = 0;
-        //write done
-    }
-    else if (iWriteLen < iLen)
-    {
-        m_iLastWritePos = iWriteLen;
-        m_iLeftWriteLen = iLen - iWriteLen;
+int MessageEvent :: DoOnWrite()
+{
+    //message goes to socket by writev from where it is, no copy.
+    FillWriteList();
 
-        PLImp("write buflen %d smaller than expectlen %d", iWriteLen, iLen);
-    }
-    else
+    if (m_dequeWriteList.empty())
     {
-        PLErr("write buflen %d large than expectlen %d", iWriteLen, iLen);
+        return 0;
     }
 
-    return 0;
+    return WriteLeft();
 }
 
 void MessageEvent :: OnError(bool & bNeedDelete)
@@ -415,13 +427,12 @@ void MessageEvent :: OnError(bool & bNeedDelete)
 
             while (!m_oInQueue.empty())
             {
-                QueueData tData = m_oInQueue.front();
                 m_oInQueue.pop();
-
-                delete tData.psValue;
             }
 
             m_iQueueMemSize = 0;
+            m_dequeWriteList.clear();
+            m_iWriteOffset = 0;
 
             m_oMutex.unlock();
 
@@ -450,8 +461,8 @@ void MessageEvent :: ReConnect()
 
     //reset 
     m_iEvents = 0;
-    m_iLeftWriteLen = 0;
-    m_iLastWritePos = 0;
+    //resend the message partially written on the new connection.
+    m_iWriteOffset = 0;
 
     m_oSocket.reset();
     m_oSocket.setNonBlocking(true);
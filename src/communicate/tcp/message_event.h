@@ -22,10 +22,12 @@ See the AUTHORS file for names of contributors.
 #pragma once
 
 #include <mutex>
+#include <deque>
 #include "event_base.h"
 #include "utils_include.h"
 #include "commdef.h"
 #include "comm_include.h"
+#include "phxpaxos/network.h"
 
 namespace phxpaxos
 {
@@ -33,6 +35,9 @@ namespace phxpaxos
 class EventLoop;
 class NetWork;
 
+//max messages written in one writev, each one takes two iovecs.
+#define TCP_WRITEV_MAX_MSGS 64
+
 enum MessageEventType
 {
     MessageEventType_RECV = 1,
@@ -55,7 +60,7 @@ public:
             NetWork * poNetWork);
     ~MessageEvent();
 
-    int AddMessage(const std::string & sMessage);
+    int AddMessage(const SharedMessage & poMessage);
 
     int GetSocketFd() const;
     
@@ -76,12 +81,14 @@ public:
 private:
     int ReadLeft();
 
-    void ReadDone(BytesBuffer & oBytesBuffer, const int iLen);
+    void ReadDone();
     
     int WriteLeft();
 
     void WriteDone();
 
+    void FillWriteList();
+
     int DoOnWrite();
 
     void ReConnect();
@@ -96,20 +103,28 @@ private:
 private:
     char m_sReadHeadBuffer[sizeof(int)];
     int m_iLastReadHeadPos;
-    BytesBuffer m_oReadCacheBuffer;
+    MsgBuffer * m_poReadBuffer;
     int m_iLastReadPos;
     int m_iLeftReadLen;
 
-    BytesBuffer m_oWriteCacheBuffer;
-    int m_iLastWritePos;
-    int m_iLeftWriteLen;
-
     struct QueueData
     {
         uint64_t llEnqueueAbsTime;
-        std::string * psValue;
+        SharedMessage poMessage;
     };    
 
+    struct WriteData
+    {
+        //length prefix in network order, written from here directly.
+        int iNetLen;
+        SharedMessage poMessage;
+    };
+
+    //messages taken from queue and not fully written yet,
+    //m_iWriteOffset is the written bytes of the first one, length prefix included.
+    std::deque<WriteData> m_dequeWriteList;
+    int m_iWriteOffset;
+
     std::queue<QueueData> m_oInQueue;
     int m_iQueueMemSize;
     std::mutex m_oMutex;
@@ -25,31 +25,35 @@ See the AUTHORS file for names of contributors.
 namespace phxpaxos
 {
 
-TcpRead :: TcpRead(NetWork * poNetWork)
-    : m_oTcpAcceptor(&m_oEventLoop, poNetWork)
+TcpRead :: TcpRead(TcpAcceptor * poTcpAcceptor)
+    : m_poTcpAcceptor(poTcpAcceptor)
 {
-    m_oEventLoop.SetTcpAcceptor(&m_oTcpAcceptor);
+    m_oEventLoop.SetTcpAcceptor(m_poTcpAcceptor);
 }
 
 TcpRead :: ~TcpRead()
 {
 }
 
-int TcpRead :: Init(const std::string & sListenIp, const int iListenPort)
+int TcpRead :: Init()
 {
-    m_oTcpAcceptor.Listen(sListenIp, iListenPort);
-    return m_oEventLoop.Init(20480);
+    int ret = m_oEventLoop.Init(20480);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    m_poTcpAcceptor->AddEventLoop(&m_oEventLoop);
+    return 0;
 }
 
 void TcpRead :: run()
 {
-    m_oTcpAcceptor.start();
     m_oEventLoop.StartLoop();
 }
 
 void TcpRead :: Stop()
 {
-    m_oTcpAcceptor.Stop();
     m_oEventLoop.Stop();
     join();
 
@@ -86,15 +90,15 @@ void TcpWrite :: Stop()
     PLHead("TcpWriteThread [END]");
 }
 
-int TcpWrite :: AddMessage(const std::string & sIP, const int iPort, const std::string & sMessage)
+int TcpWrite :: AddMessage(const std::string & sIP, const int iPort, const SharedMessage & poMessage)
 {
-    return m_oTcpClient.AddMessage(sIP, iPort, sMessage);
+    return m_oTcpClient.AddMessage(sIP, iPort, poMessage);
 }
 
 ////////////////////////////////////////////////////////
 
 TcpIOThread :: TcpIOThread(NetWork * poNetWork)
-    : m_oTcpRead(poNetWork), m_oTcpWrite(poNetWork)
+    : m_poNetWork(poNetWork), m_oTcpAcceptor(poNetWork)
 {
     m_bIsStarted = false;
     assert(signal(SIGPIPE, SIG_IGN) != SIG_ERR);
@@ -104,40 +108,96 @@ TcpIOThread :: TcpIOThread(NetWork * poNetWork)
 
 TcpIOThread :: ~TcpIOThread()
 {
+    for (auto & poTcpRead : m_vecTcpRead)
+    {
+        delete poTcpRead;
+    }
+
+    for (auto & poTcpWrite : m_vecTcpWrite)
+    {
+        delete poTcpWrite;
+    }
 }
 
 void TcpIOThread :: Stop()
 {
     if (m_bIsStarted)
     {
-        m_oTcpRead.Stop();
-        m_oTcpWrite.Stop();
+        m_oTcpAcceptor.Stop();
+
+        for (auto & poTcpRead : m_vecTcpRead)
+        {
+            poTcpRead->Stop();
+        }
+
+        for (auto & poTcpWrite : m_vecTcpWrite)
+        {
+            poTcpWrite->Stop();
+        }
     }
 
     PLHead("TcpIOThread [END]");
 }
 
-int TcpIOThread :: Init(const std::string & sListenIp, const int iListenPort)
+int TcpIOThread :: Init(const std::string & sListenIp, const int iListenPort, const int iIOThreadCount)
 {
-    int ret = m_oTcpRead.Init(sListenIp, iListenPort);
-    if (ret == 0)
+    m_oTcpAcceptor.Listen(sListenIp, iListenPort);
+
+    for (int i = 0; i < iIOThreadCount; i++)
     {
-        return m_oTcpWrite.Init();
+        TcpRead * poTcpRead = new TcpRead(&m_oTcpAcceptor);
+        m_vecTcpRead.push_back(poTcpRead);
+
+        int ret = poTcpRead->Init();
+        if (ret != 0)
+        {
+            return ret;
+        }
+
+        TcpWrite * poTcpWrite = new TcpWrite(m_poNetWork);
+        m_vecTcpWrite.push_back(poTcpWrite);
+
+        ret = poTcpWrite->Init();
+        if (ret != 0)
+        {
+            return ret;
+        }
     }
 
-    return ret;
+    PLHead("OK, io thread count %d", iIOThreadCount);
+
+    return 0;
 }
 
 void TcpIOThread :: Start()
 {
-    m_oTcpWrite.start();
-    m_oTcpRead.start();
+    for (auto & poTcpWrite : m_vecTcpWrite)
+    {
+        poTcpWrite->start();
+    }
+
+    for (auto & poTcpRead : m_vecTcpRead)
+    {
+        poTcpRead->start();
+    }
+
+    m_oTcpAcceptor.start();
     m_bIsStarted = true;
 }
 
-int TcpIOThread :: AddMessage(const std::string & sIP, const int iPort, const std::string & sMessage)
+int TcpIOThread :: AddMessage(const std::string & sIP, const int iPort, const SharedMessage & poMessage)
 {
-    return m_oTcpWrite.AddMessage(sIP, iPort, sMessage);
+    if (m_vecTcpWrite.size() == 1)
+    {
+        return m_vecTcpWrite[0]->AddMessage(sIP, iPort, poMessage);
+    }
+
+    //same peer always go through the same write loop, keep message order of the connection.
+    uint32_t iIP = (uint32_t)inet_addr(sIP.c_str());
+    uint64_t llNodeID = (((uint64_t)iIP) << 32) | iPort;
+    uint64_t llHash = llNodeID * 0x9E3779B97F4A7C15ULL;
+
+    return m_vecTcpWrite[(llHash >> 32) % m_vecTcpWrite.size()]->AddMessage(sIP, iPort, poMessage);
 }
 
 }
@@ -32,17 +32,17 @@ namespace phxpaxos
 class TcpRead : public Thread
 {
 public:
-    TcpRead(NetWork * poNetWork);
+    TcpRead(TcpAcceptor * poTcpAcceptor);
     ~TcpRead();
 
-    int Init(const std::string & sListenIp, const int iListenPort);
+    int Init();
     
     void run();
 
     void Stop();
 
 private:
-    TcpAcceptor m_oTcpAcceptor;
+    TcpAcceptor * m_poTcpAcceptor;
     EventLoop m_oEventLoop;
 };
 
@@ -60,7 +60,7 @@ public:
 
     void Stop();
 
-    int AddMessage(const std::string & sIP, const int iPort, const std::string & sMessage);
+    int AddMessage(const std::string & sIP, const int iPort, const SharedMessage & poMessage);
 
 private:
     TcpClient m_oTcpClient;
@@ -73,17 +73,20 @@ public:
     TcpIOThread(NetWork * poNetWork);
     ~TcpIOThread();
 
-    int Init(const std::string & sListenIp, const int iListenPort);
+    int Init(const std::string & sListenIp, const int iListenPort, const int iIOThreadCount);
 
     void Start();
 
     void Stop();
 
-    int AddMessage(const std::string & sIP, const int iPort, const std::string & sMessage);
+    int AddMessage(const std::string & sIP, const int iPort, const SharedMessage & poMessage);
 
 private:
-    TcpRead m_oTcpRead;
-    TcpWrite m_oTcpWrite;
+    NetWork * m_poNetWork;
+    //accepted fds are spread over read loops, peers are hashed to write loops.
+    TcpAcceptor m_oTcpAcceptor;
+    std::vector<TcpRead *> m_vecTcpRead;
+    std::vector<TcpWrite *> m_vecTcpWrite;
     bool m_bIsStarted;
 };
     
@@ -30,11 +30,8 @@ See the AUTHORS file for names of contributors.
 namespace phxpaxos
 {
 
-TcpAcceptor :: TcpAcceptor(
-        EventLoop * poEventLoop,
-        NetWork * poNetWork)
-    : m_poEventLoop(poEventLoop),
-    m_poNetWork(poNetWork)
+TcpAcceptor :: TcpAcceptor(NetWork * poNetWork)
+    : m_poNetWork(poNetWork)
 {
     m_bIsEnd = false;
     m_bIsStarted = false;
@@ -42,17 +39,28 @@ TcpAcceptor :: TcpAcceptor(
 
 TcpAcceptor :: ~TcpAcceptor()
 {
-    while (!m_oFDQueue.empty())
+    for (auto & oFDQueue : m_vecFDQueue)
     {
-        AcceptData * poData = m_oFDQueue.front();
-        m_oFDQueue.pop();
+        while (!oFDQueue.empty())
+        {
+            AcceptData * poData = oFDQueue.front();
+            oFDQueue.pop();
 
-        delete poData;
+            delete poData;
+        }
     }
 
     ClearEvent();
 }
 
+void TcpAcceptor :: AddEventLoop(EventLoop * poEventLoop)
+{
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+
+    m_vecEventLoop.push_back(poEventLoop);
+    m_vecFDQueue.push_back(std::queue<AcceptData *>());
+}
+
 void TcpAcceptor :: Listen(const std::string & sListenIP, const int iListenPort)
 {
     m_oSocket.listen(SocketAddress(sListenIP, (unsigned short)iListenPort));
@@ -109,7 +117,7 @@ void TcpAcceptor :: run()
                 poData->oAddr = oAddr;
                 
                 m_oMutex.lock();
-                m_oFDQueue.push(poData);
+                m_vecFDQueue[fd % m_vecFDQueue.size()].push(poData);
                 m_oMutex.unlock();
             }
         }
@@ -124,24 +132,31 @@ void TcpAcceptor :: run()
     }
 }
 
-void TcpAcceptor :: CreateEvent()
+void TcpAcceptor :: CreateEvent(EventLoop * poEventLoop)
 {
     std::lock_guard<std::mutex> oLockGuard(m_oMutex);
 
-    if (m_oFDQueue.empty())
+    size_t iLoopIdx = 0;
+    while (iLoopIdx < m_vecEventLoop.size() && m_vecEventLoop[iLoopIdx] != poEventLoop)
+    {
+        iLoopIdx++;
+    }
+
+    if (iLoopIdx == m_vecEventLoop.size() || m_vecFDQueue[iLoopIdx].empty())
     {
         return;
     }
     
+    std::queue<AcceptData *> & oFDQueue = m_vecFDQueue[iLoopIdx];
     int iCreatePerTime = 200;
-    while ((!m_oFDQueue.empty()) && iCreatePerTime--)
+    while ((!oFDQueue.empty()) && iCreatePerTime--)
     {
-        AcceptData * poData = m_oFDQueue.front();
-        m_oFDQueue.pop();
+        AcceptData * poData = oFDQueue.front();
+        oFDQueue.pop();
 
         //create event for this fd
         MessageEvent * poMessageEvent = new MessageEvent(MessageEventType_RECV, poData->fd, 
-                poData->oAddr, m_poEventLoop, m_poNetWork);
+                poData->oAddr, poEventLoop, m_poNetWork);
         poMessageEvent->AddEvent(EPOLLIN);
 
         m_vecCreatedEvent.push_back(poMessageEvent);
@@ -34,24 +34,25 @@ class NetWork;
 class TcpAcceptor : public Thread
 {
 public:
-    TcpAcceptor(
-            EventLoop * poEventLoop,
-            NetWork * poNetWork);
+    TcpAcceptor(NetWork * poNetWork);
     ~TcpAcceptor();
 
     void Listen(const std::string & sListenIP, const int iListenPort);
 
+    //call before start, accepted fds are spread over all added loops by fd.
+    void AddEventLoop(EventLoop * poEventLoop);
+
     void run();
 
     void Stop();
 
-    void CreateEvent();
+    void CreateEvent(EventLoop * poEventLoop);
 
     void ClearEvent();
 
 private:
     ServerSocket m_oSocket;
-    EventLoop * m_poEventLoop;
+    std::vector<EventLoop *> m_vecEventLoop;
     NetWork * m_poNetWork;
 
 private:
@@ -60,7 +61,8 @@ private:
         int fd;
         SocketAddress oAddr;
     };
-    std::queue<AcceptData *> m_oFDQueue;
+    //fd queue of each event loop.
+    std::vector<std::queue<AcceptData *> > m_vecFDQueue;
     std::mutex m_oMutex;
 
     std::vector<MessageEvent *> m_vecCreatedEvent;
@@ -40,7 +40,7 @@ TcpClient :: ~TcpClient()
     }
 }
 
-int TcpClient :: AddMessage(const std::string & sIP, const int iPort, const std::string & sMessage)
+int TcpClient :: AddMessage(const std::string & sIP, const int iPort, const SharedMessage & poMessage)
 {
     //PLImp("ok");
     MessageEvent * poEvent = GetEvent(sIP, iPort);
@@ -50,7 +50,7 @@ int TcpClient :: AddMessage(const std::string & sIP, const int iPort, const std:
         return -1;
     }
 
-    return poEvent->AddMessage(sMessage);
+    return poEvent->AddMessage(poMessage);
 }
 
 MessageEvent * TcpClient :: GetEvent(const std::string & sIP, const int iPort)
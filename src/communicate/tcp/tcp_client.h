@@ -41,7 +41,7 @@ public:
             NetWork * poNetWork);
     ~TcpClient();
 
-    int AddMessage(const std::string & sIP, const int iPort, const std::string & sMessage);
+    int AddMessage(const std::string & sIP, const int iPort, const SharedMessage & poMessage);
 
     void DealWithWrite();
 
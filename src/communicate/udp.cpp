@@ -87,11 +87,20 @@ void UDPRecv :: run()
 {
     m_bIsStarted = true;
 
-    char sBuffer[65536] = {0};
+    //receive ring, one slot for each datagram of a recvmmsg.
+    m_vecRecvBuffer.resize(UDP_RECV_BATCH_COUNT * UDP_MAX_DATAGRAM_SIZE);
 
-    struct sockaddr_in addr;
-    socklen_t addr_len = sizeof(struct sockaddr_in);
-    memset(&addr, 0, sizeof(addr));
+    struct mmsghdr arrMsgs[UDP_RECV_BATCH_COUNT];
+    struct iovec arrIovecs[UDP_RECV_BATCH_COUNT];
+    memset(arrMsgs, 0, sizeof(arrMsgs));
+
+    for (int i = 0; i < UDP_RECV_BATCH_COUNT; i++)
+    {
+        arrIovecs[i].iov_base = &m_vecRecvBuffer[i * UDP_MAX_DATAGRAM_SIZE];
+        arrIovecs[i].iov_len = UDP_MAX_DATAGRAM_SIZE;
+        arrMsgs[i].msg_hdr.msg_iov = &arrIovecs[i];
+        arrMsgs[i].msg_hdr.msg_iovlen = 1;
+    }
 
     while(true)
     {
@@ -113,17 +122,22 @@ void UDPRecv :: run()
             continue;
         }
         
-        int iRecvLen = recvfrom(m_iSockFD, sBuffer, sizeof(sBuffer), 0,
-                (struct sockaddr *)&addr, &addr_len);
-
-        //printf("recvlen %d, buffer %s client %s\n",
-                //iRecvLen, sBuffer, inet_ntoa(addr.sin_addr));
-        
-        BP->GetNetworkBP()->UDPReceive(iRecvLen);
+        int iRecvCount = recvmmsg(m_iSockFD, arrMsgs, UDP_RECV_BATCH_COUNT, MSG_DONTWAIT, nullptr);
+        if (iRecvCount < 0)
+        {
+            BP->GetNetworkBP()->UDPReceive(iRecvCount);
+            continue;
+        }
 
-        if (iRecvLen > 0)
+        for (int i = 0; i < iRecvCount; i++)
         {
-            m_poDFNetWork->OnReceiveMessage(sBuffer, iRecvLen);
+            int iRecvLen = (int)arrMsgs[i].msg_len;
+            BP->GetNetworkBP()->UDPReceive(iRecvLen);
+
+            if (iRecvLen > 0)
+            {
+                m_poDFNetWork->OnReceiveMessage((const char *)arrIovecs[i].iov_base, iRecvLen);
+            }
         }
     }
 }
@@ -163,20 +177,48 @@ void UDPSend :: Stop()
     }
 }
 
-void UDPSend :: SendMessage(const std::string & sIP, const int iPort, const std::string & sMessage)
+void UDPSend :: SendMessages(QueueData ** ppDataList, const int iCount)
 {
-    struct sockaddr_in addr;
-    int addr_len = sizeof(struct sockaddr_in);
-    memset(&addr, 0, sizeof(addr));
+    struct mmsghdr arrMsgs[UDP_SEND_BATCH_COUNT];
+    struct iovec arrIovecs[UDP_SEND_BATCH_COUNT];
+    struct sockaddr_in arrAddrs[UDP_SEND_BATCH_COUNT];
+    memset(arrMsgs, 0, sizeof(arrMsgs));
+    memset(arrAddrs, 0, sizeof(arrAddrs));
 
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(iPort);
-    addr.sin_addr.s_addr = inet_addr(sIP.c_str());
-    
-    int ret = sendto(m_iSockFD, sMessage.data(), (int)sMessage.size(), 0, (struct sockaddr *)&addr, addr_len);
-    if (ret > 0)
+    for (int i = 0; i < iCount; i++)
     {
-        BP->GetNetworkBP()->UDPRealSend(sMessage);
+        const QueueData * poData = ppDataList[i];
+
+        arrAddrs[i].sin_family = AF_INET;
+        arrAddrs[i].sin_port = htons(poData->m_iPort);
+        arrAddrs[i].sin_addr.s_addr = inet_addr(poData->m_sIP.c_str());
+
+        arrIovecs[i].iov_base = (void *)poData->m_poMessage->data();
+        arrIovecs[i].iov_len = poData->m_poMessage->size();
+
+        arrMsgs[i].msg_hdr.msg_name = &arrAddrs[i];
+        arrMsgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        arrMsgs[i].msg_hdr.msg_iov = &arrIovecs[i];
+        arrMsgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int iSendPos = 0;
+    while (iSendPos < iCount)
+    {
+        int ret = sendmmsg(m_iSockFD, arrMsgs + iSendPos, iCount - iSendPos, 0);
+        if (ret <= 0)
+        {
+            //drop the message failed, same as a failed sendto.
+            iSendPos++;
+            continue;
+        }
+
+        for (int i = iSendPos; i < iSendPos + ret; i++)
+        {
+            BP->GetNetworkBP()->UDPRealSend(*ppDataList[i]->m_poMessage);
+        }
+
+        iSendPos += ret;
     }
 }
 
@@ -187,21 +229,28 @@ void UDPSend :: run()
     while(true)
     {
         QueueData * poData = nullptr;
+        QueueData * arrDataList[UDP_SEND_BATCH_COUNT];
+        int iCount = 0;
 
+        //drain a batch in one lock, send them in one syscall.
         m_oSendQueue.lock();
 
         bool bSucc = m_oSendQueue.peek(poData, 1000);
         if (bSucc)
         {
-            m_oSendQueue.pop();
+            iCount = (int)m_oSendQueue.pop(arrDataList, UDP_SEND_BATCH_COUNT);
         }
 
         m_oSendQueue.unlock();
 
-        if (poData != nullptr)
+        if (iCount > 0)
         {
-            SendMessage(poData->m_sIP, poData->m_iPort, poData->m_sMessage);
-            delete poData;
+            SendMessages(arrDataList, iCount);
+
+            for (int i = 0; i < iCount; i++)
+            {
+                delete arrDataList[i];
+            }
         }
 
         if (m_bIsEnd)
@@ -212,7 +261,7 @@ void UDPSend :: run()
     }
 }
 
-int UDPSend :: AddMessage(const std::string & sIP, const int iPort, const std::string & sMessage)
+int UDPSend :: AddMessage(const std::string & sIP, const int iPort, const SharedMessage & poMessage)
 {
     m_oSendQueue.lock();
 
@@ -229,7 +278,7 @@ int UDPSend :: AddMessage(const std::string & sIP, const int iPort, const std::s
     QueueData * poData = new QueueData;
     poData->m_sIP = sIP;
     poData->m_iPort = iPort;
-    poData->m_sMessage = sMessage;
+    poData->m_poMessage = poMessage;
 
     m_oSendQueue.add(poData);
     m_oSendQueue.unlock();
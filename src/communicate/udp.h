@@ -22,10 +22,17 @@ See the AUTHORS file for names of contributors.
 #pragma once
 
 #include "utils_include.h"
+#include "phxpaxos/network.h"
+#include <vector>
 
 namespace phxpaxos 
 {
 
+//max datagrams in one sendmmsg/recvmmsg syscall.
+#define UDP_SEND_BATCH_COUNT 32
+#define UDP_RECV_BATCH_COUNT 16
+#define UDP_MAX_DATAGRAM_SIZE 65536
+
 class DFNetWork;
 
 class UDPRecv : public Thread
@@ -43,6 +50,7 @@ public:
 private:
     DFNetWork * m_poDFNetWork;
     int m_iSockFD;
+    std::vector<char> m_vecRecvBuffer;
     bool m_bIsEnd;
     bool m_bIsStarted;
 };
@@ -59,17 +67,17 @@ public:
 
     void Stop();
 
-    int AddMessage(const std::string & sIP, const int iPort, const std::string & sMessage);
+    int AddMessage(const std::string & sIP, const int iPort, const SharedMessage & poMessage);
 
     struct QueueData
     {
         std::string m_sIP;
         int m_iPort;
-        std::string m_sMessage;
+        SharedMessage m_poMessage;
     };
 
 private:
-    void SendMessage(const std::string & sIP, const int iPort, const std::string & sMessage);
+    void SendMessages(QueueData ** ppDataList, const int iCount);
 
 private:
     Queue<QueueData *> m_oSendQueue;
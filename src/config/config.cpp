@@ -41,12 +41,14 @@ Config :: Config(
     : m_bLogSync(bLogSync), 
     m_iSyncInterval(iSyncInterval),
     m_bUseMembership(bUseMembership),
+    m_bUseCompactPaxosMsg(false),
     m_iMyNodeID(oMyNode.GetNodeID()), 
     m_iNodeCount(vecNodeInfoList.size()), 
     m_iMyGroupIdx(iMyGroupIdx),
     m_iGroupCount(iGroupCount),
     m_oSystemVSM(iMyGroupIdx, oMyNode.GetNodeID(), poLogStorage, pMembershipChangeCallback),
-    m_poMasterSM(nullptr)
+    m_poMasterSM(nullptr),
+    m_oInstanceTrace(iMyGroupIdx)
 {
     m_vecNodeInfoList = vecNodeInfoList;
 
@@ -270,6 +272,21 @@ const int Config :: SyncInterval() const
     return m_iSyncInterval;
 }
 
+const bool Config :: UseCompactPaxosMsg() const
+{
+    return m_bUseCompactPaxosMsg;
+}
+
+void Config :: SetUseCompactPaxosMsg(const bool bUseCompactPaxosMsg)
+{
+    m_bUseCompactPaxosMsg = bUseCompactPaxosMsg;
+}
+
+InstanceTrace * Config :: GetInstanceTrace()
+{
+    return &m_oInstanceTrace;
+}
+
 }
 
 
@@ -24,6 +24,7 @@ See the AUTHORS file for names of contributors.
 #include <vector>
 #include "commdef.h"
 #include "system_v_sm.h"
+#include "instance_trace.h"
 
 namespace phxpaxos
 {
@@ -87,11 +88,18 @@ public:
 
     void SetLogSync(const bool bLogSync);
 
+    const bool UseCompactPaxosMsg() const;
+
+    void SetUseCompactPaxosMsg(const bool bUseCompactPaxosMsg);
+
 public:
     void SetMasterSM(InsideSM * poMasterSM);
 
     InsideSM * GetMasterSM();
 
+    //never null, closed unless Options::iInstanceTraceRingSize > 0.
+    InstanceTrace * GetInstanceTrace();
+
 public:
     void AddTmpNodeOnlyForLearn(const nodeid_t iTmpNodeID);
 
@@ -109,6 +117,7 @@ private:
     bool m_bLogSync;
     int m_iSyncInterval;
     bool m_bUseMembership;
+    bool m_bUseCompactPaxosMsg;
 
     nodeid_t m_iMyNodeID;
     int m_iNodeCount;
@@ -123,6 +132,8 @@ private:
     SystemVSM m_oSystemVSM;
     InsideSM * m_poMasterSM;
 
+    InstanceTrace m_oInstanceTrace;
+
     std::map<nodeid_t, uint64_t> m_mapTmpNodeOnlyForLearn;
     std::map<nodeid_t, uint64_t> m_mapMyFollower;
 };
@@ -20,6 +20,7 @@ See the AUTHORS file for names of contributors.
 */
 
 #include "db.h"
+#include "leveldb/write_batch.h"
 #include "commdef.h"
 #include "utils_include.h"
 
@@ -61,15 +62,18 @@ int PaxosComparator :: PCompare(const leveldb::Slice & a, const leveldb::Slice &
 
 ////////////////////////
 
-Database :: Database() : m_poLevelDB(nullptr), m_poValueStore(nullptr)
+Database :: Database() : m_poLevelDB(nullptr), m_poValueStore(nullptr), m_poLogIndex(nullptr)
 {
     m_bHasInit = false;
     m_iMyGroupIdx = -1;
+    m_bUseMmapRead = false;
+    m_bUseMemIndex = false;
 }
 
 Database :: ~Database()
 {
     delete m_poValueStore;
+    delete m_poLogIndex;
     delete m_poLevelDB;
 
     PLG1Head("LevelDB Deleted. Path %s", m_sDBPath.c_str());
@@ -101,6 +105,9 @@ int Database :: ClearAllLog()
     delete m_poValueStore;
     m_poValueStore = nullptr;
 
+    delete m_poLogIndex;
+    m_poLogIndex = nullptr;
+
     string sBakPath = m_sDBPath + ".bak";
 
     ret = FileUtils::DeleteDir(sBakPath);
@@ -113,7 +120,7 @@ int Database :: ClearAllLog()
     ret = rename(m_sDBPath.c_str(), sBakPath.c_str());
     assert(ret == 0);
 
-    ret = Init(m_sDBPath, m_iMyGroupIdx);
+    ret = Init(m_sDBPath, m_iMyGroupIdx, m_bUseMmapRead, m_bUseMemIndex);
     if (ret != 0)
     {
         PLG1Err("Init again fail, ret %d", ret);
@@ -145,7 +152,8 @@ int Database :: ClearAllLog()
     return 0;
 }
 
-int Database :: Init(const std::string & sDBPath, const int iMyGroupIdx)
+int Database :: Init(const std::string & sDBPath, const int iMyGroupIdx, 
+        const bool bUseMmapRead, const bool bUseMemIndex)
 {
     if (m_bHasInit)
     {
@@ -153,6 +161,8 @@ int Database :: Init(const std::string & sDBPath, const int iMyGroupIdx)
     }
 
     m_iMyGroupIdx = iMyGroupIdx;
+    m_bUseMmapRead = bUseMmapRead;
+    m_bUseMemIndex = bUseMemIndex;
 
     m_sDBPath = sDBPath;
     
@@ -170,10 +180,35 @@ int Database :: Init(const std::string & sDBPath, const int iMyGroupIdx)
         return -1;
     }
 
+    if (m_bUseMemIndex)
+    {
+        m_poLogIndex = new LogIndex();
+        assert(m_poLogIndex != nullptr);
+
+        bool bIsNew = false;
+        int ret = m_poLogIndex->Init(sDBPath, iMyGroupIdx, bIsNew);
+        if (ret != 0)
+        {
+            PLG1Err("log index init fail, ret %d", ret);
+            return -1;
+        }
+
+        //first time open index, leveldb may have old index.
+        if (bIsNew)
+        {
+            ret = ImportIndexFromLevelDB();
+            if (ret != 0)
+            {
+                PLG1Err("import index from leveldb fail, ret %d", ret);
+                return -1;
+            }
+        }
+    }
+
     m_poValueStore = new LogStore(); 
     assert(m_poValueStore != nullptr);
 
-    int ret = m_poValueStore->Init(sDBPath, iMyGroupIdx, (Database *)this);
+    int ret = m_poValueStore->Init(sDBPath, iMyGroupIdx, (Database *)this, m_bUseMmapRead);
     if (ret != 0)
     {
         PLG1Err("value store init fail, ret %d", ret);
@@ -207,21 +242,10 @@ int Database :: GetMaxInstanceIDFileID(std::string & sFileID, uint64_t & llInsta
         return 0;
     }
 
-    string sKey = GenKey(llMaxInstanceID);
-    
-    leveldb::Status oStatus = m_poLevelDB->Get(leveldb::ReadOptions(), sKey, &sFileID);
-    if (!oStatus.ok())
+    ret = GetFileID(llMaxInstanceID, sFileID);
+    if (ret != 0)
     {
-        if (oStatus.IsNotFound())
-        {
-            BP->GetLogStorageBP()->LevelDBGetNotExist();
-            //PLG1Err("LevelDB.Get not found %s", sKey.c_str());
-            return 1;
-        }
-        
-        BP->GetLogStorageBP()->LevelDBGetFail();
-        PLG1Err("LevelDB.Get fail");
-        return -1;
+        return ret;
     }
 
     llInstanceID = llMaxInstanceID;
@@ -231,6 +255,11 @@ int Database :: GetMaxInstanceIDFileID(std::string & sFileID, uint64_t & llInsta
 
 int Database :: RebuildOneIndex(const uint64_t llInstanceID, const std::string & sFileID)
 {
+    if (m_poLogIndex != nullptr)
+    {
+        return m_poLogIndex->Put(llInstanceID, sFileID);
+    }
+
     string sKey = GenKey(llInstanceID);
 
     leveldb::WriteOptions oLevelDBWriteOptions;
@@ -280,7 +309,7 @@ int Database :: Get(const uint64_t llInstanceID, std::string & sValue)
     }
 
     string sFileID;
-    int ret = GetFromLevelDB(llInstanceID, sFileID);
+    int ret = GetFileID(llInstanceID, sFileID);
     if (ret != 0)
     {
         return ret;
@@ -351,6 +380,83 @@ int Database :: PutToLevelDB(const bool bSync, const uint64_t llInstanceID, cons
     return 0;
 }
 
+//instance index go to LogIndex if open, special keys always in leveldb.
+int Database :: GetFileID(const uint64_t llInstanceID, std::string & sFileID)
+{
+    if (m_poLogIndex != nullptr && llInstanceID < MASTERVARIABLES_KEY)
+    {
+        return m_poLogIndex->Get(llInstanceID, sFileID);
+    }
+
+    return GetFromLevelDB(llInstanceID, sFileID);
+}
+
+int Database :: PutFileID(const bool bSync, const uint64_t llInstanceID, const std::string & sFileID)
+{
+    if (m_poLogIndex != nullptr && llInstanceID < MASTERVARIABLES_KEY)
+    {
+        //no need to sync, same as leveldb index, lost tail is rebuilt from vfile.
+        return m_poLogIndex->Put(llInstanceID, sFileID);
+    }
+
+    return PutToLevelDB(bSync, llInstanceID, sFileID);
+}
+
+int Database :: DelFileID(const bool bSync, const uint64_t llInstanceID)
+{
+    if (m_poLogIndex != nullptr && llInstanceID < MASTERVARIABLES_KEY)
+    {
+        return m_poLogIndex->Del(llInstanceID);
+    }
+
+    string sKey = GenKey(llInstanceID);
+
+    leveldb::WriteOptions oLevelDBWriteOptions;
+    oLevelDBWriteOptions.sync = bSync;
+    
+    leveldb::Status oStatus = m_poLevelDB->Delete(oLevelDBWriteOptions, sKey);
+    if (!oStatus.ok())
+    {
+        PLG1Err("LevelDB.Delete fail, instanceid %lu", llInstanceID);
+        return -1;
+    }
+
+    return 0;
+}
+
+int Database :: ImportIndexFromLevelDB()
+{
+    uint64_t llImportCount = 0;
+
+    leveldb::Iterator * it = m_poLevelDB->NewIterator(leveldb::ReadOptions());
+
+    for (it->SeekToFirst(); it->Valid(); it->Next())
+    {
+        uint64_t llInstanceID = GetInstanceIDFromKey(it->key().ToString());
+        if (llInstanceID == MINCHOSEN_KEY
+                || llInstanceID == SYSTEMVARIABLES_KEY
+                || llInstanceID == MASTERVARIABLES_KEY)
+        {
+            continue;
+        }
+
+        int ret = m_poLogIndex->Put(llInstanceID, it->value().ToString());
+        if (ret != 0)
+        {
+            delete it;
+            return ret;
+        }
+
+        llImportCount++;
+    }
+
+    delete it;
+
+    PLG1Head("ok, import count %lu", llImportCount);
+
+    return 0;
+}
+
 int Database :: Put(const WriteOptions & oWriteOptions, const uint64_t llInstanceID, const std::string & sValue)
 {
     if (!m_bHasInit)
@@ -371,12 +477,12 @@ int Database :: Put(const WriteOptions & oWriteOptions, const uint64_t llInstanc
     //04-23 : ѾlevelDBʵֻlevelDBдơ
     // дǳ٣ʵֵͨҲǳ٣ʵ
     // ֵ洢˳洢InstanceID˳ɾǳ㡣
-    ret = PutToLevelDB(false, llInstanceID, sFileID);
+    ret = PutFileID(false, llInstanceID, sFileID);
     
     return ret;
 }
 
-int Database :: ForceDel(const WriteOptions & oWriteOptions, const uint64_t llInstanceID)
+int Database :: BatchPut(const WriteOptions & oWriteOptions, const std::vector<std::pair<uint64_t, std::string> > & vecValues)
 {
     if (!m_bHasInit)
     {
@@ -384,42 +490,55 @@ int Database :: ForceDel(const WriteOptions & oWriteOptions, const uint64_t llIn
         return -1;
     }
 
-    string sKey = GenKey(llInstanceID);
-    string sFileID;
-    
-    leveldb::Status oStatus = m_poLevelDB->Get(leveldb::ReadOptions(), sKey, &sFileID);
-    if (!oStatus.ok())
+    std::vector<std::string> vecFileID;
+    int ret = m_poValueStore->BatchAppend(oWriteOptions, vecValues, vecFileID);
+    if (ret != 0)
     {
-        if (oStatus.IsNotFound())
+        BP->GetLogStorageBP()->ValueToFileIDFail();
+        PLG1Err("fail, ret %d", ret);
+        return ret;
+    }
+
+    if (m_poLogIndex != nullptr)
+    {
+        for (size_t i = 0; i < vecValues.size(); i++)
         {
-            PLG1Debug("LevelDB.Get not found, instanceid %lu", llInstanceID);
-            return 0;
+            ret = PutFileID(false, vecValues[i].first, vecFileID[i]);
+            if (ret != 0)
+            {
+                return ret;
+            }
         }
-        
-        PLG1Err("LevelDB.Get fail, instanceid %lu", llInstanceID);
-        return -1;
+
+        return 0;
     }
 
-    int ret = m_poValueStore->ForceDel(sFileID, llInstanceID);
-    if (ret != 0)
+    //all index of this batch in one leveldb write.
+    leveldb::WriteBatch oBatch;
+    for (size_t i = 0; i < vecValues.size(); i++)
     {
-        return ret;
+        oBatch.Put(GenKey(vecValues[i].first), vecFileID[i]);
     }
 
     leveldb::WriteOptions oLevelDBWriteOptions;
-    oLevelDBWriteOptions.sync = oWriteOptions.bSync;
-    
-    oStatus = m_poLevelDB->Delete(oLevelDBWriteOptions, sKey);
+    oLevelDBWriteOptions.sync = false;
+
+    m_oTimeStat.Point();
+
+    leveldb::Status oStatus = m_poLevelDB->Write(oLevelDBWriteOptions, &oBatch);
     if (!oStatus.ok())
     {
-        PLG1Err("LevelDB.Delete fail, instanceid %lu", llInstanceID);
+        BP->GetLogStorageBP()->LevelDBPutFail();
+        PLG1Err("LevelDB.Write fail, count %zu", vecValues.size());
         return -1;
     }
 
+    BP->GetLogStorageBP()->LevelDBPutOK(m_oTimeStat.Point());
+
     return 0;
 }
 
-int Database :: Del(const WriteOptions & oWriteOptions, const uint64_t llInstanceID)
+int Database :: ForceDel(const WriteOptions & oWriteOptions, const uint64_t llInstanceID)
 {
     if (!m_bHasInit)
     {
@@ -427,39 +546,97 @@ int Database :: Del(const WriteOptions & oWriteOptions, const uint64_t llInstanc
         return -1;
     }
 
-    string sKey = GenKey(llInstanceID);
+    string sFileID;
+    int ret = GetFileID(llInstanceID, sFileID);
+    if (ret != 0)
+    {
+        return ret == 1 ? 0 : ret;
+    }
+
+    ret = m_poValueStore->ForceDel(sFileID, llInstanceID);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    return DelFileID(oWriteOptions.bSync, llInstanceID);
+}
+
+int Database :: Del(const WriteOptions & oWriteOptions, const uint64_t llInstanceID)
+{
+    if (!m_bHasInit)
+    {
+        PLG1Err("no init yet");
+        return -1;
+    }
 
     if (OtherUtils::FastRand() % 100 < 1)
     {
         //no need to del vfile every times.
         string sFileID;
-        leveldb::Status oStatus = m_poLevelDB->Get(leveldb::ReadOptions(), sKey, &sFileID);
-        if (!oStatus.ok())
+        int ret = GetFileID(llInstanceID, sFileID);
+        if (ret != 0)
         {
-            if (oStatus.IsNotFound())
-            {
-                PLG1Debug("LevelDB.Get not found, instanceid %lu", llInstanceID);
-                return 0;
-            }
-            
-            PLG1Err("LevelDB.Get fail, instanceid %lu", llInstanceID);
-            return -1;
+            return ret == 1 ? 0 : ret;
         }
 
-        int ret = m_poValueStore->Del(sFileID, llInstanceID);
+        ret = m_poValueStore->Del(sFileID, llInstanceID);
         if (ret != 0)
         {
             return ret;
         }
     }
 
+    return DelFileID(oWriteOptions.bSync, llInstanceID);
+}
+
+int Database :: DelRange(const WriteOptions & oWriteOptions, const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID)
+{
+    if (!m_bHasInit)
+    {
+        PLG1Err("no init yet");
+        return -1;
+    }
+
+    if (llBeginInstanceID >= llEndInstanceID)
+    {
+        return 0;
+    }
+
+    //vfiles before the one hold the last instance only hold deleted instances, unlink them.
+    string sFileID;
+    int ret = GetFileID(llEndInstanceID - 1, sFileID);
+    if (ret == 0)
+    {
+        ret = m_poValueStore->Del(sFileID, llEndInstanceID - 1);
+        if (ret != 0)
+        {
+            return ret;
+        }
+    }
+    else if (ret != 1)
+    {
+        return ret;
+    }
+
+    if (m_poLogIndex != nullptr)
+    {
+        return m_poLogIndex->DelRange(llBeginInstanceID, llEndInstanceID);
+    }
+
+    leveldb::WriteBatch oBatch;
+    for (uint64_t llInstanceID = llBeginInstanceID; llInstanceID < llEndInstanceID; llInstanceID++)
+    {
+        oBatch.Delete(GenKey(llInstanceID));
+    }
+
     leveldb::WriteOptions oLevelDBWriteOptions;
     oLevelDBWriteOptions.sync = oWriteOptions.bSync;
-    
-    leveldb::Status oStatus = m_poLevelDB->Delete(oLevelDBWriteOptions, sKey);
+
+    leveldb::Status oStatus = m_poLevelDB->Write(oLevelDBWriteOptions, &oBatch);
     if (!oStatus.ok())
     {
-        PLG1Err("LevelDB.Delete fail, instanceid %lu", llInstanceID);
+        PLG1Err("LevelDB.Write fail, instanceid [%lu, %lu)", llBeginInstanceID, llEndInstanceID);
         return -1;
     }
 
@@ -469,6 +646,11 @@ int Database :: Del(const WriteOptions & oWriteOptions, const uint64_t llInstanc
 //  log ѰѾ promise  accept  id ֵ
 int Database :: GetMaxInstanceID(uint64_t & llInstanceID)
 {
+    if (m_poLogIndex != nullptr)
+    {
+        return m_poLogIndex->GetMaxInstanceID(llInstanceID);
+    }
+
     llInstanceID = MINCHOSEN_KEY;
 
     leveldb::Iterator * it = m_poLevelDB->NewIterator(leveldb::ReadOptions());
@@ -624,7 +806,8 @@ MultiDatabase :: ~MultiDatabase()
     }
 }
 
-int MultiDatabase :: Init(const std::string & sDBPath, const int iGroupCount)
+int MultiDatabase :: Init(const std::string & sDBPath, const int iGroupCount, 
+        const bool bUseMmapRead, const bool bUseMemIndex)
 {
     if (access(sDBPath.c_str(), F_OK) == -1)
     {
@@ -654,13 +837,14 @@ int MultiDatabase :: Init(const std::string & sDBPath, const int iGroupCount)
         assert(poDB != nullptr);
         m_vecDBList.push_back(poDB);
 
-        if (poDB->Init(sGroupDBPath, iGroupIdx) != 0)
+        if (poDB->Init(sGroupDBPath, iGroupIdx, bUseMmapRead, bUseMemIndex) != 0)
         {
             return -1;
         }
     }
 
-    PLImp("OK, DBPath %s groupcount %d", sDBPath.c_str(), iGroupCount);
+    PLImp("OK, DBPath %s groupcount %d mmapread %d memindex %d", 
+            sDBPath.c_str(), iGroupCount, (int)bUseMmapRead, (int)bUseMemIndex);
 
     return 0;
 }
@@ -696,6 +880,17 @@ int MultiDatabase :: Put(const WriteOptions & oWriteOptions, const int iGroupIdx
     return m_vecDBList[iGroupIdx]->Put(oWriteOptions, llInstanceID, sValue);
 }
 
+int MultiDatabase :: BatchPut(const WriteOptions & oWriteOptions, const int iGroupIdx, 
+        const std::vector<std::pair<uint64_t, std::string> > & vecValues)
+{
+    if (iGroupIdx >= (int)m_vecDBList.size())
+    {
+        return -2;
+    }
+
+    return m_vecDBList[iGroupIdx]->BatchPut(oWriteOptions, vecValues);
+}
+
 int MultiDatabase :: Del(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llInstanceID)
 {
     if (iGroupIdx >= (int)m_vecDBList.size())
@@ -706,6 +901,17 @@ int MultiDatabase :: Del(const WriteOptions & oWriteOptions, const int iGroupIdx
     return m_vecDBList[iGroupIdx]->Del(oWriteOptions, llInstanceID);
 }
 
+int MultiDatabase :: DelRange(const WriteOptions & oWriteOptions, const int iGroupIdx, 
+        const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID)
+{
+    if (iGroupIdx >= (int)m_vecDBList.size())
+    {
+        return -2;
+    }
+    
+    return m_vecDBList[iGroupIdx]->DelRange(oWriteOptions, llBeginInstanceID, llEndInstanceID);
+}
+
 int MultiDatabase :: ForceDel(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llInstanceID)
 {
     if (iGroupIdx >= (int)m_vecDBList.size())
@@ -29,6 +29,7 @@ See the AUTHORS file for names of contributors.
 #include "comm_include.h"
 #include "phxpaxos/storage.h"
 #include "log_store.h"
+#include "log_index.h"
 
 namespace phxpaxos
 {
@@ -59,7 +60,8 @@ public:
     Database();
     ~Database();
 
-    int Init(const std::string & sDBPath, const int iMyGroupIdx);
+    int Init(const std::string & sDBPath, const int iMyGroupIdx, 
+            const bool bUseMmapRead = false, const bool bUseMemIndex = false);
 
     const std::string GetDBPath();
 
@@ -69,8 +71,12 @@ public:
 
     int Put(const WriteOptions & oWriteOptions, const uint64_t llInstanceID, const std::string & sValue);
 
+    int BatchPut(const WriteOptions & oWriteOptions, const std::vector<std::pair<uint64_t, std::string> > & vecValues);
+
     int Del(const WriteOptions & oWriteOptions, const uint64_t llInstanceID);
 
+    int DelRange(const WriteOptions & oWriteOptions, const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID);
+
     int ForceDel(const WriteOptions & oWriteOptions, const uint64_t llInstanceID);
 
     int GetMaxInstanceID(uint64_t & llInstanceID);
@@ -100,6 +106,14 @@ private:
     int GetFromLevelDB(const uint64_t llInstanceID, std::string & sValue);
 
     int PutToLevelDB(const bool bSync, const uint64_t llInstanceID, const std::string & sValue);
+
+    int GetFileID(const uint64_t llInstanceID, std::string & sFileID);
+
+    int PutFileID(const bool bSync, const uint64_t llInstanceID, const std::string & sFileID);
+
+    int DelFileID(const bool bSync, const uint64_t llInstanceID);
+
+    int ImportIndexFromLevelDB();
         
 private:
     std::string GenKey(const uint64_t llInstanceID);
@@ -113,6 +127,9 @@ public:
     bool m_bHasInit;
     
     LogStore * m_poValueStore;
+    bool m_bUseMmapRead;
+    bool m_bUseMemIndex;
+    LogIndex * m_poLogIndex;
     std::string m_sDBPath;
 
     int m_iMyGroupIdx;
@@ -129,7 +146,8 @@ public:
     MultiDatabase();
     ~MultiDatabase();
 
-    int Init(const std::string & sDBPath, const int iGroupCount);
+    int Init(const std::string & sDBPath, const int iGroupCount, 
+            const bool bUseMmapRead = false, const bool bUseMemIndex = false);
 
     const std::string GetLogStorageDirPath(const int iGroupIdx);
 
@@ -137,8 +155,14 @@ public:
 
     int Put(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llInstanceID, const std::string & sValue);
 
+    int BatchPut(const WriteOptions & oWriteOptions, const int iGroupIdx, 
+            const std::vector<std::pair<uint64_t, std::string> > & vecValues);
+
     int Del(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llInstanceID);
 
+    int DelRange(const WriteOptions & oWriteOptions, const int iGroupIdx, 
+            const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID);
+
     int ForceDel(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llInstanceID);
 
     int GetMaxInstanceID(const int iGroupIdx, uint64_t & llInstanceID);
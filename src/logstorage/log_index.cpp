@@ -0,0 +1,576 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "log_index.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "comm_include.h"
+
+namespace phxpaxos
+{
+
+//fileid of a del record.
+static const char s_sDelFileID[FILEID_LEN] = {
+    (char)0xff, (char)0xff, (char)0xff, (char)0xff, (char)0xff, (char)0xff, 
+    (char)0xff, (char)0xff, (char)0xff, (char)0xff, (char)0xff, (char)0xff};
+
+LogIndex :: LogIndex()
+    : m_iFd(-1), m_iMyGroupIdx(-1), m_llBeginChunkIdx(0), 
+    m_llCount(0), m_llMaxInstanceID(0), m_llRecordCount(0), m_bIsCompacting(false)
+{
+}
+
+LogIndex :: ~LogIndex()
+{
+    for (auto & poChunk : m_dequeChunk)
+    {
+        delete poChunk;
+    }
+
+    if (m_iFd != -1)
+    {
+        close(m_iFd);
+    }
+}
+
+int LogIndex :: Init(const std::string & sPath, const int iMyGroupIdx, bool & bIsNew)
+{
+    m_iMyGroupIdx = iMyGroupIdx;
+    m_sFilePath = sPath + "/vindex";
+
+    bIsNew = access(m_sFilePath.c_str(), F_OK) == -1;
+
+    m_iFd = open(m_sFilePath.c_str(), O_CREAT | O_RDWR, S_IREAD | S_IWRITE);
+    if (m_iFd == -1)
+    {
+        PLG1Err("open index file fail, filepath %s errno %d", m_sFilePath.c_str(), errno);
+        return -1;
+    }
+
+    int ret = Load();
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    PLG1Head("ok, path %s new %d count %lu maxinstanceid %lu records %lu", 
+            m_sFilePath.c_str(), (int)bIsNew, m_llCount, m_llMaxInstanceID, m_llRecordCount);
+
+    return 0;
+}
+
+int LogIndex :: Load()
+{
+    off_t iFileLen = lseek(m_iFd, 0, SEEK_END);
+    if (iFileLen == -1)
+    {
+        return -1;
+    }
+
+    //crash may leave a half record at the end.
+    off_t iValidLen = iFileLen - iFileLen % LOG_INDEX_RECORD_LEN;
+    if (iValidLen != iFileLen)
+    {
+        PLG1Err("half record at the end, truncate, filelen %ld validlen %ld", (long)iFileLen, (long)iValidLen);
+        if (ftruncate(m_iFd, iValidLen) != 0)
+        {
+            return -1;
+        }
+    }
+
+    if (lseek(m_iFd, 0, SEEK_SET) == -1)
+    {
+        return -1;
+    }
+
+    BytesBuffer oBuffer;
+    off_t iLeftLen = iValidLen;
+    while (iLeftLen > 0)
+    {
+        int iReadLen = (int)std::min(iLeftLen, (off_t)(oBuffer.GetLen() - oBuffer.GetLen() % (int)LOG_INDEX_RECORD_LEN));
+        ssize_t iRealReadLen = read(m_iFd, oBuffer.GetPtr(), iReadLen);
+        if (iRealReadLen != iReadLen)
+        {
+            PLG1Err("read index file fail, readlen %zd expect %d errno %d", iRealReadLen, iReadLen, errno);
+            return -1;
+        }
+
+        for (int iPos = 0; iPos < iReadLen; iPos += LOG_INDEX_RECORD_LEN)
+        {
+            uint64_t llInstanceID = 0;
+            memcpy(&llInstanceID, oBuffer.GetPtr() + iPos, sizeof(uint64_t));
+            const char * pcFileID = oBuffer.GetPtr() + iPos + sizeof(uint64_t);
+
+            if (memcmp(pcFileID, s_sDelFileID, FILEID_LEN) == 0)
+            {
+                DelInMem(llInstanceID);
+            }
+            else
+            {
+                SetInMem(llInstanceID, pcFileID);
+            }
+        }
+
+        iLeftLen -= iReadLen;
+    }
+
+    m_llRecordCount = iValidLen / LOG_INDEX_RECORD_LEN;
+    ShrinkChunks();
+    FreshMaxInstanceID();
+
+    return 0;
+}
+
+int LogIndex :: Get(const uint64_t llInstanceID, std::string & sFileID)
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+
+    Chunk * poChunk = GetChunk(llInstanceID, false);
+    if (poChunk == nullptr || !poChunk->bExist[llInstanceID % LOG_INDEX_CHUNK_LEN])
+    {
+        return 1;
+    }
+
+    sFileID = std::string(poChunk->sFileID[llInstanceID % LOG_INDEX_CHUNK_LEN], FILEID_LEN);
+    return 0;
+}
+
+int LogIndex :: Put(const uint64_t llInstanceID, const std::string & sFileID)
+{
+    if (sFileID.size() != FILEID_LEN)
+    {
+        PLG1Err("fileid size %zu wrong", sFileID.size());
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+
+    int ret = AppendRecord(llInstanceID, sFileID.data());
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    SetInMem(llInstanceID, sFileID.data());
+
+    return 0;
+}
+
+int LogIndex :: Del(const uint64_t llInstanceID)
+{
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+
+    Chunk * poChunk = GetChunk(llInstanceID, false);
+    if (poChunk == nullptr || !poChunk->bExist[llInstanceID % LOG_INDEX_CHUNK_LEN])
+    {
+        return 0;
+    }
+
+    int ret = AppendRecord(llInstanceID, s_sDelFileID);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    DelInMem(llInstanceID);
+    ShrinkChunks();
+
+    oLock.unlock();
+
+    CompactIfNeed();
+
+    return 0;
+}
+
+int LogIndex :: DelRange(const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID)
+{
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+
+    std::string sRecords;
+    std::vector<uint64_t> vecDelInstanceID;
+    for (uint64_t llInstanceID = llBeginInstanceID; llInstanceID < llEndInstanceID; llInstanceID++)
+    {
+        Chunk * poChunk = GetChunk(llInstanceID, false);
+        if (poChunk == nullptr || !poChunk->bExist[llInstanceID % LOG_INDEX_CHUNK_LEN])
+        {
+            continue;
+        }
+
+        char sRecord[LOG_INDEX_RECORD_LEN] = {0};
+        memcpy(sRecord, &llInstanceID, sizeof(uint64_t));
+        memcpy(sRecord + sizeof(uint64_t), s_sDelFileID, FILEID_LEN);
+        sRecords.append(sRecord, sizeof(sRecord));
+
+        vecDelInstanceID.push_back(llInstanceID);
+    }
+
+    if (vecDelInstanceID.empty())
+    {
+        return 0;
+    }
+
+    ssize_t iWriteLen = write(m_iFd, sRecords.data(), sRecords.size());
+    if (iWriteLen != (ssize_t)sRecords.size())
+    {
+        PLG1Err("write index records fail, writelen %zd errno %d", iWriteLen, errno);
+        return -1;
+    }
+
+    m_llRecordCount += vecDelInstanceID.size();
+
+    for (auto & llInstanceID : vecDelInstanceID)
+    {
+        DelInMem(llInstanceID);
+    }
+    ShrinkChunks();
+
+    oLock.unlock();
+
+    CompactIfNeed();
+
+    return 0;
+}
+
+void LogIndex :: CompactIfNeed()
+{
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        if (m_bIsCompacting
+                || m_llRecordCount <= LOG_INDEX_COMPACT_MIN_RECORDS
+                || m_llRecordCount <= m_llCount * 2)
+        {
+            return;
+        }
+        m_bIsCompacting = true;
+    }
+
+    int ret = Compact();
+    if (ret != 0)
+    {
+        //index in memory and old file are still right, just try later.
+        PLG1Err("compact fail, ret %d", ret);
+    }
+
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    m_bIsCompacting = false;
+}
+
+int LogIndex :: GetMaxInstanceID(uint64_t & llInstanceID)
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+
+    if (m_llCount == 0)
+    {
+        return 1;
+    }
+
+    llInstanceID = m_llMaxInstanceID;
+    return 0;
+}
+
+const uint64_t LogIndex :: GetCount()
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    return m_llCount;
+}
+
+int LogIndex :: AppendRecord(const uint64_t llInstanceID, const char * pcFileID)
+{
+    char sRecord[LOG_INDEX_RECORD_LEN] = {0};
+    memcpy(sRecord, &llInstanceID, sizeof(uint64_t));
+    memcpy(sRecord + sizeof(uint64_t), pcFileID, FILEID_LEN);
+
+    //O_APPEND is not used, Load and Compact leave the offset at the end.
+    ssize_t iWriteLen = write(m_iFd, sRecord, sizeof(sRecord));
+    if (iWriteLen != (ssize_t)sizeof(sRecord))
+    {
+        PLG1Err("write index record fail, writelen %zd errno %d", iWriteLen, errno);
+        return -1;
+    }
+
+    m_llRecordCount++;
+    return 0;
+}
+
+int LogIndex :: Compact()
+{
+    std::string sTmpFilePath = m_sFilePath + ".tmp";
+    int iTmpFd = open(sTmpFilePath.c_str(), O_CREAT | O_RDWR | O_TRUNC, S_IREAD | S_IWRITE);
+    if (iTmpFd == -1)
+    {
+        PLG1Err("open tmp index file fail, filepath %s errno %d", sTmpFilePath.c_str(), errno);
+        return -1;
+    }
+
+    //records after this are copied again at swap, replay them over any newer state
+    //copied below gives the same result, as the last record of each instanceid wins.
+    uint64_t llFromRecordCount = 0;
+    uint64_t llChunkIdx = 0;
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        llFromRecordCount = m_llRecordCount;
+        llChunkIdx = m_llBeginChunkIdx;
+    }
+
+    uint64_t llCopyRecordCount = 0;
+    std::string sRecords;
+    while (CopyChunkRecords(llChunkIdx, sRecords))
+    {
+        if (!sRecords.empty() && write(iTmpFd, sRecords.data(), sRecords.size()) != (ssize_t)sRecords.size())
+        {
+            PLG1Err("write tmp index file fail, errno %d", errno);
+            close(iTmpFd);
+            return -1;
+        }
+
+        llCopyRecordCount += sRecords.size() / LOG_INDEX_RECORD_LEN;
+        llChunkIdx++;
+    }
+
+    //new file must be on disk before it replace the old one.
+    if (fsync(iTmpFd) != 0)
+    {
+        PLG1Err("fsync tmp index file fail, errno %d", errno);
+        close(iTmpFd);
+        return -1;
+    }
+
+    int ret = SwapCompactFile(iTmpFd, llFromRecordCount, llCopyRecordCount);
+    if (ret != 0)
+    {
+        close(iTmpFd);
+        return ret;
+    }
+
+    return 0;
+}
+
+bool LogIndex :: CopyChunkRecords(uint64_t & llChunkIdx, std::string & sRecords)
+{
+    sRecords.clear();
+
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+
+    if (llChunkIdx < m_llBeginChunkIdx)
+    {
+        llChunkIdx = m_llBeginChunkIdx;
+    }
+
+    if (llChunkIdx >= m_llBeginChunkIdx + m_dequeChunk.size())
+    {
+        return false;
+    }
+
+    Chunk * poChunk = m_dequeChunk[llChunkIdx - m_llBeginChunkIdx];
+    if (poChunk == nullptr)
+    {
+        return true;
+    }
+
+    sRecords.reserve(poChunk->iCount * LOG_INDEX_RECORD_LEN);
+    for (int j = 0; j < LOG_INDEX_CHUNK_LEN; j++)
+    {
+        if (!poChunk->bExist[j])
+        {
+            continue;
+        }
+
+        uint64_t llInstanceID = llChunkIdx * LOG_INDEX_CHUNK_LEN + j;
+        sRecords.append((const char *)&llInstanceID, sizeof(uint64_t));
+        sRecords.append(poChunk->sFileID[j], FILEID_LEN);
+    }
+
+    return true;
+}
+
+int LogIndex :: SwapCompactFile(const int iTmpFd, const uint64_t llFromRecordCount, const uint64_t llCopyRecordCount)
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+
+    //not synced, same as records appended to the old file.
+    uint64_t llTailRecordCount = m_llRecordCount - llFromRecordCount;
+    if (llTailRecordCount > 0)
+    {
+        std::string sTail(llTailRecordCount * LOG_INDEX_RECORD_LEN, '\0');
+        ssize_t iReadLen = pread(m_iFd, &sTail[0], sTail.size(), (off_t)(llFromRecordCount * LOG_INDEX_RECORD_LEN));
+        if (iReadLen != (ssize_t)sTail.size())
+        {
+            PLG1Err("read index file tail fail, readlen %zd expect %zu errno %d", iReadLen, sTail.size(), errno);
+            return -1;
+        }
+
+        if (write(iTmpFd, sTail.data(), sTail.size()) != (ssize_t)sTail.size())
+        {
+            PLG1Err("write tmp index file tail fail, errno %d", errno);
+            return -1;
+        }
+    }
+
+    std::string sTmpFilePath = m_sFilePath + ".tmp";
+    if (rename(sTmpFilePath.c_str(), m_sFilePath.c_str()) != 0)
+    {
+        PLG1Err("rename tmp index file fail, errno %d", errno);
+        return -1;
+    }
+
+    close(m_iFd);
+    m_iFd = iTmpFd;
+
+    PLG1Imp("ok, records %lu -> %lu, tail %lu", m_llRecordCount, llCopyRecordCount + llTailRecordCount, llTailRecordCount);
+    m_llRecordCount = llCopyRecordCount + llTailRecordCount;
+
+    return 0;
+}
+
+LogIndex::Chunk * LogIndex :: GetChunk(const uint64_t llInstanceID, const bool bCreate)
+{
+    uint64_t llChunkIdx = llInstanceID / LOG_INDEX_CHUNK_LEN;
+
+    if (m_dequeChunk.empty())
+    {
+        if (!bCreate)
+        {
+            return nullptr;
+        }
+
+        m_llBeginChunkIdx = llChunkIdx;
+        m_dequeChunk.push_back(nullptr);
+    }
+
+    if (llChunkIdx < m_llBeginChunkIdx)
+    {
+        if (!bCreate)
+        {
+            return nullptr;
+        }
+
+        m_dequeChunk.insert(m_dequeChunk.begin(), m_llBeginChunkIdx - llChunkIdx, nullptr);
+        m_llBeginChunkIdx = llChunkIdx;
+    }
+    else if (llChunkIdx >= m_llBeginChunkIdx + m_dequeChunk.size())
+    {
+        if (!bCreate)
+        {
+            return nullptr;
+        }
+
+        m_dequeChunk.resize(llChunkIdx - m_llBeginChunkIdx + 1, nullptr);
+    }
+
+    Chunk *& poChunk = m_dequeChunk[llChunkIdx - m_llBeginChunkIdx];
+    if (poChunk == nullptr && bCreate)
+    {
+        poChunk = new Chunk();
+        assert(poChunk != nullptr);
+        memset(poChunk->bExist, 0, sizeof(poChunk->bExist));
+        poChunk->iCount = 0;
+    }
+
+    return poChunk;
+}
+
+void LogIndex :: SetInMem(const uint64_t llInstanceID, const char * pcFileID)
+{
+    Chunk * poChunk = GetChunk(llInstanceID, true);
+    int iPos = llInstanceID % LOG_INDEX_CHUNK_LEN;
+
+    memcpy(poChunk->sFileID[iPos], pcFileID, FILEID_LEN);
+    if (!poChunk->bExist[iPos])
+    {
+        poChunk->bExist[iPos] = true;
+        poChunk->iCount++;
+        m_llCount++;
+    }
+
+    if (m_llCount == 1 || llInstanceID > m_llMaxInstanceID)
+    {
+        m_llMaxInstanceID = llInstanceID;
+    }
+}
+
+void LogIndex :: DelInMem(const uint64_t llInstanceID)
+{
+    Chunk * poChunk = GetChunk(llInstanceID, false);
+    int iPos = llInstanceID % LOG_INDEX_CHUNK_LEN;
+    if (poChunk == nullptr || !poChunk->bExist[iPos])
+    {
+        return;
+    }
+
+    poChunk->bExist[iPos] = false;
+    poChunk->iCount--;
+    m_llCount--;
+
+    if (poChunk->iCount == 0)
+    {
+        delete poChunk;
+        m_dequeChunk[llInstanceID / LOG_INDEX_CHUNK_LEN - m_llBeginChunkIdx] = nullptr;
+    }
+
+    if (llInstanceID == m_llMaxInstanceID)
+    {
+        FreshMaxInstanceID();
+    }
+}
+
+void LogIndex :: ShrinkChunks()
+{
+    while (!m_dequeChunk.empty() && m_dequeChunk.front() == nullptr)
+    {
+        m_dequeChunk.pop_front();
+        m_llBeginChunkIdx++;
+    }
+
+    while (!m_dequeChunk.empty() && m_dequeChunk.back() == nullptr)
+    {
+        m_dequeChunk.pop_back();
+    }
+}
+
+void LogIndex :: FreshMaxInstanceID()
+{
+    m_llMaxInstanceID = 0;
+
+    for (size_t i = m_dequeChunk.size(); i > 0; i--)
+    {
+        Chunk * poChunk = m_dequeChunk[i - 1];
+        if (poChunk == nullptr)
+        {
+            continue;
+        }
+
+        for (int j = LOG_INDEX_CHUNK_LEN - 1; j >= 0; j--)
+        {
+            if (poChunk->bExist[j])
+            {
+                m_llMaxInstanceID = (m_llBeginChunkIdx + i - 1) * LOG_INDEX_CHUNK_LEN + j;
+                return;
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,117 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#pragma once
+
+#include <string>
+#include <deque>
+#include <mutex>
+#include <inttypes.h>
+#include "log_store.h"
+
+namespace phxpaxos
+{
+
+#define LOG_INDEX_CHUNK_LEN 4096
+#define LOG_INDEX_RECORD_LEN (sizeof(uint64_t) + FILEID_LEN)
+#define LOG_INDEX_COMPACT_MIN_RECORDS 65536
+
+//Dense instanceid -> fileid index, replace leveldb for paxos log index.
+//InstanceIDs are almost continuous, so keep them in a chunked array in memory.
+//Every change is appended to a sidecar file as a fixed length record (no sync, vfile is the truth, 
+//tail lost by crash is rebuilt by LogStore::RebuildIndex), and the file is rewritten when most records are dead.
+//Rewrite copies live records chunk by chunk and fsync without the lock, records appended meanwhile
+//are copied after them, so readers and writers only wait for the final swap.
+class LogIndex
+{
+public:
+    LogIndex();
+    ~LogIndex();
+
+    //bIsNew is true if sidecar file not exist before.
+    int Init(const std::string & sPath, const int iMyGroupIdx, bool & bIsNew);
+
+    //return 1 if not exist.
+    int Get(const uint64_t llInstanceID, std::string & sFileID);
+
+    int Put(const uint64_t llInstanceID, const std::string & sFileID);
+
+    int Del(const uint64_t llInstanceID);
+
+    //delete [llBeginInstanceID, llEndInstanceID) with one write.
+    int DelRange(const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID);
+
+    //return 1 if empty.
+    int GetMaxInstanceID(uint64_t & llInstanceID);
+
+    const uint64_t GetCount();
+
+private:
+    struct Chunk
+    {
+        char sFileID[LOG_INDEX_CHUNK_LEN][FILEID_LEN];
+        bool bExist[LOG_INDEX_CHUNK_LEN];
+        int iCount;
+    };
+
+    int Load();
+
+    int AppendRecord(const uint64_t llInstanceID, const char * pcFileID);
+
+    int Compact();
+
+    //copy live records of chunk llChunkIdx, return false if no chunk from llChunkIdx on.
+    bool CopyChunkRecords(uint64_t & llChunkIdx, std::string & sRecords);
+
+    //copy records appended since llFromRecordCount to iTmpFd, then replace the file with it.
+    int SwapCompactFile(const int iTmpFd, const uint64_t llFromRecordCount, const uint64_t llCopyRecordCount);
+
+    //called without the lock.
+    void CompactIfNeed();
+
+    void SetInMem(const uint64_t llInstanceID, const char * pcFileID);
+
+    void DelInMem(const uint64_t llInstanceID);
+
+    Chunk * GetChunk(const uint64_t llInstanceID, const bool bCreate);
+
+    void ShrinkChunks();
+
+    void FreshMaxInstanceID();
+
+private:
+    std::string m_sFilePath;
+    int m_iFd;
+    int m_iMyGroupIdx;
+
+    std::deque<Chunk *> m_dequeChunk;
+    uint64_t m_llBeginChunkIdx;
+
+    uint64_t m_llCount;
+    uint64_t m_llMaxInstanceID;
+
+    uint64_t m_llRecordCount;
+    bool m_bIsCompacting;
+
+    std::mutex m_oMutex;
+};
+
+}
@@ -25,6 +25,7 @@ See the AUTHORS file for names of contributors.
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #include "crc32.h"
 #include "comm_include.h"
 #include "db.h"
@@ -42,6 +43,7 @@ LogStore :: LogStore()
     m_iMyGroupIdx = -1;
     m_iNowFileSize = -1;
     m_iNowFileOffset = 0;
+    m_bUseMmapRead = false;
 }
 
 LogStore :: ~LogStore()
@@ -57,9 +59,11 @@ LogStore :: ~LogStore()
     }
 }
 
-int LogStore :: Init(const std::string & sPath, const int iMyGroupIdx, Database * poDatabase)
+int LogStore :: Init(const std::string & sPath, const int iMyGroupIdx, Database * poDatabase, 
+        const bool bUseMmapRead)
 {
     m_iMyGroupIdx = iMyGroupIdx;
+    m_bUseMmapRead = bUseMmapRead;
     m_sPath = sPath + "/" + "vfile";
     if (access(m_sPath.c_str(), F_OK) == -1)
     {
@@ -281,6 +285,8 @@ int LogStore :: DeleteFile(const int iFileID)
         m_oFileLogger.Log("delete fileid %d", iDeleteFileID);
     }
 
+    RemoveMmapSegment(m_iDeletedMaxFileID);
+
     return ret;
 }
 
@@ -415,12 +421,102 @@ int LogStore :: Append(const WriteOptions & oWriteOptions, const uint64_t llInst
     return 0;
 }
 
+//same record layout as Append, but all records go to the file in one write and one sync.
+int LogStore :: BatchAppend(const WriteOptions & oWriteOptions, const std::vector<std::pair<uint64_t, std::string> > & vecValues, 
+        std::vector<std::string> & vecFileID)
+{
+    vecFileID.clear();
+    if (vecValues.empty())
+    {
+        return 0;
+    }
+
+    m_oTimeStat.Point();
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+
+    int iFd = -1;
+    int iFileID = -1;
+    int iOffset = -1;
+
+    int iTmpBufferLen = 0;
+    for (auto & oValue : vecValues)
+    {
+        iTmpBufferLen += sizeof(int) + sizeof(uint64_t) + oValue.second.size();
+    }
+
+    int ret = GetFileFD(iTmpBufferLen, iFd, iFileID, iOffset);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    m_oTmpAppendBuffer.Ready(iTmpBufferLen);
+
+    int iPos = 0;
+    for (auto & oValue : vecValues)
+    {
+        int iLen = sizeof(uint64_t) + oValue.second.size();
+        memcpy(m_oTmpAppendBuffer.GetPtr() + iPos, &iLen, sizeof(int));
+        memcpy(m_oTmpAppendBuffer.GetPtr() + iPos + sizeof(int), &oValue.first, sizeof(uint64_t));
+        memcpy(m_oTmpAppendBuffer.GetPtr() + iPos + sizeof(int) + sizeof(uint64_t), oValue.second.c_str(), oValue.second.size());
+        iPos += sizeof(int) + iLen;
+    }
+
+    size_t iWriteLen = write(iFd, m_oTmpAppendBuffer.GetPtr(), iTmpBufferLen);
+
+    if (iWriteLen != (size_t)iTmpBufferLen)
+    {
+        BP->GetLogStorageBP()->AppendDataFail();
+        PLG1Err("writelen %d not equal to %d, count %zu errno %d", 
+                iWriteLen, iTmpBufferLen, vecValues.size(), errno);
+        return -1;
+    }
+
+    if (oWriteOptions.bSync)
+    {
+        int fdatasync_ret = fdatasync(iFd);
+        if (fdatasync_ret == -1)
+        {
+            PLG1Err("fdatasync fail, writelen %zu errno %d", iWriteLen, errno);
+            return -1;
+        }
+    }
+
+    m_iNowFileOffset += iWriteLen;
+
+    int iUseTimeMs = m_oTimeStat.Point();
+    BP->GetLogStorageBP()->AppendDataOK(iWriteLen, iUseTimeMs);
+
+    iPos = 0;
+    for (auto & oValue : vecValues)
+    {
+        int iLen = sizeof(uint64_t) + oValue.second.size();
+        uint32_t iCheckSum = crc32(0, (const uint8_t*)(m_oTmpAppendBuffer.GetPtr() + iPos + sizeof(int)), iLen, CRC32SKIP);
+
+        std::string sFileID;
+        GenFileID(iFileID, iOffset + iPos, iCheckSum, sFileID);
+        vecFileID.push_back(sFileID);
+
+        iPos += sizeof(int) + iLen;
+    }
+
+    PLG1Imp("ok, offset %d fileid %d count %zu begin instanceid %lu writelen %zu usetime %dms sync %d",
+            iOffset, iFileID, vecValues.size(), vecValues.front().first, iWriteLen, iUseTimeMs, (int)oWriteOptions.bSync);
+
+    return 0;
+}
+
 int LogStore :: Read(const std::string & sFileID, uint64_t & llInstanceID, std::string & sBuffer)
 {
     int iFileID = -1;
     int iOffset = -1;
     uint32_t iCheckSum = 0;
     ParseFileID(sFileID, iFileID, iOffset, iCheckSum);
+
+    if (m_bUseMmapRead)
+    {
+        return ReadFromMmap(iFileID, iOffset, iCheckSum, llInstanceID, sBuffer);
+    }
     
     int iFd = -1;
     int ret = OpenFile(iFileID, iFd);
@@ -475,6 +571,133 @@ int LogStore :: Read(const std::string & sFileID, uint64_t & llInstanceID, std::
     return 0;
 }
 
+int LogStore :: ReadFromMmap(const int iFileID, const int iOffset, const uint32_t iCheckSum, 
+        uint64_t & llInstanceID, std::string & sBuffer)
+{
+    std::shared_ptr<LogMmapSegment> poSegment;
+    int ret = GetMmapSegment(iFileID, iOffset + (int)sizeof(int), poSegment);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    int iLen = 0;
+    memcpy(&iLen, poSegment->GetData() + iOffset, sizeof(int));
+
+    if (iLen < (int)sizeof(uint64_t) || iLen > poSegment->GetSize())
+    {
+        PLG1Err("data len wrong, fileid %d offset %d len %d filesize %d", 
+                iFileID, iOffset, iLen, poSegment->GetSize());
+        return -1;
+    }
+
+    ret = GetMmapSegment(iFileID, iOffset + (int)sizeof(int) + iLen, poSegment);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    const char * pcData = poSegment->GetData() + iOffset + sizeof(int);
+
+    uint32_t iFileCheckSum = crc32(0, (const uint8_t *)pcData, iLen, CRC32SKIP);
+
+    if (iFileCheckSum != iCheckSum)
+    {
+        BP->GetLogStorageBP()->GetFileChecksumNotEquel();
+        PLG1Err("checksum not equal, filechecksum %u checksum %u", iFileCheckSum, iCheckSum);
+        return -2;
+    }
+
+    memcpy(&llInstanceID, pcData, sizeof(uint64_t));
+    sBuffer = string(pcData + sizeof(uint64_t), iLen - sizeof(uint64_t));
+
+    PLG1Imp("ok, fileid %d offset %d instanceid %lu buffer size %zu", 
+            iFileID, iOffset, llInstanceID, sBuffer.size());
+
+    return 0;
+}
+
+int LogStore :: GetMmapSegment(const int iFileID, const int iNeedSize, std::shared_ptr<LogMmapSegment> & poSegment)
+{
+    std::lock_guard<std::mutex> oLock(m_oMmapMutex);
+
+    for (auto it = m_listMmapSegment.begin(); it != m_listMmapSegment.end(); it++)
+    {
+        if ((*it)->GetFileID() != iFileID)
+        {
+            continue;
+        }
+
+        if ((*it)->GetSize() >= iNeedSize)
+        {
+            poSegment = *it;
+            m_listMmapSegment.splice(m_listMmapSegment.begin(), m_listMmapSegment, it);
+            return 0;
+        }
+
+        //file grown after mapped, map again, readers still holding the old one keep it.
+        m_listMmapSegment.erase(it);
+        break;
+    }
+
+    int iFd = -1;
+    int ret = OpenFile(iFileID, iFd);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    int iFileSize = lseek(iFd, 0, SEEK_END);
+    if (iFileSize < iNeedSize)
+    {
+        close(iFd);
+        PLG1Err("file too small, fileid %d filesize %d needsize %d", iFileID, iFileSize, iNeedSize);
+        return -1;
+    }
+
+    void * pData = mmap(nullptr, iFileSize, PROT_READ, MAP_SHARED, iFd, 0);
+    close(iFd);
+
+    if (pData == MAP_FAILED)
+    {
+        PLG1Err("mmap fail, fileid %d filesize %d errno %d", iFileID, iFileSize, errno);
+        return -1;
+    }
+
+    poSegment = std::make_shared<LogMmapSegment>(iFileID, (char *)pData, iFileSize);
+    m_listMmapSegment.push_front(poSegment);
+    if ((int)m_listMmapSegment.size() > LOG_MMAP_SEGMENT_CACHE_SIZE)
+    {
+        m_listMmapSegment.pop_back();
+    }
+
+    m_oFileLogger.Log("mmap fileid %d filesize %d", iFileID, iFileSize);
+
+    return 0;
+}
+
+void LogStore :: RemoveMmapSegment(const int iMaxFileID)
+{
+    if (!m_bUseMmapRead)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> oLock(m_oMmapMutex);
+
+    for (auto it = m_listMmapSegment.begin(); it != m_listMmapSegment.end();)
+    {
+        if ((*it)->GetFileID() <= iMaxFileID)
+        {
+            it = m_listMmapSegment.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+}
+
 int LogStore :: Del(const std::string & sFileID, const uint64_t llInstanceID)
 {
     int iFileID = -1;
@@ -749,6 +972,33 @@ int LogStore :: RebuildIndexForOneFile(const int iFileID, const int iOffset,
 
 //////////////////////////////////////////////////////////
 
+LogMmapSegment :: LogMmapSegment(const int iFileID, char * pcData, const int iSize)
+    : m_iFileID(iFileID), m_pcData(pcData), m_iSize(iSize)
+{
+}
+
+LogMmapSegment :: ~LogMmapSegment()
+{
+    munmap(m_pcData, m_iSize);
+}
+
+const int LogMmapSegment :: GetFileID() const
+{
+    return m_iFileID;
+}
+
+const char * LogMmapSegment :: GetData() const
+{
+    return m_pcData;
+}
+
+const int LogMmapSegment :: GetSize() const
+{
+    return m_iSize;
+}
+
+//////////////////////////////////////////////////////////
+
 LogStoreLogger :: LogStoreLogger()
     : m_iLogFd(-1)
 {
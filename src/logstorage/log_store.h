@@ -22,7 +22,10 @@ See the AUTHORS file for names of contributors.
 #pragma once
 
 #include <string>
+#include <vector>
+#include <list>
 #include <mutex>
+#include <memory>
 #include "commdef.h"
 #include "utils_include.h"
 #include "commdef.h"
@@ -35,6 +38,9 @@ class Database;
 
 #define FILEID_LEN (sizeof(int) + sizeof(int) + sizeof(uint32_t))
 
+//mapped files kept by LogStore, least recently used one is unmapped first.
+#define LOG_MMAP_SEGMENT_CACHE_SIZE 16
+
 class LogStoreLogger
 {
 public:
@@ -48,16 +54,41 @@ private:
     int m_iLogFd;
 };
 
+//Read only mapping of one log file.
+//Readers hold it by shared_ptr, so it is unmapped only after the last reader leave,
+//even if the file is already deleted.
+class LogMmapSegment
+{
+public:
+    LogMmapSegment(const int iFileID, char * pcData, const int iSize);
+    ~LogMmapSegment();
+
+    const int GetFileID() const;
+
+    const char * GetData() const;
+
+    const int GetSize() const;
+
+private:
+    int m_iFileID;
+    char * m_pcData;
+    int m_iSize;
+};
+
 class LogStore
 {
 public:
     LogStore();
     ~LogStore();
 
-    int Init(const std::string & sPath, const int iMyGroupIdx, Database * poDatabase);
+    int Init(const std::string & sPath, const int iMyGroupIdx, Database * poDatabase, 
+            const bool bUseMmapRead = false);
 
     int Append(const WriteOptions & oWriteOptions, const uint64_t llInstanceID, const std::string & sBuffer, std::string & sFileID);
 
+    int BatchAppend(const WriteOptions & oWriteOptions, const std::vector<std::pair<uint64_t, std::string> > & vecValues, 
+            std::vector<std::string> & vecFileID);
+
     int Read(const std::string & sFileID, uint64_t & llInstanceID, std::string & sBuffer);
 
     int Del(const std::string & sFileID, const uint64_t llInstanceID);
@@ -89,6 +120,13 @@ private:
     int GetFileFD(const int iNeedWriteSize, int & iFd, int & iFileID, int & iOffset);
 
     int ExpandFile(int iFd, int & iFileSize);
+
+    int ReadFromMmap(const int iFileID, const int iOffset, const uint32_t iCheckSum, 
+            uint64_t & llInstanceID, std::string & sBuffer);
+
+    int GetMmapSegment(const int iFileID, const int iNeedSize, std::shared_ptr<LogMmapSegment> & poSegment);
+
+    void RemoveMmapSegment(const int iMaxFileID);
     
 private:
     int m_iFd;
@@ -107,6 +145,11 @@ private:
     int m_iNowFileSize;
     int m_iNowFileOffset;
 
+    bool m_bUseMmapRead;
+    //most recently used first, lookup by fileid, small enough to scan.
+    std::list<std::shared_ptr<LogMmapSegment> > m_listMmapSegment;
+    std::mutex m_oMmapMutex;
+
 private:
     TimeStat m_oTimeStat;
     LogStoreLogger m_oFileLogger;
@@ -103,6 +103,33 @@ int PaxosLog :: WriteState(const WriteOptions & oWriteOptions, const int iGroupI
     return 0;
 }
 
+int PaxosLog :: WriteStateBatch(const WriteOptions & oWriteOptions, const int iGroupIdx, const std::vector<AcceptorStateData> & vecState)
+{
+    const int m_iMyGroupIdx = iGroupIdx;
+
+    std::vector<std::pair<uint64_t, std::string> > vecValues(vecState.size());
+    for (size_t i = 0; i < vecState.size(); i++)
+    {
+        vecValues[i].first = vecState[i].instanceid();
+        bool sSucc = vecState[i].SerializeToString(&vecValues[i].second);
+        if (!sSucc)
+        {
+            PLG1Err("State.Serialize fail");
+            return -1;
+        }
+    }
+
+    int ret = m_poLogStorage->BatchPut(oWriteOptions, iGroupIdx, vecValues);
+    if (ret != 0)
+    {
+        PLG1Err("DB.BatchPut fail, groupidx %d count %zu ret %d", 
+                iGroupIdx, vecValues.size(), ret);
+        return ret;
+    }
+
+    return 0;
+}
+
 int PaxosLog :: ReadState(const int iGroupIdx, const uint64_t llInstanceID, AcceptorStateData & oState)
 {
     const int m_iMyGroupIdx = iGroupIdx;
@@ -44,6 +44,8 @@ public:
 
     int WriteState(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llInstanceID, const AcceptorStateData & oState);
 
+    int WriteStateBatch(const WriteOptions & oWriteOptions, const int iGroupIdx, const std::vector<AcceptorStateData> & vecState);
+
     int ReadState(const int iGroupIdx, const uint64_t llInstanceID, AcceptorStateData & oState);
 
 private:
@@ -66,6 +66,12 @@ void MasterMgr :: DropMaster()
 
 void MasterMgr :: StopMaster()
 {
+    if (IsOnScheduler())
+    {
+        StopOnScheduler();
+        return;
+    }
+
     if (m_bIsStarted)
     {
         m_bIsEnd = true;
@@ -73,9 +79,12 @@ void MasterMgr :: StopMaster()
     }
 }
 
-void MasterMgr :: RunMaster()
+void MasterMgr :: RunMaster(JobScheduler * poScheduler)
 {
-    start();
+    if (poScheduler == nullptr || StartOnScheduler(poScheduler) != 0)
+    {
+        start();
+    }
 }
 
 void MasterMgr :: run()
@@ -88,31 +97,38 @@ void MasterMgr :: run()
         {
             return;
         }
-        
-        int iLeaseTime = m_iLeaseTime;
 
-        uint64_t llBeginTime = Time::GetSteadyClockMS();
-        
-        TryBeMaster(iLeaseTime);
+        int iNeedSleepTime = RunSlice();
+        Time::MsSleep(iNeedSleepTime);
+    }
+}
 
-        int iContinueLeaseTimeout = (iLeaseTime - 100) / 4;
-        iContinueLeaseTimeout = iContinueLeaseTimeout / 2 + OtherUtils::FastRand() % iContinueLeaseTimeout;
+int MasterMgr :: RunSlice()
+{
+    int iLeaseTime = m_iLeaseTime;
 
-        if (m_bNeedDropMaster)
-        {
-            BP->GetMasterBP()->DropMaster();
-            m_bNeedDropMaster = false;
-            iContinueLeaseTimeout = iLeaseTime * 2;
-            PLG1Imp("Need drop master, this round wait time %dms", iContinueLeaseTimeout);
-        }
-        
-        uint64_t llEndTime = Time::GetSteadyClockMS();
-        int iRunTime = llEndTime > llBeginTime ? llEndTime - llBeginTime : 0;
-        int iNeedSleepTime = iContinueLeaseTimeout > iRunTime ? iContinueLeaseTimeout - iRunTime : 0;
+    uint64_t llBeginTime = Time::GetSteadyClockMS();
+    
+    TryBeMaster(iLeaseTime);
 
-        PLG1Imp("TryBeMaster, sleep time %dms", iNeedSleepTime);
-        Time::MsSleep(iNeedSleepTime);
+    int iContinueLeaseTimeout = (iLeaseTime - 100) / 4;
+    iContinueLeaseTimeout = iContinueLeaseTimeout / 2 + OtherUtils::FastRand() % iContinueLeaseTimeout;
+
+    if (m_bNeedDropMaster)
+    {
+        BP->GetMasterBP()->DropMaster();
+        m_bNeedDropMaster = false;
+        iContinueLeaseTimeout = iLeaseTime * 2;
+        PLG1Imp("Need drop master, this round wait time %dms", iContinueLeaseTimeout);
     }
+    
+    uint64_t llEndTime = Time::GetSteadyClockMS();
+    int iRunTime = llEndTime > llBeginTime ? llEndTime - llBeginTime : 0;
+    int iNeedSleepTime = iContinueLeaseTimeout > iRunTime ? iContinueLeaseTimeout - iRunTime : 0;
+
+    PLG1Imp("TryBeMaster, sleep time %dms", iNeedSleepTime);
+    //0 means work left for a job, wait at least 1ms.
+    return iNeedSleepTime > 0 ? iNeedSleepTime : 1;
 }
 
 void MasterMgr :: TryBeMaster(const int iLeaseTime)
@@ -154,7 +170,13 @@ void MasterMgr :: TryBeMaster(const int iLeaseTime)
     oCtx.m_iSMID = MASTER_V_SMID;
     oCtx.m_pCtx = (void *)&llAbsMasterTimeout;
 
-    int ret = m_poPaxosNode->Propose(m_iMyGroupIdx, sPaxosValue, llCommitInstanceID, &oCtx);
+    int ret = 0;
+    {
+        //propose waits for the commit, other jobs of the scheduler run meanwhile.
+        SchedulerBlockingGuard oBlockingGuard;
+        ret = m_poPaxosNode->Propose(m_iMyGroupIdx, sPaxosValue, llCommitInstanceID, &oCtx);
+    }
+
     if (ret != 0)
     {
         BP->GetMasterBP()->TryBeMasterProposeFail();
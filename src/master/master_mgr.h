@@ -25,17 +25,19 @@ See the AUTHORS file for names of contributors.
 #include "utils_include.h"
 #include "phxpaxos/node.h"
 #include "master_sm.h"
+#include "job_scheduler.h"
 
 namespace phxpaxos 
 {
 
-class MasterMgr : public Thread
+class MasterMgr : public Thread, public ScheduledJob
 {
 public:
     MasterMgr(const Node * poPaxosNode, const int iGroupIdx, const LogStorage * poLogStorage);
     ~MasterMgr();
 
-    void RunMaster();
+    //run on poScheduler if not null, otherwise on its own thread.
+    void RunMaster(JobScheduler * poScheduler = nullptr);
     
     void StopMaster();
 
@@ -43,6 +45,9 @@ public:
 
     void run();
 
+    //one try be master round, return ms until next round.
+    int RunSlice();
+
     void SetLeaseTime(const int iLeaseTimeMs);
 
     void TryBeMaster(const int iLeaseTime);
@@ -203,6 +203,16 @@ const bool MasterStateMachine :: IsIMMaster() const
     return iMasterNodeID == m_iMyNodeID;
 }
 
+//lease start before propose on master, other nodes start it after execute,
+//so no one else can be master before it expire.
+const bool MasterStateMachine :: IsIMMasterInLease(const int iLeaseMarginMs)
+{
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+
+    return m_iMasterNodeID == m_iMyNodeID
+        && Time::GetSteadyClockMS() + iLeaseMarginMs < m_llAbsExpireTime;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 bool MasterStateMachine :: Execute(const int iGroupIdx, const uint64_t llInstanceID, 
@@ -100,6 +100,8 @@ public:
 
     const bool IsIMMaster() const;
 
+    const bool IsIMMasterInLease(const int iLeaseMarginMs);
+
 public:
     int UpdateMasterToStore(const nodeid_t llMasterNodeID, const uint64_t llVersion, const uint32_t iLeaseTime);
 
@@ -38,6 +38,8 @@ Group :: Group(LogStorage * poLogStorage,
     m_iInitRet(-1), m_poThread(nullptr)
 {
     m_oConfig.SetMasterSM(poMasterSM);
+    m_oConfig.SetUseCompactPaxosMsg(oOptions.bUseCompactPaxosMsg);
+    m_oConfig.GetInstanceTrace()->Open(oOptions.iInstanceTraceRingSize);
 }
 
 Group :: ~Group()
@@ -73,9 +75,9 @@ int Group :: GetInitRet()
     return m_iInitRet;
 }
 
-void Group :: Start()
+void Group :: Start(JobScheduler * poScheduler)
 {
-    m_oInstance.Start();
+    m_oInstance.Start(poScheduler);
 }
 
 Config * Group :: GetConfig()
@@ -50,7 +50,7 @@ public:
 
     int GetInitRet();
 
-    void Start();
+    void Start(JobScheduler * poScheduler);
 
     Config * GetConfig();
 
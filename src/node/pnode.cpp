@@ -52,6 +52,9 @@ PNode :: ~PNode()
         delete poGroup;
     }
 
+    //all jobs removed, stop shared workers.
+    m_oJobScheduler.Stop();
+
     //5. step: delete master state machine.
     for (auto & poMaster : m_vecMasterList)
     {
@@ -80,7 +83,8 @@ int PNode :: InitLogStorage(const Options & oOptions, LogStorage *& poLogStorage
         return -2;
     }
 
-    int ret = m_oDefaultLogStorage.Init(oOptions.sLogStoragePath, oOptions.iGroupCount);
+    int ret = m_oDefaultLogStorage.Init(oOptions.sLogStoragePath, oOptions.iGroupCount,
+            oOptions.bUseLogMmapRead, oOptions.bUseLogMemIndex);
     if (ret != 0)
     {
         PLErr("Init default logstorage fail, logpath %s ret %d",
@@ -105,7 +109,7 @@ int PNode :: InitNetWork(const Options & oOptions, NetWork *& poNetWork)
     }
 
     // ûԶڣĬ硣
-    int ret = m_oDefaultNetWork.Init(oOptions.oMyNode.GetIP(), oOptions.oMyNode.GetPort());
+    int ret = m_oDefaultNetWork.Init(oOptions.oMyNode.GetIP(), oOptions.oMyNode.GetPort(), oOptions.iTcpIOThreadCount);
     if (ret != 0)
     {
         PLErr("init default network fail, listenip %s listenport %d ret %d",
@@ -155,6 +159,59 @@ int PNode :: CheckOptions(const Options & oOptions)
         PLErr("group count %d is small than zero or equal to zero", oOptions.iGroupCount);
         return -2;
     }
+
+    if (oOptions.iProposeWindowSize < 0 || oOptions.iProposeWindowSize > MAX_PROPOSE_WINDOW_SIZE)
+    {
+        PLErr("propose window size %d is invalid", oOptions.iProposeWindowSize);
+        return -2;
+    }
+
+    if (oOptions.iAsyncProposeQueueSize < 0)
+    {
+        PLErr("async propose queue size %d is invalid", oOptions.iAsyncProposeQueueSize);
+        return -2;
+    }
+
+    if (oOptions.iLearnBatchMaxSize < 0 || oOptions.iLearnBatchMaxSize > MAX_VALUE_SIZE / 2)
+    {
+        PLErr("learn batch max size %d is invalid", oOptions.iLearnBatchMaxSize);
+        return -2;
+    }
+
+    if (oOptions.iMaxApplyLag < 0)
+    {
+        PLErr("max apply lag %d is invalid", oOptions.iMaxApplyLag);
+        return -2;
+    }
+
+    if (oOptions.iTcpIOThreadCount < 1)
+    {
+        PLErr("tcp io thread count %d is invalid", oOptions.iTcpIOThreadCount);
+        return -2;
+    }
+
+    if (oOptions.iIOLoopThreadCount < 0)
+    {
+        PLErr("ioloop thread count %d is invalid", oOptions.iIOLoopThreadCount);
+        return -2;
+    }
+
+    if (oOptions.iInstanceTraceRingSize < 0 || oOptions.iInstanceTraceDumpThresholdMs < 0
+            || oOptions.iInstanceTraceDumpIntervalMs < 0)
+    {
+        PLErr("instance trace ring size %d or dump threshold %dms or dump interval %dms is invalid",
+                oOptions.iInstanceTraceRingSize, oOptions.iInstanceTraceDumpThresholdMs,
+                oOptions.iInstanceTraceDumpIntervalMs);
+        return -2;
+    }
+
+    if (oOptions.iInstanceTraceRingSize > 0 && oOptions.iInstanceTraceDumpThresholdMs > 0
+            && oOptions.sInstanceTraceDumpPath == "")
+    {
+        PLErr("instance trace dump threshold set but no dump path");
+        return -2;
+    }
+
     
     for (auto & oFollowerNodeInfo : oOptions.vecFollowerNodeInfoList)
     {
@@ -190,7 +247,7 @@ void PNode :: InitStateMachine(const Options & oOptions)
     }
 }
 
-void PNode :: RunMaster(const Options & oOptions)
+void PNode :: RunMaster(const Options & oOptions, JobScheduler * poScheduler)
 {
     for (auto & oGroupSMInfo : oOptions.vecGroupSMInfoList)
     {
@@ -199,7 +256,7 @@ void PNode :: RunMaster(const Options & oOptions)
         {
             if (!m_vecGroupList[oGroupSMInfo.iGroupIdx]->GetConfig()->IsIMFollower())
             {
-                m_vecMasterList[oGroupSMInfo.iGroupIdx]->RunMaster();
+                m_vecMasterList[oGroupSMInfo.iGroupIdx]->RunMaster(poScheduler);
             }
             else
             {
@@ -285,6 +342,7 @@ int PNode :: Init(const Options & oOptions, NetWork *& poNetWork)
         {
             ProposeBatch * poProposeBatch = new ProposeBatch(iGroupIdx, this, &m_oNotifierPool);
             assert(poProposeBatch != nullptr);
+            poProposeBatch->SetAdaptive(oOptions.bUseAdaptiveBatchPropose);
             m_vecProposeBatch.push_back(poProposeBatch);
         }
     }
@@ -318,13 +376,21 @@ int PNode :: Init(const Options & oOptions, NetWork *& poNetWork)
     //last step. must init ok, then should start threads.
     //because that stop threads is slower, if init fail, we need much time to stop many threads.
     //so we put start threads in the last step.
+    JobScheduler * poScheduler = nullptr;
+    if (oOptions.iIOLoopThreadCount > 0)
+    {
+        m_oJobScheduler.Start(oOptions.iIOLoopThreadCount, 
+                (int)m_vecGroupList.size() * SCHEDULER_MAX_JOB_PER_GROUP);
+        poScheduler = &m_oJobScheduler;
+    }
+
     for (auto & poGroup : m_vecGroupList)
     {
         //start group's thread first.
-        poGroup->Start();
+        poGroup->Start(poScheduler);
     }
     //  Options Ƿ master ѡ
-    RunMaster(oOptions);
+    RunMaster(oOptions, poScheduler);
     // ύ
     RunProposeBatch();
 
@@ -364,6 +430,16 @@ int PNode :: Propose(const int iGroupIdx, const std::string & sValue, uint64_t &
     return m_vecGroupList[iGroupIdx]->GetCommitter()->NewValueGetID(sValue, llInstanceID, poSMCtx);
 }
 
+int PNode :: ProposeAsync(const int iGroupIdx, const std::string & sValue, ProposeCallback pCallback, SMCtx * poSMCtx)
+{
+    if (!CheckGroupID(iGroupIdx))
+    {
+        return Paxos_GroupIdxWrong;
+    }
+
+    return m_vecGroupList[iGroupIdx]->GetCommitter()->NewValueAsync(sValue, poSMCtx, pCallback);
+}
+
 const uint64_t PNode :: GetNowInstanceID(const int iGroupIdx)
 {
     if (!CheckGroupID(iGroupIdx))
@@ -395,6 +471,29 @@ int PNode :: OnReceiveMessage(const char * pcMessage, const int iMessageLen)
     return m_vecGroupList[iGroupIdx]->GetInstance()->OnReceiveMessage(pcMessage, iMessageLen);
 }
 
+int PNode :: OnReceiveMessage(MsgBuffer * poBuffer)
+{
+    if (poBuffer->GetLen() < (int)GROUPIDXLEN)
+    {
+        PLErr("Message size %d to small, not valid.", poBuffer->GetLen());
+        MsgBufferPool::Instance()->Put(poBuffer);
+        return -2;
+    }
+    
+    int iGroupIdx = -1;
+
+    memcpy(&iGroupIdx, poBuffer->GetPtr(), GROUPIDXLEN);
+
+    if (!CheckGroupID(iGroupIdx))
+    {
+        PLErr("Message groupid %d wrong, groupsize %zu", iGroupIdx, m_vecGroupList.size());
+        MsgBufferPool::Instance()->Put(poBuffer);
+        return Paxos_GroupIdxWrong;
+    }
+
+    return m_vecGroupList[iGroupIdx]->GetInstance()->OnReceiveMessage(poBuffer);
+}
+
 void PNode :: AddStateMachine(StateMachine * poSM)
 {
     for (auto & poGroup : m_vecGroupList)
@@ -685,6 +784,45 @@ int PNode :: DropMaster(const int iGroupIdx)
     return 0;
 }
 
+int PNode :: ReadBarrier(const int iGroupIdx)
+{
+    if (!CheckGroupID(iGroupIdx))
+    {
+        return Paxos_GroupIdxWrong;
+    }
+
+    Instance * poInstance = m_vecGroupList[iGroupIdx]->GetInstance();
+    MasterStateMachine * poMasterSM = m_vecMasterList[iGroupIdx]->GetMasterSM();
+
+    if (poMasterSM->IsIMMasterInLease(MASTER_LEASE_READ_MARGIN_MS))
+    {
+        //all committed values are chosen on master, wait them executed.
+        //without applier WaitApplied return true at once, then this only guarantee
+        //values before llReadInstanceID are chosen, not that they are executed.
+        uint64_t llReadInstanceID = poInstance->GetNowInstanceID();
+        if (poInstance->WaitApplied(llReadInstanceID, MASTER_LEASE_READ_MARGIN_MS)
+                && poMasterSM->IsIMMasterInLease(MASTER_LEASE_READ_MARGIN_MS))
+        {
+            BP->GetMasterBP()->ReadByLease();
+            return 0;
+        }
+    }
+
+    //empty value is chosen after all committed values, and propose return after it executed.
+    BP->GetMasterBP()->ReadByReadIndex();
+
+    uint64_t llReadInstanceID = 0;
+    int ret = m_vecGroupList[iGroupIdx]->GetCommitter()->NewValueGetID(std::string(""), llReadInstanceID);
+    if (ret != 0)
+    {
+        BP->GetMasterBP()->ReadByReadIndexFail();
+        PLErr("read index propose fail, ret %d", ret);
+        return ret;
+    }
+
+    return 0;
+}
+
 /////////////////////////////////////////////////////////////////////
 
 void PNode :: SetMaxHoldThreads(const int iGroupIdx, const int iMaxHoldThreads)
@@ -717,6 +855,17 @@ void PNode :: SetLogSync(const int iGroupIdx, const bool bLogSync)
     m_vecGroupList[iGroupIdx]->GetConfig()->SetLogSync(bLogSync);
 }
 
+int PNode :: DumpInstanceTrace(const int iGroupIdx, std::string & sTraceJson)
+{
+    if (!CheckGroupID(iGroupIdx))
+    {
+        return Paxos_GroupIdxWrong;
+    }
+
+    m_vecGroupList[iGroupIdx]->GetConfig()->GetInstanceTrace()->Dump(sTraceJson);
+    return 0;
+}
+
 //////////////////////////////////////////////////////////////////////
 
 int PNode :: GetInstanceValue(const int iGroupIdx, const uint64_t llInstanceID, 
@@ -782,6 +931,22 @@ int PNode :: BatchPropose(const int iGroupIdx, const std::string & sValue,
     return m_vecProposeBatch[iGroupIdx]->Propose(sValue, llInstanceID, iBatchIndex, poSMCtx);
 }
 
+int PNode :: BatchProposeAsync(const int iGroupIdx, const std::string & sValue, 
+        ProposeCallback pCallback, SMCtx * poSMCtx)
+{
+    if (!CheckGroupID(iGroupIdx))
+    {
+        return Paxos_GroupIdxWrong;
+    }
+
+    if (m_vecProposeBatch.size() == 0)
+    {
+        return Paxos_SystemError;
+    }
+
+    return m_vecProposeBatch[iGroupIdx]->ProposeAsync(sValue, poSMCtx, pCallback);
+}
+
 void PNode :: SetBatchCount(const int iGroupIdx, const int iBatchCount)
 {
     if (!CheckGroupID(iGroupIdx))
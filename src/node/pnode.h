@@ -29,8 +29,12 @@ See the AUTHORS file for names of contributors.
 #include "group.h"
 #include "master_mgr.h"
 #include "propose_batch.h"
+#include "job_scheduler.h"
 #include "utils_include.h"
 
+//ioloop, applier, learner sender, replayer, cleaner and master.
+#define SCHEDULER_MAX_JOB_PER_GROUP 6
+
 namespace phxpaxos
 {
 
@@ -46,6 +50,7 @@ public:
 public:
     int Propose(const int iGroupIdx, const std::string & sValue, uint64_t & llInstanceID);
     int Propose(const int iGroupIdx, const std::string & sValue, uint64_t & llInstanceID, SMCtx * poSMCtx);
+    int ProposeAsync(const int iGroupIdx, const std::string & sValue, ProposeCallback pCallback, SMCtx * poSMCtx = nullptr);
     const uint64_t GetNowInstanceID(const int iGroupIdx);
 
 public:
@@ -54,6 +59,8 @@ public:
             uint64_t & llInstanceID, uint32_t & iBatchIndex);
     int BatchPropose(const int iGroupIdx, const std::string & sValue, 
             uint64_t & llInstanceID, uint32_t & iBatchIndex, SMCtx * poSMCtx);
+    int BatchProposeAsync(const int iGroupIdx, const std::string & sValue, 
+            ProposeCallback pCallback, SMCtx * poSMCtx = nullptr);
     void SetBatchCount(const int iGroupIdx, const int iBatchCount);
     void SetBatchDelayTimeMs(const int iGroupIdx, const int iBatchDelayTimeMs);
 
@@ -61,6 +68,7 @@ public:
     void AddStateMachine(StateMachine * poSM);
     void AddStateMachine(const int iGroupIdx, StateMachine * poSM);
     int OnReceiveMessage(const char * pcMessage, const int iMessageLen);
+    int OnReceiveMessage(MsgBuffer * poBuffer);
     const nodeid_t GetMyNodeID() const;
     void SetTimeoutMs(const int iTimeoutMs);
 
@@ -86,11 +94,15 @@ public:
     int SetMasterLease(const int iGroupIdx, const int iLeaseTimeMs);
     int DropMaster(const int iGroupIdx);
 
+    int ReadBarrier(const int iGroupIdx);
+
 public:
     void SetMaxHoldThreads(const int iGroupIdx, const int iMaxHoldThreads);
     void SetProposeWaitTimeThresholdMS(const int iGroupIdx, const int iWaitTimeThresholdMS);
     void SetLogSync(const int iGroupIdx, const bool bLogSync);
 
+    int DumpInstanceTrace(const int iGroupIdx, std::string & sTraceJson);
+
 public:
     int GetInstanceValue(const int iGroupIdx, const uint64_t llInstanceID,
             std::vector<std::pair<std::string, int> > & vecValues);
@@ -108,7 +120,7 @@ private:
             const NodeInfoList & vecNodeInfoList, 
             const uint64_t llVersion);
 
-    void RunMaster(const Options & oOptions);
+    void RunMaster(const Options & oOptions, JobScheduler * poScheduler);
     void RunProposeBatch();
 
 private:
@@ -119,6 +131,7 @@ private:
 private:
     MultiDatabase m_oDefaultLogStorage;
     DFNetWork m_oDefaultNetWork;
+    JobScheduler m_oJobScheduler;
     NotifierPool m_oNotifierPool;
 
     nodeid_t m_iMyNodeID;
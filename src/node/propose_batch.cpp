@@ -45,12 +45,24 @@ PendingProposal :: PendingProposal()
 {
 }
 
+//an async batch in paxos, live until its callback end.
+class AsyncProposeBatch
+{
+public:
+    std::vector<PendingProposal> vecRequest;
+    BatchSMCtx oBatchSMCtx;
+    SMCtx oCtx;
+    uint64_t llAbsProposeTime;
+};
+
 ////////////////////////////////////////////////////////////////////
 
 ProposeBatch :: ProposeBatch(const int iGroupIdx, Node * poPaxosNode, NotifierPool * poNotifierPool)
     : m_iMyGroupIdx(iGroupIdx), m_poPaxosNode(poPaxosNode), 
     m_poNotifierPool(poNotifierPool), m_bIsEnd(false), m_bIsStarted(false), m_iNowQueueValueSize(0),
     m_iBatchCount(5), m_iBatchDelayTimeMs(20), m_iBatchMaxSize(500 * 1024),
+    m_bIsAdaptive(false), m_iAdaptBatchCount(1), m_iAdaptBatchDelayTimeMs(0),
+    m_dArriveRate(0), m_dCommitTimeMs(0), m_iArriveCount(0), m_llArriveStartTime(0),
     m_poThread(nullptr)
 {
 }
@@ -89,6 +101,96 @@ void ProposeBatch :: SetBatchDelayTimeMs(const int iBatchDelayTimeMs)
     m_iBatchDelayTimeMs = iBatchDelayTimeMs;
 }
 
+void ProposeBatch :: SetAdaptive(const bool bIsAdaptive)
+{
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+    m_bIsAdaptive = bIsAdaptive;
+    m_llArriveStartTime = Time::GetSteadyClockMS();
+}
+
+const int ProposeBatch :: GetBatchCount() const
+{
+    return m_bIsAdaptive ? std::min(m_iAdaptBatchCount, m_iBatchCount) : m_iBatchCount;
+}
+
+const int ProposeBatch :: GetBatchDelayTimeMs() const
+{
+    return m_bIsAdaptive ? std::min(m_iAdaptBatchDelayTimeMs, m_iBatchDelayTimeMs) : m_iBatchDelayTimeMs;
+}
+
+//called with m_oMutex locked.
+void ProposeBatch :: OnArrive()
+{
+    if (!m_bIsAdaptive)
+    {
+        return;
+    }
+
+    m_iArriveCount++;
+
+    //batch thread may sleep long while queue empty, wake it up to count delay time from now.
+    if (m_oQueue.size() == 1)
+    {
+        m_oCond.notify_one();
+    }
+}
+
+void ProposeBatch :: OnBatchCommitEnd(const int iRet, const int iUseTimeMs)
+{
+    if (!m_bIsAdaptive || iRet != PaxosTryCommitRet_OK)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+
+    //smooth commit latency.
+    m_dCommitTimeMs = m_dCommitTimeMs > 0 ? 
+        m_dCommitTimeMs * 0.75 + iUseTimeMs * 0.25 : (double)iUseTimeMs;
+
+    Adapt();
+}
+
+//Proposals arrive while one batch is committing should go with the next batch,
+//so the batch count is arrive rate * commit latency (Little's law), and the delay time
+//is about the time to gather them. Low load get batch count 1 and propose at once,
+//burst load get a bigger batch, queue backlog is drained in one batch.
+//called with m_oMutex locked.
+void ProposeBatch :: Adapt()
+{
+    uint64_t llNowTime = Time::GetSteadyClockMS();
+    if (llNowTime > m_llArriveStartTime)
+    {
+        double dRate = (double)m_iArriveCount / (llNowTime - m_llArriveStartTime);
+        m_dArriveRate = m_dArriveRate * 0.75 + dRate * 0.25;
+
+        m_iArriveCount = 0;
+        m_llArriveStartTime = llNowTime;
+    }
+
+    int iBatchCount = (int)(m_dArriveRate * m_dCommitTimeMs + 0.5);
+    iBatchCount = std::max(iBatchCount, (int)m_oQueue.size());
+    iBatchCount = std::max(1, std::min(iBatchCount, m_iBatchCount));
+
+    int iBatchDelayTimeMs = 0;
+    if (iBatchCount > 1 && m_dArriveRate > 0)
+    {
+        iBatchDelayTimeMs = (int)(iBatchCount / m_dArriveRate);
+        iBatchDelayTimeMs = std::min(iBatchDelayTimeMs, m_iBatchDelayTimeMs);
+    }
+
+    if (iBatchCount != m_iAdaptBatchCount || iBatchDelayTimeMs != m_iAdaptBatchDelayTimeMs)
+    {
+        PLG1Debug("adapt batch count %d->%d delay %d->%dms, arrive rate %.3f/ms commit time %.1fms",
+                m_iAdaptBatchCount, iBatchCount, m_iAdaptBatchDelayTimeMs, iBatchDelayTimeMs,
+                m_dArriveRate, m_dCommitTimeMs);
+
+        m_iAdaptBatchCount = iBatchCount;
+        m_iAdaptBatchDelayTimeMs = iBatchDelayTimeMs;
+        BP->GetCommiterBP()->BatchProposeAdaptive(iBatchCount, iBatchDelayTimeMs);
+    }
+}
+
 int ProposeBatch :: Propose(const std::string & sValue, uint64_t & llInstanceID, uint32_t & iBatchIndex, SMCtx * poSMCtx)
 {
     if (m_bIsEnd)
@@ -124,9 +226,45 @@ int ProposeBatch :: Propose(const std::string & sValue, uint64_t & llInstanceID,
     return ret;
 }
 
+int ProposeBatch :: ProposeAsync(const std::string & sValue, SMCtx * poSMCtx, ProposeCallback pCallback)
+{
+    if (m_bIsEnd)
+    {
+        return Paxos_SystemError; 
+    }
+
+    if (pCallback == nullptr)
+    {
+        return Paxos_SystemError;
+    }
+
+    BP->GetCommiterBP()->BatchPropose();
+
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+
+    PendingProposal oPendingProposal;
+    oPendingProposal.poAsyncValue = std::make_shared<std::string>(sValue);
+    oPendingProposal.psValue = oPendingProposal.poAsyncValue.get();
+    oPendingProposal.poSMCtx = poSMCtx;
+    oPendingProposal.pCallback = pCallback;
+    oPendingProposal.llAbsEnqueueTime = Time::GetSteadyClockMS();
+
+    m_oQueue.push(oPendingProposal);
+    m_iNowQueueValueSize += (int)oPendingProposal.psValue->size();
+    OnArrive();
+
+    //never propose in caller thread, wake up batch thread instead.
+    if (NeedBatch())
+    {
+        m_oCond.notify_one();
+    }
+
+    return 0;
+}
+
 const bool ProposeBatch :: NeedBatch()
 {
-    if ((int)m_oQueue.size() >= m_iBatchCount
+    if ((int)m_oQueue.size() >= GetBatchCount()
             || m_iNowQueueValueSize >= m_iBatchMaxSize)
     {
         return true;
@@ -137,7 +275,8 @@ const bool ProposeBatch :: NeedBatch()
         uint64_t llNowTime = Time::GetSteadyClockMS();
         int iProposalPassTime = llNowTime > oPendingProposal.llAbsEnqueueTime ?
             llNowTime - oPendingProposal.llAbsEnqueueTime : 0;
-        if (iProposalPassTime > m_iBatchDelayTimeMs)
+        if (iProposalPassTime > GetBatchDelayTimeMs()
+                || (m_bIsAdaptive && GetBatchDelayTimeMs() == 0))
         {
             return true;
         }
@@ -161,6 +300,7 @@ void ProposeBatch :: AddProposal(const std::string & sValue, uint64_t & llInstan
 
     m_oQueue.push(oPendingProposal);
     m_iNowQueueValueSize += (int)oPendingProposal.psValue->size();
+    OnArrive();
 
     if (NeedBatch())
     {
@@ -198,13 +338,19 @@ void ProposeBatch :: Run()
         oLock.lock();
 
         int iPassTime = oTimeStat.Point();
-        int iNeedSleepTime = iPassTime < m_iBatchDelayTimeMs ?
-            m_iBatchDelayTimeMs - iPassTime : 0;
+        int iBatchDelayTimeMs = GetBatchDelayTimeMs();
+        int iNeedSleepTime = iPassTime < iBatchDelayTimeMs ?
+            iBatchDelayTimeMs - iPassTime : 0;
 
         if (NeedBatch())
         {
             iNeedSleepTime = 0;
         }
+        else if (m_bIsAdaptive && m_oQueue.empty())
+        {
+            //nothing to wait, sleep until proposal arrive.
+            iNeedSleepTime = m_iBatchDelayTimeMs;
+        }
 
         if (iNeedSleepTime > 0)
         {
@@ -219,7 +365,7 @@ void ProposeBatch :: Run()
     while (!m_oQueue.empty())
     {
         PendingProposal & oPendingProposal = m_oQueue.front();
-        oPendingProposal.poNotifier->SendNotify(Paxos_SystemError);
+        FinishProposal(oPendingProposal, Paxos_SystemError, (uint64_t)-1, 0);
         m_oQueue.pop();
     }
 
@@ -250,7 +396,7 @@ void ProposeBatch :: PluckProposal(std::vector<PendingProposal> & vecRequest)
 
         m_oQueue.pop();
 
-        if (iPluckCount >= m_iBatchCount
+        if (iPluckCount >= GetBatchCount()
                 || iPluckSize >= m_iBatchMaxSize)
         {
             break;
@@ -265,11 +411,106 @@ void ProposeBatch :: PluckProposal(std::vector<PendingProposal> & vecRequest)
 
 void ProposeBatch :: OnlyOnePropose(PendingProposal & oPendingProposal)
 {
+    TimeStat oTimeStat;
     int ret = m_poPaxosNode->Propose(m_iMyGroupIdx, *oPendingProposal.psValue,
             *oPendingProposal.pllInstanceID, oPendingProposal.poSMCtx);
+    OnBatchCommitEnd(ret, oTimeStat.Point());
     oPendingProposal.poNotifier->SendNotify(ret);
 }
 
+void ProposeBatch :: FinishProposal(PendingProposal & oPendingProposal, const int iRet, 
+        const uint64_t llInstanceID, const uint32_t iBatchIndex)
+{
+    if (oPendingProposal.pCallback == nullptr)
+    {
+        *oPendingProposal.piBatchIndex = iBatchIndex;
+        *oPendingProposal.pllInstanceID = llInstanceID; 
+        oPendingProposal.poNotifier->SendNotify(iRet);
+        return;
+    }
+
+    if (iRet == PaxosTryCommitRet_OK)
+    {
+        BP->GetCommiterBP()->BatchProposeOK();
+    }
+    else
+    {
+        BP->GetCommiterBP()->BatchProposeFail();
+    }
+
+    oPendingProposal.pCallback(iRet, llInstanceID, iBatchIndex);
+}
+
+//batch with async proposal use async propose too, so batch thread won't be blocked
+//and the next batch can wait in propose window.
+void ProposeBatch :: DoProposeAsync(std::vector<PendingProposal> & vecRequest)
+{
+    std::shared_ptr<AsyncProposeBatch> poBatch = std::make_shared<AsyncProposeBatch>();
+    poBatch->vecRequest.swap(vecRequest);
+    poBatch->llAbsProposeTime = Time::GetSteadyClockMS();
+
+    int ret = 0;
+    string sBuffer;
+    SMCtx * poCtx = nullptr;
+
+    if (poBatch->vecRequest.size() == 1)
+    {
+        sBuffer = *poBatch->vecRequest[0].psValue;
+        poCtx = poBatch->vecRequest[0].poSMCtx;
+    }
+    else
+    {
+        BatchPaxosValues oBatchValues;
+        for (auto & oPendingProposal : poBatch->vecRequest)
+        {
+            PaxosValue * poValue = oBatchValues.add_values();
+            poValue->set_smid(oPendingProposal.poSMCtx != nullptr ? oPendingProposal.poSMCtx->m_iSMID : 0);
+            poValue->set_value(*oPendingProposal.psValue);
+
+            poBatch->oBatchSMCtx.m_vecSMCtxList.push_back(oPendingProposal.poSMCtx);
+        }
+
+        poBatch->oCtx.m_iSMID = BATCH_PROPOSE_SMID;
+        poBatch->oCtx.m_pCtx = (void *)&poBatch->oBatchSMCtx;
+        poCtx = &poBatch->oCtx;
+
+        bool bSucc = oBatchValues.SerializeToString(&sBuffer);
+        if (!bSucc)
+        {
+            PLG1Err("BatchValues SerializeToString fail");
+            ret = Paxos_SystemError;
+        }
+    }
+
+    if (ret == 0)
+    {
+        ret = m_poPaxosNode->ProposeAsync(m_iMyGroupIdx, sBuffer, 
+                [this, poBatch](const int iRet, const uint64_t llInstanceID, const uint32_t iBatchIndex)
+                {
+                    uint64_t llNowTime = Time::GetSteadyClockMS();
+                    OnBatchCommitEnd(iRet, llNowTime > poBatch->llAbsProposeTime ? 
+                            (int)(llNowTime - poBatch->llAbsProposeTime) : 0);
+
+                    for (size_t i = 0; i < poBatch->vecRequest.size(); i++)
+                    {
+                        FinishProposal(poBatch->vecRequest[i], iRet, llInstanceID, (uint32_t)i);
+                    }
+                }, poCtx);
+        if (ret != 0)
+        {
+            PLG1Err("real propose async fail, ret %d", ret);
+        }
+    }
+
+    if (ret != 0)
+    {
+        for (auto & oPendingProposal : poBatch->vecRequest)
+        {
+            FinishProposal(oPendingProposal, ret, (uint64_t)-1, 0);
+        }
+    }
+}
+
 void ProposeBatch :: DoPropose(std::vector<PendingProposal> & vecRequest)
 {
     if (vecRequest.size() == 0)
@@ -279,6 +520,15 @@ void ProposeBatch :: DoPropose(std::vector<PendingProposal> & vecRequest)
 
     BP->GetCommiterBP()->BatchProposeDoPropose((int)vecRequest.size());
 
+    for (auto & oPendingProposal : vecRequest)
+    {
+        if (oPendingProposal.pCallback != nullptr)
+        {
+            DoProposeAsync(vecRequest);
+            return;
+        }
+    }
+
     if (vecRequest.size() == 1)
     {
         OnlyOnePropose(vecRequest[0]);
@@ -306,7 +556,9 @@ void ProposeBatch :: DoPropose(std::vector<PendingProposal> & vecRequest)
     bool bSucc = oBatchValues.SerializeToString(&sBuffer);
     if (bSucc)
     {
+        TimeStat oTimeStat;
         ret = m_poPaxosNode->Propose(m_iMyGroupIdx, sBuffer, llInstanceID, &oCtx);
+        OnBatchCommitEnd(ret, oTimeStat.Point());
         if (ret != 0)
         {
             PLG1Err("real propose fail, ret %d", ret);
@@ -320,10 +572,7 @@ void ProposeBatch :: DoPropose(std::vector<PendingProposal> & vecRequest)
 
     for (size_t i = 0; i < vecRequest.size(); i++)
     {
-        PendingProposal & oPendingProposal = vecRequest[i];
-        *oPendingProposal.piBatchIndex = (uint32_t)i;
-        *oPendingProposal.pllInstanceID = llInstanceID; 
-        oPendingProposal.poNotifier->SendNotify(ret);
+        FinishProposal(vecRequest[i], ret, llInstanceID, (uint32_t)i);
     }
 }
 
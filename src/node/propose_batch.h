@@ -28,6 +28,7 @@ See the AUTHORS file for names of contributors.
 #include <queue>
 #include <condition_variable>
 #include <thread>
+#include <memory>
 
 namespace phxpaxos
 {
@@ -46,6 +47,10 @@ public:
     //notify
     Notifier * poNotifier;
 
+    //async proposal own its value and get result by callback.
+    std::shared_ptr<std::string> poAsyncValue;
+    ProposeCallback pCallback;
+
     uint64_t llAbsEnqueueTime;
 };
 
@@ -65,9 +70,12 @@ public:
 
     int Propose(const std::string & sValue, uint64_t & llInstanceID, uint32_t & iBatchIndex, SMCtx * poSMCtx);
 
+    int ProposeAsync(const std::string & sValue, SMCtx * poSMCtx, ProposeCallback pCallback);
+
 public:
     void SetBatchCount(const int iBatchCount);
     void SetBatchDelayTimeMs(const int iBatchDelayTimeMs);
+    void SetAdaptive(const bool bIsAdaptive);
 
 protected:
     virtual void DoPropose(std::vector<PendingProposal> & vecRequest);
@@ -77,8 +85,18 @@ private:
             SMCtx * poSMCtx, Notifier * poNotifier);
     void PluckProposal(std::vector<PendingProposal> & vecRequest);
     void OnlyOnePropose(PendingProposal & oPendingProposal);
+    void DoProposeAsync(std::vector<PendingProposal> & vecRequest);
     const bool NeedBatch();
 
+    const int GetBatchCount() const;
+    const int GetBatchDelayTimeMs() const;
+    void OnArrive();
+    void OnBatchCommitEnd(const int iRet, const int iUseTimeMs);
+    void Adapt();
+
+    static void FinishProposal(PendingProposal & oPendingProposal, const int iRet, 
+            const uint64_t llInstanceID, const uint32_t iBatchIndex);
+
 private:
     const int m_iMyGroupIdx;
     Node * m_poPaxosNode;
@@ -96,6 +114,15 @@ private:
     int m_iBatchDelayTimeMs;
     int m_iBatchMaxSize;
 
+    //adaptive batch, protect by m_oMutex.
+    bool m_bIsAdaptive;
+    int m_iAdaptBatchCount;
+    int m_iAdaptBatchDelayTimeMs;
+    double m_dArriveRate;
+    double m_dCommitTimeMs;
+    int m_iArriveCount;
+    uint64_t m_llArriveStartTime;
+
     std::thread * m_poThread;
 };
 
@@ -0,0 +1,92 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include <string>
+#include "compact_paxos_msg.h"
+#include "commdef.h"
+#include "gmock/gmock.h"
+
+using namespace phxpaxos;
+using namespace std;
+
+TEST(CompactPaxosMsg, CanPack)
+{
+	PaxosMsg oPaxosMsg;
+	oPaxosMsg.set_msgtype(MsgType_PaxosAccept);
+	oPaxosMsg.set_instanceid(1);
+	EXPECT_TRUE(CompactPaxosMsg::CanPack(oPaxosMsg));
+
+	oPaxosMsg.set_flag(1);
+	EXPECT_FALSE(CompactPaxosMsg::CanPack(oPaxosMsg));
+
+	oPaxosMsg.Clear();
+	oPaxosMsg.set_msgtype(MsgType_PaxosLearner_SendLearnValue);
+	EXPECT_FALSE(CompactPaxosMsg::CanPack(oPaxosMsg));
+}
+
+TEST(CompactPaxosMsg, PackUnPack)
+{
+	PaxosMsg oPaxosMsg;
+	oPaxosMsg.set_msgtype(MsgType_PaxosPrepareReply);
+	oPaxosMsg.set_instanceid(123);
+	oPaxosMsg.set_nodeid(0x100000001);
+	oPaxosMsg.set_proposalid(7);
+	oPaxosMsg.set_preacceptid(6);
+	oPaxosMsg.set_preacceptnodeid(0x100000002);
+	oPaxosMsg.set_value(string("value\0with zero", 15));
+
+	string sBuffer;
+	CompactPaxosMsg::Pack(oPaxosMsg, sBuffer);
+
+	PaxosMsg oNewPaxosMsg;
+	EXPECT_TRUE(CompactPaxosMsg::UnPack(sBuffer.data(), sBuffer.size(), oNewPaxosMsg) == 0);
+	EXPECT_TRUE(oNewPaxosMsg.SerializeAsString() == oPaxosMsg.SerializeAsString());
+	EXPECT_FALSE(oNewPaxosMsg.has_rejectbypromiseid());
+	EXPECT_FALSE(oNewPaxosMsg.has_lastchecksum());
+
+	//empty value is still present.
+	oPaxosMsg.Clear();
+	oPaxosMsg.set_msgtype(MsgType_PaxosAccept);
+	oPaxosMsg.set_value("");
+	oPaxosMsg.set_lastchecksum(0);
+	sBuffer.clear();
+	CompactPaxosMsg::Pack(oPaxosMsg, sBuffer);
+	EXPECT_TRUE(CompactPaxosMsg::UnPack(sBuffer.data(), sBuffer.size(), oNewPaxosMsg) == 0);
+	EXPECT_TRUE(oNewPaxosMsg.has_value());
+	EXPECT_TRUE(oNewPaxosMsg.has_lastchecksum());
+	EXPECT_FALSE(oNewPaxosMsg.has_instanceid());
+}
+
+TEST(CompactPaxosMsg, UnPackBadLen)
+{
+	PaxosMsg oPaxosMsg;
+	oPaxosMsg.set_msgtype(MsgType_PaxosAccept);
+	oPaxosMsg.set_value("abc");
+
+	string sBuffer;
+	CompactPaxosMsg::Pack(oPaxosMsg, sBuffer);
+
+	PaxosMsg oNewPaxosMsg;
+	EXPECT_TRUE(CompactPaxosMsg::UnPack(sBuffer.data(), sBuffer.size() - 1, oNewPaxosMsg) != 0);
+	EXPECT_TRUE(CompactPaxosMsg::UnPack(sBuffer.data(), 10, oNewPaxosMsg) != 0);
+	sBuffer += "x";
+	EXPECT_TRUE(CompactPaxosMsg::UnPack(sBuffer.data(), sBuffer.size(), oNewPaxosMsg) != 0);
+}
@@ -0,0 +1,76 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include <string>
+#include <stdlib.h>
+#include "crc32.h"
+#include "gmock/gmock.h"
+
+using namespace std;
+
+//byte at a time version, checksum in logs and messages must never change.
+static uint32_t SimpleCrc32(uint32_t crc, const uint8_t * buf, int size, int skiplen)
+{
+	crc = crc ^ ~0U;
+	while (size > 0)
+	{
+		crc ^= *buf;
+		for (int i = 0; i < 8; i++)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+		}
+
+		size -= skiplen;
+		buf += skiplen;
+	}
+
+	return crc ^ ~0U;
+}
+
+TEST(Crc32, KnownValue)
+{
+	string sValue = "123456789";
+	EXPECT_TRUE(crc32(0, (const uint8_t *)sValue.data(), sValue.size()) == 0xCBF43926);
+}
+
+TEST(Crc32, SameAsSimple)
+{
+	string sBuffer;
+	for (int i = 0; i < 20000; i++)
+	{
+		sBuffer.push_back((char)rand());
+	}
+
+	for (int iSkipLen : {1, 7, 8})
+	{
+		for (int iLen = 0; iLen < 300; iLen++)
+		{
+			for (int iOffset = 0; iOffset < 3; iOffset++)
+			{
+				const uint8_t * pcBuffer = (const uint8_t *)sBuffer.data() + iOffset;
+				EXPECT_TRUE(crc32(iLen, pcBuffer, iLen, iSkipLen) == SimpleCrc32(iLen, pcBuffer, iLen, iSkipLen));
+			}
+		}
+
+		const uint8_t * pcBuffer = (const uint8_t *)sBuffer.data();
+		EXPECT_TRUE(crc32(1, pcBuffer, sBuffer.size(), iSkipLen) == SimpleCrc32(1, pcBuffer, sBuffer.size(), iSkipLen));
+	}
+}
@@ -53,7 +53,7 @@ int MakeLogStoragePath(std::string & sLogStoragePath)
     return 0;
 }
 
-int InitDB(const int iGroupCount, MultiDatabase & oDB)
+int InitDB(const int iGroupCount, MultiDatabase & oDB, const bool bUseMmapRead = false)
 {
 	string sDBPath;
     int ret = MakeLogStoragePath(sDBPath);
@@ -62,7 +62,7 @@ int InitDB(const int iGroupCount, MultiDatabase & oDB)
         return ret;
     }
 
-	ret = oDB.Init(sDBPath, iGroupCount);
+	ret = oDB.Init(sDBPath, iGroupCount, bUseMmapRead);
 	if (ret != 0)
 	{
 		return ret;
@@ -142,6 +142,75 @@ TEST(MultiDatabase, PUT_GET)
 	}
 }
 
+TEST(MultiDatabase, PUT_GET_MmapRead)
+{
+	int iGroupCount = 2;
+	MultiDatabase oDB;
+	ASSERT_TRUE(InitDB(iGroupCount, oDB, true) == 0);
+
+	std::string sValue = "hello paxos";
+	WriteOptions oWriteOptions;
+	oWriteOptions.bSync = true;
+
+	for (int iGroupIdx = 0; iGroupIdx < iGroupCount; iGroupIdx++)
+	{
+		for (uint64_t llInstanceID = 0; llInstanceID < 10; llInstanceID++)
+		{
+			ASSERT_TRUE(oDB.Put(oWriteOptions, iGroupIdx, llInstanceID, sValue + to_string(llInstanceID)) == 0);
+
+			//read the file while it is still being appended.
+			std::string sGetValue;
+			ASSERT_TRUE(oDB.Get(iGroupIdx, llInstanceID, sGetValue) == 0);
+			EXPECT_TRUE(sGetValue == sValue + to_string(llInstanceID));
+		}
+	}
+
+	for (int iGroupIdx = 0; iGroupIdx < iGroupCount; iGroupIdx++)
+	{
+		for (uint64_t llInstanceID = 0; llInstanceID < 10; llInstanceID++)
+		{
+			std::string sGetValue;
+			ASSERT_TRUE(oDB.Get(iGroupIdx, llInstanceID, sGetValue) == 0);
+			EXPECT_TRUE(sGetValue == sValue + to_string(llInstanceID));
+		}
+	}
+}
+
+TEST(MultiDatabase, BatchPut_GET)
+{
+	int iGroupCount = 2;
+	MultiDatabase oDB;
+	ASSERT_TRUE(InitDB(iGroupCount, oDB) == 0);
+
+	std::string sValue = "hello paxos";
+	WriteOptions oWriteOptions;
+	oWriteOptions.bSync = true;
+
+	for (int iGroupIdx = 0; iGroupIdx < iGroupCount; iGroupIdx++)
+	{
+		std::vector<std::pair<uint64_t, std::string> > vecValues;
+		for (uint64_t llInstanceID = 0; llInstanceID < 10; llInstanceID++)
+		{
+			vecValues.push_back(std::make_pair(llInstanceID, sValue + to_string(llInstanceID)));
+		}
+
+		ASSERT_TRUE(oDB.BatchPut(oWriteOptions, iGroupIdx, vecValues) == 0);
+	}
+
+	for (int iGroupIdx = 0; iGroupIdx < iGroupCount; iGroupIdx++)
+	{
+		for (uint64_t llInstanceID = 0; llInstanceID < 10; llInstanceID++)
+		{
+			std::string sGetValue;
+			ASSERT_TRUE(oDB.Get(iGroupIdx, llInstanceID, sGetValue) == 0);
+			EXPECT_TRUE(sGetValue == sValue + to_string(llInstanceID));
+		}
+
+		uint64_t llMaxInstanceID = 0;
+		ASSERT_TRUE(oDB.GetMaxInstanceID(iGroupIdx, llMaxInstanceID) == 0);
+		EXPECT_TRUE(llMaxInstanceID == 9);
+	}
+}
 
 TEST(MultiDatabase, Del)
 {
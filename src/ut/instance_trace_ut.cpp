@@ -0,0 +1,164 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include <string>
+#include <thread>
+#include <dirent.h>
+#include <unistd.h>
+#include "instance_trace.h"
+#include "utils_include.h"
+#include "gmock/gmock.h"
+
+using namespace phxpaxos;
+using namespace std;
+
+static int CountEvent(const string & sJson, const string & sName)
+{
+	int iCount = 0;
+	string sKey = "\"name\":\"" + sName + "\"";
+	size_t iPos = sJson.find(sKey);
+	while (iPos != string::npos)
+	{
+		iCount++;
+		iPos = sJson.find(sKey, iPos + 1);
+	}
+	return iCount;
+}
+
+TEST(InstanceTrace, Closed)
+{
+	InstanceTrace oTrace(0);
+	EXPECT_FALSE(oTrace.IsOpen());
+
+	oTrace.Add(TraceEvent_Prepare, 1, 100);
+
+	string sJson;
+	oTrace.Dump(sJson);
+	EXPECT_EQ(0, CountEvent(sJson, "Prepare"));
+	EXPECT_NE(string::npos, sJson.find("\"traceEvents\":[]"));
+}
+
+TEST(InstanceTrace, Dump)
+{
+	InstanceTrace oTrace(3);
+	oTrace.Open(16);
+	EXPECT_TRUE(oTrace.IsOpen());
+
+	oTrace.Add(TraceEvent_Prepare, 7, 100);
+	oTrace.Add(TraceEvent_Persist, 7, 0, 50);
+
+	string sJson;
+	oTrace.Dump(sJson);
+	EXPECT_NE(string::npos, sJson.find("\"name\":\"Prepare\",\"cat\":\"proposer\",\"ph\":\"i\""));
+	EXPECT_NE(string::npos, sJson.find("\"proposalid\":100"));
+	EXPECT_NE(string::npos, sJson.find("\"name\":\"Persist\",\"cat\":\"acceptor\",\"ph\":\"X\""));
+	EXPECT_NE(string::npos, sJson.find("\"dur\":50,\"pid\":3,\"tid\":7"));
+
+	oTrace.Dump(sJson, Time::GetSteadyClockUS() + 1000000);
+	EXPECT_EQ(0, CountEvent(sJson, "Prepare"));
+}
+
+TEST(InstanceTrace, RingOverwrite)
+{
+	InstanceTrace oTrace(0);
+	oTrace.Open(10);
+
+	for (uint64_t i = 0; i < 100; i++)
+	{
+		oTrace.Add(TraceEvent_Accept, i, i);
+	}
+
+	//ring size round up to 16, only the last 16 events left.
+	string sJson;
+	oTrace.Dump(sJson);
+	EXPECT_EQ(16, CountEvent(sJson, "Accept"));
+	EXPECT_EQ(string::npos, sJson.find("\"instanceid\":83,"));
+	EXPECT_NE(string::npos, sJson.find("\"instanceid\":84,"));
+	EXPECT_NE(string::npos, sJson.find("\"instanceid\":99,"));
+}
+
+TEST(InstanceTrace, DumpWhileAdd)
+{
+	InstanceTrace oTrace(0);
+	oTrace.Open(64);
+
+	std::thread oWriter([&oTrace]()
+	{
+		for (uint64_t i = 0; i < 200000; i++)
+		{
+			oTrace.Add(TraceEvent_OnAccept, i, i);
+		}
+	});
+
+	for (int i = 0; i < 100; i++)
+	{
+		string sJson;
+		oTrace.Dump(sJson);
+		EXPECT_LE(CountEvent(sJson, "OnAccept"), 64);
+		EXPECT_EQ("]", sJson.substr(sJson.find("],\"displayTimeUnit\""), 1));
+	}
+
+	oWriter.join();
+}
+
+
+TEST(InstanceTraceDumper, Dump)
+{
+	char sDumpPath[] = "/tmp/phxpaxos_trace_ut_XXXXXX";
+	ASSERT_TRUE(mkdtemp(sDumpPath) != nullptr);
+
+	string sJson = "{\"traceEvents\":[]}";
+	InstanceTraceDumper::Instance()->Dump(2, sDumpPath, 5, 100, sJson);
+	EXPECT_TRUE(sJson.empty());
+
+	//written by the dumper thread later.
+	string sPrefix = "trace_g2_i5_";
+	string sFilePath;
+	for (int i = 0; i < 100 && sFilePath.empty(); i++)
+	{
+		Time::MsSleep(10);
+
+		DIR * dir = opendir(sDumpPath);
+		ASSERT_TRUE(dir != nullptr);
+		struct dirent * ptr;
+		while ((ptr = readdir(dir)) != nullptr)
+		{
+			if (string(ptr->d_name).find(sPrefix) == 0)
+			{
+				sFilePath = string(sDumpPath) + "/" + ptr->d_name;
+			}
+		}
+		closedir(dir);
+	}
+
+	ASSERT_FALSE(sFilePath.empty());
+	Time::MsSleep(10);
+
+	FILE * fp = fopen(sFilePath.c_str(), "r");
+	ASSERT_TRUE(fp != nullptr);
+	char sBuf[64] = {0};
+	size_t iReadLen = fread(sBuf, 1, sizeof(sBuf) - 1, fp);
+	fclose(fp);
+	EXPECT_EQ("{\"traceEvents\":[]}", string(sBuf, iReadLen));
+
+	unlink(sFilePath.c_str());
+	rmdir(sDumpPath);
+}
@@ -0,0 +1,252 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include "gmock/gmock.h"
+#include "make_class.h"
+#include "mock_class.h"
+#include "phxpaxos/options.h"
+
+using namespace phxpaxos;
+using namespace std;
+using ::testing::_;
+using ::testing::Return;
+
+class InstanceBuilder
+{
+public:
+	InstanceBuilder(const Options & oOptions)
+	{
+		MakeConfig(&oMockLogStorage, poConfig);
+		MakeCommunicate(&oMockNetWork, poConfig, poCommunicate);
+		poInstance = new Instance(poConfig, &oMockLogStorage, poCommunicate, oOptions);
+
+		EXPECT_CALL(oMockLogStorage, Put(_,_,_,_)).WillRepeatedly(Return(0));
+		EXPECT_CALL(oMockNetWork, SendMessageUDP(_,_,_)).WillRepeatedly(Return(0));
+		EXPECT_CALL(oMockNetWork, SendMessageTCP(_,_,_)).WillRepeatedly(Return(0));
+	}
+
+	~InstanceBuilder()
+	{
+		delete poInstance;
+		delete poCommunicate;
+		delete poConfig;
+	}
+
+	MockNetWork oMockNetWork;
+	MockLogStorage oMockLogStorage;
+	Config * poConfig;
+	Communicate * poCommunicate;
+	Instance * poInstance;
+};
+
+class BlockStateMachine : public StateMachine
+{
+public:
+	BlockStateMachine() : bIsBlocking(true), iExecuteCount(0) { }
+
+	bool Execute(const int iGroupIdx, const uint64_t llInstanceID, 
+			const std::string & sPaxosValue, SMCtx * poSMCtx)
+	{
+		while (bIsBlocking)
+		{
+			Time::MsSleep(1);
+		}
+		iExecuteCount++;
+		return true;
+	}
+
+	const int SMID() const { return 1; }
+
+	std::atomic<bool> bIsBlocking;
+	std::atomic<int> iExecuteCount;
+};
+
+static void LearnOtherValue(Instance * poInstance, const uint64_t llInstanceID)
+{
+	NodeInfo oOtherNode("127.0.0.1", 11112);
+
+	int iSMID = 1;
+	string sValue((char *)&iSMID, sizeof(int));
+	sValue += "other value";
+
+	PaxosMsg oPaxosMsg;
+	oPaxosMsg.set_msgtype(MsgType_PaxosLearner_SendLearnValue);
+	oPaxosMsg.set_instanceid(llInstanceID);
+	oPaxosMsg.set_nodeid(oOtherNode.GetNodeID());
+	oPaxosMsg.set_proposalid(1);
+	oPaxosMsg.set_proposalnodeid(oOtherNode.GetNodeID());
+	oPaxosMsg.set_value(sValue);
+
+	poInstance->OnReceivePaxosMsg(oPaxosMsg);
+}
+
+TEST(Instance, ApplyLagFullNotBlockIOLoop)
+{
+	Options oOptions;
+	oOptions.iMaxApplyLag = 1;
+	InstanceBuilder ob(oOptions);
+
+	BlockStateMachine oSM;
+	ob.poInstance->AddStateMachine(&oSM);
+	//drive ioloop by hand, only start apply thread.
+	ob.poInstance->GetApplier()->Start(0);
+
+	//instance 0 block in execute, instance 1 wait in apply queue.
+	LearnOtherValue(ob.poInstance, 0);
+	Time::MsSleep(20);
+	LearnOtherValue(ob.poInstance, 1);
+	EXPECT_EQ(2u, ob.poInstance->GetNowInstanceID());
+
+	//lag full, instance 2 stay learned and ioloop return at once.
+	LearnOtherValue(ob.poInstance, 2);
+	EXPECT_EQ(2u, ob.poInstance->GetNowInstanceID());
+	EXPECT_FALSE(ob.poInstance->WaitApplied(1, 20));
+
+	//applier notify ioloop, instance 2 go on in its next loop.
+	oSM.bIsBlocking = false;
+	EXPECT_TRUE(ob.poInstance->WaitApplied(2, 1000));
+	ob.poInstance->CheckNewValue();
+	EXPECT_TRUE(ob.poInstance->WaitApplied(3, 1000));
+	EXPECT_EQ(3u, ob.poInstance->GetNowInstanceID());
+	EXPECT_EQ(3, oSM.iExecuteCount);
+}
+
+TEST(Instance, LearnOtherValueWithApplier)
+{
+	Options oOptions;
+	oOptions.iProposeWindowSize = 2;
+	oOptions.iMaxApplyLag = 4;
+	InstanceBuilder ob(oOptions);
+
+	int iCommitRet = -1;
+	int ret = ob.poInstance->GetCommitter()->NewValueAsync("my value", nullptr,
+			[&](const int iRet, const uint64_t llInstanceID, const uint32_t iBatchIndex)
+			{
+				iCommitRet = iRet;
+			});
+	EXPECT_EQ(0, ret);
+
+	//async commit retry 2 times on conflict, other node's value chosen every time.
+	NodeInfo oOtherNode("127.0.0.1", 11112);
+	for (uint64_t llInstanceID = 0; llInstanceID < 3; llInstanceID++)
+	{
+		EXPECT_EQ(-1, iCommitRet);
+
+		//start propose my value on this instance.
+		ob.poInstance->CheckNewValue();
+
+		PaxosMsg oPaxosMsg;
+		oPaxosMsg.set_msgtype(MsgType_PaxosLearner_SendLearnValue);
+		oPaxosMsg.set_instanceid(llInstanceID);
+		oPaxosMsg.set_nodeid(oOtherNode.GetNodeID());
+		oPaxosMsg.set_proposalid(1);
+		oPaxosMsg.set_proposalnodeid(oOtherNode.GetNodeID());
+		oPaxosMsg.set_value("other value");
+
+		ob.poInstance->OnReceivePaxosMsg(oPaxosMsg);
+
+		EXPECT_EQ(llInstanceID + 1, ob.poInstance->GetNowInstanceID());
+	}
+
+	EXPECT_EQ(PaxosTryCommitRet_Conflict, iCommitRet);
+}
+
+TEST(Instance, WindowCommitTimeoutInQueue)
+{
+	Options oOptions;
+	oOptions.iProposeWindowSize = 2;
+	InstanceBuilder ob(oOptions);
+
+	Committer * poCommitter = ob.poInstance->GetCommitter();
+	poCommitter->SetTimeoutMs(300);
+
+	int iRetA = -1;
+	std::thread oThreadA([&]()
+	{
+		uint64_t llInstanceID = 0;
+		iRetA = poCommitter->NewValueGetID("value a", llInstanceID);
+	});
+
+	//start value a on instance 0, it will never be chosen.
+	Time::MsSleep(50);
+	ob.poInstance->CheckNewValue();
+
+	//value b wait in window behind value a, must timeout by its own deadline.
+	int iRetB = -1;
+	uint64_t llBeginMs = Time::GetSteadyClockMS();
+	uint64_t llInstanceID = 0;
+	iRetB = poCommitter->NewValueGetID("value b", llInstanceID);
+	uint64_t llUseTimeMs = Time::GetSteadyClockMS() - llBeginMs;
+
+	EXPECT_EQ(PaxosTryCommitRet_Timeout, iRetB);
+	EXPECT_LT(llUseTimeMs, 1000u);
+
+	ob.poInstance->OnNewValueCommitTimeout();
+	oThreadA.join();
+	EXPECT_EQ(PaxosTryCommitRet_Timeout, iRetA);
+}
+
+TEST(Instance, AsyncCommitQueueBeyondWindow)
+{
+	Options oOptions;
+	oOptions.iProposeWindowSize = 1;
+	oOptions.iAsyncProposeQueueSize = 2;
+	InstanceBuilder ob(oOptions);
+
+	Committer * poCommitter = ob.poInstance->GetCommitter();
+
+	int vecRet[4] = {-1, -1, -1, -1};
+	auto NewValueAsync = [&](const int iIdx)
+	{
+		return poCommitter->NewValueAsync("my value", nullptr,
+				[&vecRet, iIdx](const int iRet, const uint64_t llInstanceID, const uint32_t iBatchIndex)
+				{
+					vecRet[iIdx] = iRet;
+				});
+	};
+
+	//value 0 take the window, value 1 queue without timeout.
+	EXPECT_EQ(0, NewValueAsync(0));
+	EXPECT_EQ(0, NewValueAsync(1));
+
+	//value 2 queue with a short timeout, queue is full after it.
+	poCommitter->SetTimeoutMs(50);
+	EXPECT_EQ(0, NewValueAsync(2));
+	EXPECT_EQ(PaxosTryCommitRet_TooManyThreadWaiting_Reject, NewValueAsync(3));
+
+	ob.poInstance->CheckNewValue();
+	ob.poInstance->OnNewValueCommitTimeout();
+	EXPECT_EQ(PaxosTryCommitRet_Timeout, vecRet[0]);
+	EXPECT_EQ(-1, vecRet[1]);
+
+	//window slot go to value 1 in order.
+	Time::MsSleep(100);
+	ob.poInstance->CheckNewValue();
+	ob.poInstance->OnNewValueCommitTimeout();
+	EXPECT_EQ(PaxosTryCommitRet_Timeout, vecRet[1]);
+
+	//value 2 expired in queue, end without start.
+	EXPECT_EQ(PaxosTryCommitRet_Timeout, vecRet[2]);
+	EXPECT_EQ(-1, vecRet[3]);
+}
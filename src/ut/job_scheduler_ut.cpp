@@ -0,0 +1,160 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "comm_include.h"
+#include "job_scheduler.h"
+#include <atomic>
+#include <functional>
+#include "gmock/gmock.h"
+
+using namespace phxpaxos;
+using namespace std;
+
+class BlockingJob : public ScheduledJob
+{
+public:
+	BlockingJob(std::atomic<bool> * pbOtherRun)
+		: m_pbOtherRun(pbOtherRun), m_bSawOtherRun(false), m_iRunCount(0)
+	{
+	}
+
+	int RunSlice()
+	{
+		m_iRunCount++;
+
+		//wait in a blocking region until the other job ran, as a slice waiting on fsync.
+		SchedulerBlockingGuard oBlockingGuard;
+		uint64_t llBeginTime = Time::GetSteadyClockMS();
+		while (!(*m_pbOtherRun) && Time::GetSteadyClockMS() < llBeginTime + 2000)
+		{
+			Time::MsSleep(1);
+		}
+
+		m_bSawOtherRun = m_pbOtherRun->load();
+		return 1000000;
+	}
+
+	std::atomic<bool> * m_pbOtherRun;
+	std::atomic<bool> m_bSawOtherRun;
+	std::atomic<int> m_iRunCount;
+};
+
+class CountJob : public ScheduledJob
+{
+public:
+	CountJob()
+		: m_iRunCount(0)
+	{
+	}
+
+	int RunSlice()
+	{
+		m_iRunCount++;
+		return 1000000;
+	}
+
+	std::atomic<int> m_iRunCount;
+};
+
+class RunFlagJob : public ScheduledJob
+{
+public:
+	RunFlagJob(std::atomic<bool> * pbRun)
+		: m_pbRun(pbRun)
+	{
+	}
+
+	int RunSlice()
+	{
+		*m_pbRun = true;
+		return 1000000;
+	}
+
+	std::atomic<bool> * m_pbRun;
+};
+
+static bool WaitUntil(std::function<bool()> oCond, const int iTimeoutMs)
+{
+	uint64_t llBeginTime = Time::GetSteadyClockMS();
+	while (!oCond())
+	{
+		if (Time::GetSteadyClockMS() >= llBeginTime + iTimeoutMs)
+		{
+			return false;
+		}
+		Time::MsSleep(1);
+	}
+
+	return true;
+}
+
+TEST(JobScheduler, BlockingSliceNotStarveOthers)
+{
+	JobScheduler oScheduler;
+	oScheduler.Start(1, 2);
+
+	std::atomic<bool> bOtherRun(false);
+	BlockingJob oBlockingJob(&bOtherRun);
+	RunFlagJob oFlagJob(&bOtherRun);
+
+	EXPECT_TRUE(oBlockingJob.StartOnScheduler(&oScheduler) == 0);
+	EXPECT_TRUE(WaitUntil([&]() { return oBlockingJob.m_iRunCount > 0; }, 1000));
+
+	//the only thread is inside the blocking slice, the other job must still run.
+	EXPECT_TRUE(oFlagJob.StartOnScheduler(&oScheduler) == 0);
+	EXPECT_TRUE(WaitUntil([&]() { return oBlockingJob.m_bSawOtherRun.load(); }, 3000));
+
+	oFlagJob.StopOnScheduler();
+	oBlockingJob.StopOnScheduler();
+	oScheduler.Stop();
+}
+
+TEST(JobScheduler, NotifyRunIdleJob)
+{
+	JobScheduler oScheduler;
+	oScheduler.Start(1, 1);
+
+	CountJob oJob;
+	EXPECT_TRUE(oJob.StartOnScheduler(&oScheduler) == 0);
+	EXPECT_TRUE(WaitUntil([&]() { return oJob.m_iRunCount == 1; }, 1000));
+
+	//job waits a long time after the first slice, notify runs it again at once.
+	oJob.NotifyScheduler();
+	EXPECT_TRUE(WaitUntil([&]() { return oJob.m_iRunCount == 2; }, 1000));
+
+	oJob.StopOnScheduler();
+	oScheduler.Stop();
+}
+
+TEST(JobScheduler, TooManyJobs)
+{
+	JobScheduler oScheduler;
+	oScheduler.Start(1, 1);
+
+	CountJob oJob1;
+	CountJob oJob2;
+	EXPECT_TRUE(oJob1.StartOnScheduler(&oScheduler) == 0);
+	EXPECT_TRUE(oJob2.StartOnScheduler(&oScheduler) == -1);
+	EXPECT_FALSE(oJob2.IsOnScheduler());
+
+	oJob1.StopOnScheduler();
+	oScheduler.Stop();
+}
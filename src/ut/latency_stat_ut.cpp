@@ -0,0 +1,104 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "phxpaxos/latency_stat.h"
+#include "gmock/gmock.h"
+
+using namespace phxpaxos;
+using namespace std;
+
+TEST(LatencyHistogram, ExactSmallValue)
+{
+	LatencyHistogram oHistogram;
+	for (uint64_t i = 1; i <= 10; i++)
+	{
+		oHistogram.Record(i);
+	}
+
+	LatencySnapshot oSnapshot;
+	oHistogram.Snapshot(oSnapshot);
+	EXPECT_EQ(10u, oSnapshot.llCount);
+	EXPECT_EQ(55u, oSnapshot.llSumUs);
+	EXPECT_EQ(5u, oSnapshot.llP50Us);
+	EXPECT_EQ(9u, oSnapshot.llP90Us);
+	EXPECT_EQ(10u, oSnapshot.llMaxUs);
+}
+
+TEST(LatencyHistogram, PercentileError)
+{
+	LatencyHistogram oHistogram;
+	for (uint64_t i = 1; i <= 100000; i++)
+	{
+		oHistogram.Record(i);
+	}
+
+	LatencySnapshot oSnapshot;
+	oHistogram.Snapshot(oSnapshot);
+	EXPECT_EQ(100000u, oSnapshot.llCount);
+	EXPECT_GE(oSnapshot.llP50Us, 50000u);
+	EXPECT_LE(oSnapshot.llP50Us, 50000u * 17 / 16);
+	EXPECT_GE(oSnapshot.llP99Us, 99000u);
+	EXPECT_LE(oSnapshot.llP99Us, 99000u * 17 / 16);
+	EXPECT_GE(oSnapshot.llMaxUs, 100000u);
+}
+
+TEST(LatencyHistogram, MergeAndReset)
+{
+	LatencyHistogram oHistogram1, oHistogram2;
+	oHistogram1.Record(3);
+	oHistogram2.Record(5);
+	oHistogram1.Merge(oHistogram2);
+
+	LatencySnapshot oSnapshot;
+	oHistogram1.Snapshot(oSnapshot);
+	EXPECT_EQ(2u, oSnapshot.llCount);
+	EXPECT_EQ(8u, oSnapshot.llSumUs);
+
+	oHistogram1.Reset();
+	oHistogram1.Snapshot(oSnapshot);
+	EXPECT_EQ(0u, oSnapshot.llCount);
+	EXPECT_EQ(0u, oSnapshot.llMaxUs);
+}
+
+TEST(LatencyStatBP, GroupAndStage)
+{
+	LatencyStatBP oStatBP(2);
+	oStatBP.StageUseTimeUs(0, LatencyStage_Prepare, 100);
+	oStatBP.StageUseTimeUs(1, LatencyStage_Prepare, 200);
+	oStatBP.StageUseTimeUs(1, LatencyStage_Accept, 300);
+	oStatBP.StageUseTimeUs(2, LatencyStage_Accept, 300);
+	oStatBP.StageUseTimeUs(0, LatencyStage_Max, 300);
+
+	LatencySnapshot oSnapshot;
+	EXPECT_EQ(0, oStatBP.GetSnapshot(1, LatencyStage_Prepare, oSnapshot));
+	EXPECT_EQ(1u, oSnapshot.llCount);
+
+	EXPECT_EQ(0, oStatBP.GetSnapshot(LatencyStage_Prepare, oSnapshot));
+	EXPECT_EQ(2u, oSnapshot.llCount);
+	EXPECT_EQ(300u, oSnapshot.llSumUs);
+
+	EXPECT_EQ(0, oStatBP.GetSnapshot(LatencyStage_Accept, oSnapshot));
+	EXPECT_EQ(1u, oSnapshot.llCount);
+
+	EXPECT_EQ(-2, oStatBP.GetSnapshot(2, LatencyStage_Prepare, oSnapshot));
+	EXPECT_EQ(-2, oStatBP.GetSnapshot(LatencyStage_Max, oSnapshot));
+}
+
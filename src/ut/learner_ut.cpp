@@ -0,0 +1,112 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include <string>
+#include "gmock/gmock.h"
+#include "make_class.h"
+#include "mock_class.h"
+#include "crc32.h"
+
+using namespace phxpaxos;
+using namespace std;
+using ::testing::_;
+using ::testing::Return;
+
+//states of [llBeginInstanceID, llBeginInstanceID + iCount) with a right checksum chain from iLastChecksum.
+static void MakeLearnStates(const uint64_t llBeginInstanceID, const int iCount, const uint32_t iLastChecksum,
+		google::protobuf::RepeatedPtrField<AcceptorStateData> & vecState)
+{
+	uint32_t iChecksum = iLastChecksum;
+	for (int i = 0; i < iCount; i++)
+	{
+		uint64_t llInstanceID = llBeginInstanceID + i;
+		string sValue = "value" + std::to_string(llInstanceID);
+		iChecksum = crc32(iChecksum, (const uint8_t *)sValue.data(), sValue.size(), CRC32SKIP);
+
+		AcceptorStateData * poState = vecState.Add();
+		poState->set_instanceid(llInstanceID);
+		poState->set_acceptedvalue(sValue);
+		poState->set_acceptedid(1);
+		poState->set_acceptednodeid(2);
+		poState->set_checksum(iChecksum);
+	}
+}
+
+TEST(LearnerState, LearnValueBatch_Partial)
+{
+	MockLogStorage oMockLogStorage;
+	Config * poConfig = nullptr;
+	MakeConfig(&oMockLogStorage, poConfig);
+
+	LearnerState oLearnerState(poConfig, &oMockLogStorage);
+
+	//0 is already learned and 3, 4 are missing, only 1 and 2 are learned.
+	google::protobuf::RepeatedPtrField<AcceptorStateData> vecState;
+	MakeLearnStates(0, 4, 0, vecState);
+	vecState.RemoveLast();
+	google::protobuf::RepeatedPtrField<AcceptorStateData> vecTail;
+	MakeLearnStates(5, 1, 0, vecTail);
+	vecState.MergeFrom(vecTail);
+
+	uint32_t iLastChecksum = vecState.Get(0).checksum();
+
+	EXPECT_CALL(oMockLogStorage, Put(_,_,_,_)).Times(2).WillRepeatedly(Return(0));
+
+	uint64_t llEndInstanceID = 0;
+	int ret = oLearnerState.LearnValueBatch(vecState, 1, iLastChecksum, llEndInstanceID);
+	EXPECT_EQ(0, ret);
+	EXPECT_EQ(3u, llEndInstanceID);
+
+	EXPECT_TRUE(oLearnerState.GetIsLearned());
+	EXPECT_EQ("value1", oLearnerState.GetLearnValue());
+	EXPECT_EQ(vecState.Get(1).checksum(), oLearnerState.GetNewChecksum());
+
+	//the rest of the batch is learned when instance move on, without write again.
+	oLearnerState.LearnNextValueInBatch(2);
+	EXPECT_EQ("value2", oLearnerState.GetLearnValue());
+	EXPECT_EQ(vecState.Get(2).checksum(), oLearnerState.GetNewChecksum());
+
+	delete poConfig;
+}
+
+TEST(LearnerState, LearnValueBatch_ChecksumNotSame)
+{
+	MockLogStorage oMockLogStorage;
+	Config * poConfig = nullptr;
+	MakeConfig(&oMockLogStorage, poConfig);
+
+	LearnerState oLearnerState(poConfig, &oMockLogStorage);
+
+	google::protobuf::RepeatedPtrField<AcceptorStateData> vecState;
+	MakeLearnStates(0, 3, 0, vecState);
+	vecState.Mutable(2)->set_checksum(vecState.Get(2).checksum() + 1);
+
+	//nothing of the batch is written if any checksum in it is wrong.
+	EXPECT_CALL(oMockLogStorage, Put(_,_,_,_)).Times(0);
+
+	uint64_t llEndInstanceID = 0;
+	int ret = oLearnerState.LearnValueBatch(vecState, 0, 0, llEndInstanceID);
+	EXPECT_EQ(-2, ret);
+	EXPECT_EQ(0u, llEndInstanceID);
+	EXPECT_FALSE(oLearnerState.GetIsLearned());
+
+	delete poConfig;
+}
@@ -0,0 +1,136 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include <string>
+#include <vector>
+#include "comm_include.h"
+#include "lock_free_queue.h"
+#include "gmock/gmock.h"
+
+using namespace phxpaxos;
+using namespace std;
+
+class QueueProducer : public Thread
+{
+public:
+	QueueProducer(LockFreeQueue<uint64_t> * poQueue, const uint64_t llBegin, const int iCount)
+		: m_poQueue(poQueue), m_llBegin(llBegin), m_iCount(iCount)
+	{
+	}
+
+	~QueueProducer() { }
+
+	void run()
+	{
+		for (int i = 0; i < m_iCount; i++)
+		{
+			while (!m_poQueue->Add(m_llBegin + i))
+			{
+				Time::MsSleep(1);
+			}
+		}
+	}
+
+private:
+	LockFreeQueue<uint64_t> * m_poQueue;
+	uint64_t m_llBegin;
+	int m_iCount;
+};
+
+TEST(LockFreeQueue, AddAndPop)
+{
+	LockFreeQueue<int> oQueue(3);
+	EXPECT_TRUE(oQueue.Capacity() == 4);
+	EXPECT_TRUE(oQueue.Empty());
+
+	for (int i = 0; i < 4; i++)
+	{
+		EXPECT_TRUE(oQueue.Add(i));
+	}
+	EXPECT_FALSE(oQueue.Add(4));
+
+	int iValue = -1;
+	for (int i = 0; i < 4; i++)
+	{
+		EXPECT_TRUE(oQueue.TryPop(iValue));
+		EXPECT_TRUE(iValue == i);
+	}
+	EXPECT_FALSE(oQueue.TryPop(iValue));
+	EXPECT_TRUE(oQueue.Empty());
+}
+
+TEST(LockFreeQueue, WaitTimeout)
+{
+	LockFreeQueue<int> oQueue(8);
+
+	uint64_t llBeginTime = Time::GetSteadyClockMS();
+	EXPECT_FALSE(oQueue.WaitTime(20));
+	EXPECT_TRUE(Time::GetSteadyClockMS() - llBeginTime >= 19);
+
+	oQueue.Add(1);
+	EXPECT_TRUE(oQueue.WaitTime(1000));
+}
+
+TEST(LockFreeQueue, MultiProducer)
+{
+	LockFreeQueue<uint64_t> oQueue(64);
+
+	int iProducerCount = 4;
+	int iCountPerProducer = 10000;
+
+	vector<QueueProducer *> vecProducer;
+	for (int i = 0; i < iProducerCount; i++)
+	{
+		vecProducer.push_back(new QueueProducer(&oQueue, (uint64_t)i << 32, iCountPerProducer));
+	}
+
+	for (auto & poProducer : vecProducer)
+	{
+		poProducer->start();
+	}
+
+	//every producer's values must come out in order.
+	vector<uint64_t> vecNext(iProducerCount, 0);
+	int iPopCount = 0;
+	while (iPopCount < iProducerCount * iCountPerProducer)
+	{
+		uint64_t llValue = 0;
+		if (!oQueue.TryPop(llValue))
+		{
+			oQueue.WaitTime(1000);
+			continue;
+		}
+
+		int iProducer = (int)(llValue >> 32);
+		ASSERT_TRUE(iProducer < iProducerCount);
+		EXPECT_TRUE((llValue & 0xffffffff) == vecNext[iProducer]);
+		vecNext[iProducer]++;
+		iPopCount++;
+	}
+
+	for (auto & poProducer : vecProducer)
+	{
+		poProducer->join();
+		delete poProducer;
+	}
+
+	EXPECT_TRUE(oQueue.Empty());
+}
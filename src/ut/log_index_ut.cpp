@@ -0,0 +1,258 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include <string>
+#include <thread>
+#include "comm_include.h"
+#include "log_index.h"
+#include "gmock/gmock.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+using namespace phxpaxos;
+using namespace std;
+
+static string MakeFileID(const int iFileID, const int iOffset)
+{
+	char sTmp[FILEID_LEN] = {0};
+	memcpy(sTmp, &iFileID, sizeof(int));
+	memcpy(sTmp + sizeof(int), &iOffset, sizeof(int));
+	return string(sTmp, sizeof(sTmp));
+}
+
+static int MakeLogIndexPath(string & sPath)
+{
+	sPath = "./ut_log_index_path";
+	if (access(sPath.c_str(), F_OK) != -1 && FileUtils::DeleteDir(sPath) != 0)
+	{
+		return -1;
+	}
+
+	return mkdir(sPath.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+}
+
+TEST(LogIndex, PutGetDel)
+{
+	string sPath;
+	ASSERT_TRUE(MakeLogIndexPath(sPath) == 0);
+
+	LogIndex oIndex;
+	bool bIsNew = false;
+	ASSERT_TRUE(oIndex.Init(sPath, 0, bIsNew) == 0);
+	EXPECT_TRUE(bIsNew);
+
+	uint64_t llMaxInstanceID = 0;
+	EXPECT_TRUE(oIndex.GetMaxInstanceID(llMaxInstanceID) == 1);
+
+	for (uint64_t llInstanceID = 5000; llInstanceID < 10000; llInstanceID++)
+	{
+		ASSERT_TRUE(oIndex.Put(llInstanceID, MakeFileID(1, (int)llInstanceID)) == 0);
+	}
+
+	string sFileID;
+	EXPECT_TRUE(oIndex.Get(4999, sFileID) == 1);
+	EXPECT_TRUE(oIndex.Get(10000, sFileID) == 1);
+	ASSERT_TRUE(oIndex.Get(8000, sFileID) == 0);
+	EXPECT_TRUE(sFileID == MakeFileID(1, 8000));
+
+	EXPECT_TRUE(oIndex.GetMaxInstanceID(llMaxInstanceID) == 0);
+	EXPECT_TRUE(llMaxInstanceID == 9999);
+
+	ASSERT_TRUE(oIndex.Del(9999) == 0);
+	EXPECT_TRUE(oIndex.GetMaxInstanceID(llMaxInstanceID) == 0);
+	EXPECT_TRUE(llMaxInstanceID == 9998);
+
+	for (uint64_t llInstanceID = 5000; llInstanceID < 9000; llInstanceID++)
+	{
+		ASSERT_TRUE(oIndex.Del(llInstanceID) == 0);
+	}
+	EXPECT_TRUE(oIndex.Get(5000, sFileID) == 1);
+	EXPECT_TRUE(oIndex.GetCount() == 999);
+}
+
+TEST(LogIndex, Reload)
+{
+	string sPath;
+	ASSERT_TRUE(MakeLogIndexPath(sPath) == 0);
+
+	{
+		LogIndex oIndex;
+		bool bIsNew = false;
+		ASSERT_TRUE(oIndex.Init(sPath, 0, bIsNew) == 0);
+
+		for (uint64_t llInstanceID = 0; llInstanceID < 100; llInstanceID++)
+		{
+			ASSERT_TRUE(oIndex.Put(llInstanceID, MakeFileID(0, (int)llInstanceID)) == 0);
+		}
+
+		for (uint64_t llInstanceID = 0; llInstanceID < 50; llInstanceID++)
+		{
+			ASSERT_TRUE(oIndex.Del(llInstanceID) == 0);
+		}
+	}
+
+	//half record left by crash.
+	string sFilePath = sPath + "/vindex";
+	int iFd = open(sFilePath.c_str(), O_WRONLY | O_APPEND);
+	ASSERT_TRUE(iFd != -1);
+	EXPECT_TRUE(write(iFd, "paxos", 5) == 5);
+	close(iFd);
+
+	LogIndex oIndex;
+	bool bIsNew = true;
+	ASSERT_TRUE(oIndex.Init(sPath, 0, bIsNew) == 0);
+	EXPECT_FALSE(bIsNew);
+	EXPECT_TRUE(oIndex.GetCount() == 50);
+
+	string sFileID;
+	EXPECT_TRUE(oIndex.Get(49, sFileID) == 1);
+	ASSERT_TRUE(oIndex.Get(50, sFileID) == 0);
+	EXPECT_TRUE(sFileID == MakeFileID(0, 50));
+
+	uint64_t llMaxInstanceID = 0;
+	EXPECT_TRUE(oIndex.GetMaxInstanceID(llMaxInstanceID) == 0);
+	EXPECT_TRUE(llMaxInstanceID == 99);
+}
+
+TEST(LogIndex, Compact)
+{
+	string sPath;
+	ASSERT_TRUE(MakeLogIndexPath(sPath) == 0);
+
+	uint64_t llCount = LOG_INDEX_COMPACT_MIN_RECORDS;
+
+	{
+		LogIndex oIndex;
+		bool bIsNew = false;
+		ASSERT_TRUE(oIndex.Init(sPath, 0, bIsNew) == 0);
+
+		for (uint64_t llInstanceID = 0; llInstanceID < llCount; llInstanceID++)
+		{
+			ASSERT_TRUE(oIndex.Put(llInstanceID, MakeFileID(0, (int)llInstanceID)) == 0);
+		}
+
+		for (uint64_t llInstanceID = 0; llInstanceID < llCount - 10; llInstanceID++)
+		{
+			ASSERT_TRUE(oIndex.Del(llInstanceID) == 0);
+		}
+	}
+
+	struct stat oStat;
+	ASSERT_TRUE(stat((sPath + "/vindex").c_str(), &oStat) == 0);
+	EXPECT_TRUE((uint64_t)oStat.st_size < llCount * LOG_INDEX_RECORD_LEN);
+
+	LogIndex oIndex;
+	bool bIsNew = false;
+	ASSERT_TRUE(oIndex.Init(sPath, 0, bIsNew) == 0);
+	EXPECT_TRUE(oIndex.GetCount() == 10);
+
+	string sFileID;
+	ASSERT_TRUE(oIndex.Get(llCount - 1, sFileID) == 0);
+	EXPECT_TRUE(sFileID == MakeFileID(0, (int)(llCount - 1)));
+}
+
+TEST(LogIndex, DelRange)
+{
+	string sPath;
+	ASSERT_TRUE(MakeLogIndexPath(sPath) == 0);
+
+	{
+		LogIndex oIndex;
+		bool bIsNew = false;
+		ASSERT_TRUE(oIndex.Init(sPath, 0, bIsNew) == 0);
+
+		for (uint64_t llInstanceID = 0; llInstanceID < 1000; llInstanceID++)
+		{
+			ASSERT_TRUE(oIndex.Put(llInstanceID, MakeFileID(0, (int)llInstanceID)) == 0);
+		}
+
+		EXPECT_TRUE(oIndex.DelRange(100, 100) == 0);
+		EXPECT_TRUE(oIndex.GetCount() == 1000);
+
+		ASSERT_TRUE(oIndex.DelRange(0, 600) == 0);
+		EXPECT_TRUE(oIndex.GetCount() == 400);
+
+		//deleted instances in range are skipped.
+		ASSERT_TRUE(oIndex.DelRange(500, 700) == 0);
+		EXPECT_TRUE(oIndex.GetCount() == 300);
+	}
+
+	LogIndex oIndex;
+	bool bIsNew = true;
+	ASSERT_TRUE(oIndex.Init(sPath, 0, bIsNew) == 0);
+	EXPECT_TRUE(oIndex.GetCount() == 300);
+
+	string sFileID;
+	EXPECT_TRUE(oIndex.Get(699, sFileID) == 1);
+	ASSERT_TRUE(oIndex.Get(700, sFileID) == 0);
+	EXPECT_TRUE(sFileID == MakeFileID(0, 700));
+}
+
+TEST(LogIndex, CompactWhilePut)
+{
+	string sPath;
+	ASSERT_TRUE(MakeLogIndexPath(sPath) == 0);
+
+	uint64_t llCount = LOG_INDEX_COMPACT_MIN_RECORDS;
+	uint64_t llPutBegin = llCount * 2;
+	uint64_t llPutEnd = llPutBegin + 20000;
+
+	{
+		LogIndex oIndex;
+		bool bIsNew = false;
+		ASSERT_TRUE(oIndex.Init(sPath, 0, bIsNew) == 0);
+
+		for (uint64_t llInstanceID = 0; llInstanceID < llCount; llInstanceID++)
+		{
+			ASSERT_TRUE(oIndex.Put(llInstanceID, MakeFileID(0, (int)llInstanceID)) == 0);
+		}
+
+		//puts race with compactions started by dels, they must all survive.
+		std::thread oWriter([&oIndex, llPutBegin, llPutEnd]()
+		{
+			for (uint64_t llInstanceID = llPutBegin; llInstanceID < llPutEnd; llInstanceID++)
+			{
+				oIndex.Put(llInstanceID, MakeFileID(1, (int)llInstanceID));
+			}
+		});
+
+		for (uint64_t llInstanceID = 0; llInstanceID < llCount - 10; llInstanceID++)
+		{
+			ASSERT_TRUE(oIndex.Del(llInstanceID) == 0);
+		}
+
+		oWriter.join();
+		EXPECT_TRUE(oIndex.GetCount() == 10 + llPutEnd - llPutBegin);
+	}
+
+	LogIndex oIndex;
+	bool bIsNew = true;
+	ASSERT_TRUE(oIndex.Init(sPath, 0, bIsNew) == 0);
+	EXPECT_TRUE(oIndex.GetCount() == 10 + llPutEnd - llPutBegin);
+
+	string sFileID;
+	EXPECT_TRUE(oIndex.Get(0, sFileID) == 1);
+	ASSERT_TRUE(oIndex.Get(llCount - 1, sFileID) == 0);
+	EXPECT_TRUE(sFileID == MakeFileID(0, (int)(llCount - 1)));
+	ASSERT_TRUE(oIndex.Get(llPutEnd - 1, sFileID) == 0);
+	EXPECT_TRUE(sFileID == MakeFileID(1, (int)(llPutEnd - 1)));
+}
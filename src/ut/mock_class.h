@@ -33,6 +33,8 @@ See the AUTHORS file for names of contributors.
 class MockNetWork : public phxpaxos::NetWork
 {
 public:
+    using phxpaxos::NetWork::SendMessageTCP;
+    using phxpaxos::NetWork::SendMessageUDP;
     MOCK_METHOD0(RunNetWork, void());
     MOCK_METHOD0(StopNetWork, void());
     MOCK_METHOD3(SendMessageTCP, int(const std::string & sIp, const int iPort, const std::string & sMessage));
@@ -116,3 +116,64 @@ TEST(Timer, PopTimer)
 }
 
 
+
+TEST(Timer, RemoveTimer)
+{
+	Timer oTimer;
+
+	uint64_t llAbsTime = Time::GetSteadyClockMS() + 20;
+	uint32_t iRemoveTimerID = 0;
+	oTimer.AddTimerWithType(llAbsTime, 1, iRemoveTimerID);
+	uint32_t iTimerID = 0;
+	oTimer.AddTimerWithType(llAbsTime, 2, iTimerID);
+	EXPECT_TRUE(iRemoveTimerID != iTimerID);
+	EXPECT_TRUE(oTimer.GetTimerCount() == 2);
+
+	EXPECT_TRUE(oTimer.RemoveTimer(iRemoveTimerID));
+	EXPECT_FALSE(oTimer.RemoveTimer(iRemoveTimerID));
+	EXPECT_TRUE(oTimer.GetTimerCount() == 1);
+
+	Time::MsSleep(25);
+
+	uint32_t iTakeTimerID = 0;
+	int iTakeType = 0;
+	EXPECT_TRUE(oTimer.PopTimeout(iTakeTimerID, iTakeType));
+	EXPECT_TRUE(iTakeTimerID == iTimerID);
+	EXPECT_TRUE(iTakeType == 2);
+	EXPECT_FALSE(oTimer.PopTimeout(iTakeTimerID, iTakeType));
+
+	//timerid of a timeout timer is stale, and won't remove the timer reusing its node.
+	uint32_t iNewTimerID = 0;
+	oTimer.AddTimerWithType(Time::GetSteadyClockMS() + 1000, 3, iNewTimerID);
+	EXPECT_FALSE(oTimer.RemoveTimer(iTimerID));
+	EXPECT_TRUE(oTimer.RemoveTimer(iNewTimerID));
+	EXPECT_TRUE(oTimer.GetNextTimeout() == -1);
+}
+
+TEST(Timer, CascadeTimer)
+{
+	Timer oTimer;
+
+	//farther than level 0 of the wheel, must cascade down before timeout.
+	uint64_t llAbsTime = Time::GetSteadyClockMS() + 600;
+	uint32_t iTimerID = 0;
+	oTimer.AddTimerWithData(llAbsTime, 5, 99, iTimerID);
+
+	int iNextTimeout = oTimer.GetNextTimeout();
+	EXPECT_TRUE(iNextTimeout > 0 && iNextTimeout <= 600);
+
+	uint32_t iTakeTimerID = 0;
+	int iTakeType = 0;
+	int iTakeData = 0;
+	while (!oTimer.PopTimeout(iTakeTimerID, iTakeType, iTakeData))
+	{
+		iNextTimeout = oTimer.GetNextTimeout();
+		ASSERT_TRUE(iNextTimeout >= 0);
+		Time::MsSleep(iNextTimeout > 0 ? iNextTimeout : 1);
+	}
+
+	EXPECT_TRUE(Time::GetSteadyClockMS() >= llAbsTime);
+	EXPECT_TRUE(iTakeTimerID == iTimerID);
+	EXPECT_TRUE(iTakeType == 5);
+	EXPECT_TRUE(iTakeData == 99);
+}
@@ -169,6 +169,17 @@ public:
         _storage.clear();
     }
 
+    bool remove(const T& t) {
+        for (auto it = _storage.begin(); it != _storage.end(); ++it) {
+            if (*it == t) {
+                _storage.erase(it);
+                --_size;
+                return true;
+            }
+        }
+        return false;
+    }
+
     void signal() {
         _cond.notify_one();
     }
@@ -21,8 +21,14 @@ See the AUTHORS file for names of contributors.
 
 #include <crc32.h>
 #include <stdio.h>
+#include <string.h>
 #include "inttypes.h"
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define CRC32_USE_CLMUL
+#endif
+
 static uint32_t crc32_tab[] = {
     0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f,
     0xe963a535, 0x9e6495a3,    0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988,
@@ -69,23 +75,239 @@ static uint32_t crc32_tab[] = {
     0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
 };
 
+//crc32_tab extended for slicing-by-8, crc32_slice_tab[0] is crc32_tab.
+class Crc32SliceTable
+{
+public:
+    Crc32SliceTable()
+    {
+        for (int n = 0; n < 256; n++)
+        {
+            tab[0][n] = crc32_tab[n];
+        }
+
+        for (int k = 1; k < 8; k++)
+        {
+            for (int n = 0; n < 256; n++)
+            {
+                uint32_t crc = tab[k - 1][n];
+                tab[k][n] = crc32_tab[crc & 0xFF] ^ (crc >> 8);
+            }
+        }
+    }
+
+    uint32_t tab[8][256];
+};
+
+//crc is not inverted here.
+static uint32_t
+crc32_bytes(uint32_t crc, const uint8_t *p, size_t len)
+{
+    while (len > 0)
+    {
+        crc = crc32_tab[(crc ^ *p) & 0xFF] ^ (crc >> 8);
+        p++;
+        len--;
+    }
+
+    return crc;
+}
+
+static uint32_t
+crc32_slice8(uint32_t crc, const uint8_t *p, size_t len)
+{
+    static const Crc32SliceTable slice_tab;
+    const uint32_t (*t)[256] = slice_tab.tab;
+
+    while (len >= 8)
+    {
+        uint32_t lo = 0, hi = 0;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        lo = __builtin_bswap32(lo);
+        hi = __builtin_bswap32(hi);
+#endif
+        lo ^= crc;
+
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] 
+            ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+            ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] 
+            ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+
+        p += 8;
+        len -= 8;
+    }
+
+    return crc32_bytes(crc, p, len);
+}
+
+#ifdef CRC32_USE_CLMUL
+
+//fold 64 bytes a round with carry-less multiply, same polynomial as crc32_tab,
+//see Intel "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ".
+//len must be >= 64 and multiple of 16, crc is not inverted here.
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t
+crc32_clmul(uint32_t crc, const uint8_t *buf, size_t len)
+{
+    static const uint64_t k1k2[2] __attribute__((aligned(16))) = { 0x0154442bd4, 0x01c6e41596 };
+    static const uint64_t k3k4[2] __attribute__((aligned(16))) = { 0x01751997d0, 0x00ccaa009e };
+    static const uint64_t k5k0[2] __attribute__((aligned(16))) = { 0x0163cd6124, 0x0000000000 };
+    static const uint64_t poly[2] __attribute__((aligned(16))) = { 0x01db710641, 0x01f7011641 };
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    x1 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+    x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+
+    x0 = _mm_load_si128((const __m128i *)k1k2);
+
+    buf += 64;
+    len -= 64;
+
+    while (len >= 64)
+    {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        y5 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+        y6 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+        y7 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+        y8 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+        buf += 64;
+        len -= 64;
+    }
+
+    //fold 512 bits into 128 bits.
+    x0 = _mm_load_si128((const __m128i *)k3k4);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    while (len >= 16)
+    {
+        x2 = _mm_loadu_si128((const __m128i *)buf);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        buf += 16;
+        len -= 16;
+    }
+
+    //fold 128 bits into 64 bits.
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    //barrett reduce to 32 bits.
+    x0 = _mm_load_si128((const __m128i *)poly);
+
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (uint32_t)_mm_extract_epi32(x1, 1);
+}
+
+static bool
+crc32_has_clmul()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+}
+
+#endif
+
+static uint32_t
+crc32_contiguous(uint32_t crc, const uint8_t *p, size_t len)
+{
+#ifdef CRC32_USE_CLMUL
+    static const bool has_clmul = crc32_has_clmul();
+    if (has_clmul && len >= 64)
+    {
+        size_t fold_len = len & ~(size_t)15;
+        crc = crc32_clmul(crc, p, fold_len);
+        p += fold_len;
+        len -= fold_len;
+    }
+#endif
+
+    return crc32_slice8(crc, p, len);
+}
+
+//skiplen > 1 only checksum every skiplen-th byte, gather them into 
+//a small buffer so they can go through the same fast path.
 uint32_t
 crc32(uint32_t crc, const uint8_t *buf, int size, int skiplen)
 {
-    const uint8_t *p;
-
-    p = buf;
     crc = crc ^ ~0U;
 
-    while (size > 0)
+    if (size <= 0)
     {
-        crc = crc32_tab[(crc ^ *p) & 0xFF] ^ (crc >> 8);
+        return crc ^ ~0U;
+    }
 
-        size -= skiplen;
-        p += skiplen;
+    if (skiplen <= 1)
+    {
+        return crc32_contiguous(crc, buf, (size_t)size) ^ ~0U;
+    }
+
+    uint8_t gather[512] = {0};
+    size_t count = ((size_t)size + skiplen - 1) / skiplen;
+    const uint8_t *p = buf;
+
+    while (count > 0)
+    {
+        size_t n = count < sizeof(gather) ? count : sizeof(gather);
+        for (size_t i = 0; i < n; i++)
+        {
+            gather[i] = *p;
+            p += skiplen;
+        }
+
+        crc = crc32_contiguous(crc, gather, n);
+        count -= n;
     }
 
     return crc ^ ~0U;
 }
 
-
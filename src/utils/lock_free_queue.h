@@ -0,0 +1,209 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#pragma once
+
+#include <atomic>
+#include <assert.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include "util.h"
+
+namespace phxpaxos
+{
+
+#define LOCK_FREE_QUEUE_CACHE_LINE_SIZE 64
+
+//Bounded lock-free queue, any thread can Add or TryPop at the same time.
+//Capacity is round up to power of 2.
+//Only one thread can park in WaitTime, producers only write the eventfd when it is parked.
+template <class T>
+class LockFreeQueue : public Noncopyable
+{
+public:
+    LockFreeQueue(const size_t iCapacity) : m_iEnqueuePos(0), m_iDequeuePos(0), m_bIsWaiting(false)
+    {
+        size_t iRealCapacity = 2;
+        while (iRealCapacity < iCapacity)
+        {
+            iRealCapacity <<= 1;
+        }
+
+        m_iMask = iRealCapacity - 1;
+        m_poCells = new Cell[iRealCapacity];
+        for (size_t i = 0; i < iRealCapacity; i++)
+        {
+            m_poCells[i].m_iSeq.store(i, std::memory_order_relaxed);
+        }
+
+        m_iEventFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        assert(m_iEventFD != -1);
+    }
+
+    ~LockFreeQueue()
+    {
+        delete [] m_poCells;
+        close(m_iEventFD);
+    }
+
+    //return false if queue is full.
+    bool Add(const T & t)
+    {
+        Cell * poCell = nullptr;
+        size_t iPos = m_iEnqueuePos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            poCell = &m_poCells[iPos & m_iMask];
+            size_t iSeq = poCell->m_iSeq.load(std::memory_order_acquire);
+            intptr_t iDiff = (intptr_t)iSeq - (intptr_t)iPos;
+            if (iDiff == 0)
+            {
+                if (m_iEnqueuePos.compare_exchange_weak(iPos, iPos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (iDiff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                iPos = m_iEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        poCell->m_tData = t;
+        poCell->m_iSeq.store(iPos + 1, std::memory_order_release);
+
+        //pair with the fence in WaitTime, either waiter see this cell or we see the waiter.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_bIsWaiting.load(std::memory_order_relaxed)
+                && m_bIsWaiting.exchange(false, std::memory_order_relaxed))
+        {
+            uint64_t llOne = 1;
+            ssize_t iWriteLen = write(m_iEventFD, &llOne, sizeof(llOne));
+            (void)iWriteLen;
+        }
+
+        return true;
+    }
+
+    //return false if queue is empty.
+    bool TryPop(T & t)
+    {
+        Cell * poCell = nullptr;
+        size_t iPos = m_iDequeuePos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            poCell = &m_poCells[iPos & m_iMask];
+            size_t iSeq = poCell->m_iSeq.load(std::memory_order_acquire);
+            intptr_t iDiff = (intptr_t)iSeq - (intptr_t)(iPos + 1);
+            if (iDiff == 0)
+            {
+                if (m_iDequeuePos.compare_exchange_weak(iPos, iPos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (iDiff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                iPos = m_iDequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        t = poCell->m_tData;
+        poCell->m_iSeq.store(iPos + m_iMask + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const
+    {
+        size_t iPos = m_iDequeuePos.load(std::memory_order_relaxed);
+        return m_poCells[iPos & m_iMask].m_iSeq.load(std::memory_order_acquire) != iPos + 1;
+    }
+
+    //park until something added or timeout, return false if still empty.
+    //may wake up early, caller should loop on its own.
+    bool WaitTime(const int iTimeoutMs)
+    {
+        if (!Empty())
+        {
+            return true;
+        }
+
+        m_bIsWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (Empty())
+        {
+            struct pollfd oPollFD;
+            oPollFD.fd = m_iEventFD;
+            oPollFD.events = POLLIN;
+            oPollFD.revents = 0;
+            if (poll(&oPollFD, 1, iTimeoutMs) > 0)
+            {
+                uint64_t llCount = 0;
+                ssize_t iReadLen = read(m_iEventFD, &llCount, sizeof(llCount));
+                (void)iReadLen;
+            }
+        }
+
+        m_bIsWaiting.store(false, std::memory_order_relaxed);
+
+        return !Empty();
+    }
+
+    const size_t Capacity() const
+    {
+        return m_iMask + 1;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> m_iSeq;
+        T m_tData;
+    };
+
+    Cell * m_poCells;
+    size_t m_iMask;
+
+    //padding keeps producers' and consumer's positions on their own cache lines,
+    //no alignas, so owners are not over-aligned and plain new still works before c++17.
+    char m_sPad0[LOCK_FREE_QUEUE_CACHE_LINE_SIZE];
+    std::atomic<size_t> m_iEnqueuePos;
+    char m_sPad1[LOCK_FREE_QUEUE_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> m_iDequeuePos;
+    char m_sPad2[LOCK_FREE_QUEUE_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+    std::atomic<bool> m_bIsWaiting;
+    char m_sPad3[LOCK_FREE_QUEUE_CACHE_LINE_SIZE - sizeof(std::atomic<bool>)];
+
+    int m_iEventFD;
+};
+
+}
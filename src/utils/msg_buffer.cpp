@@ -0,0 +1,122 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "msg_buffer.h"
+#include <assert.h>
+
+namespace phxpaxos
+{
+
+MsgBuffer :: MsgBuffer()
+    : m_pcBuffer(nullptr), m_iLen(0), m_iCapacity(0)
+{
+}
+
+MsgBuffer :: ~MsgBuffer()
+{
+    delete []m_pcBuffer;
+}
+
+char * MsgBuffer :: GetPtr()
+{
+    return m_pcBuffer;
+}
+
+const char * MsgBuffer :: GetPtr() const
+{
+    return m_pcBuffer;
+}
+
+const int MsgBuffer :: GetLen() const
+{
+    return m_iLen;
+}
+
+const int MsgBuffer :: GetCapacity() const
+{
+    return m_iCapacity;
+}
+
+void MsgBuffer :: Ready(const int iLen)
+{
+    if (m_iCapacity < iLen)
+    {
+        delete []m_pcBuffer;
+
+        //no need to init, network or memcpy will fill it.
+        m_pcBuffer = new char[iLen];
+        assert(m_pcBuffer != nullptr);
+        m_iCapacity = iLen;
+    }
+
+    m_iLen = iLen;
+}
+
+///////////////////////////////////
+
+MsgBufferPool :: MsgBufferPool()
+    : m_oFreeQueue(MSG_BUFFER_POOL_LEN)
+{
+}
+
+MsgBufferPool :: ~MsgBufferPool()
+{
+    MsgBuffer * poBuffer = nullptr;
+    while (m_oFreeQueue.TryPop(poBuffer))
+    {
+        delete poBuffer;
+    }
+}
+
+MsgBufferPool * MsgBufferPool :: Instance()
+{
+    static MsgBufferPool oMsgBufferPool;
+    return &oMsgBufferPool;
+}
+
+MsgBuffer * MsgBufferPool :: Get(const int iLen)
+{
+    MsgBuffer * poBuffer = nullptr;
+    if (!m_oFreeQueue.TryPop(poBuffer))
+    {
+        poBuffer = new MsgBuffer();
+        assert(poBuffer != nullptr);
+    }
+
+    poBuffer->Ready(iLen);
+    return poBuffer;
+}
+
+void MsgBufferPool :: Put(MsgBuffer * poBuffer)
+{
+    if (poBuffer == nullptr)
+    {
+        return;
+    }
+
+    if (poBuffer->GetCapacity() > MSG_BUFFER_POOL_MAX_CAPACITY
+            || !m_oFreeQueue.Add(poBuffer))
+    {
+        delete poBuffer;
+    }
+}
+
+}
@@ -0,0 +1,78 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#pragma once
+
+#include "lock_free_queue.h"
+
+namespace phxpaxos
+{
+
+//Buffer of one received message.
+//Network read the message into it, then hand it to the group's ioloop,
+//ioloop parse from it and put it back to pool, so the message is never copied.
+class MsgBuffer
+{
+public:
+    MsgBuffer();
+    ~MsgBuffer();
+
+    char * GetPtr();
+
+    const char * GetPtr() const;
+
+    const int GetLen() const;
+
+    const int GetCapacity() const;
+
+    //make room for iLen bytes, old content is not kept.
+    void Ready(const int iLen);
+
+private:
+    char * m_pcBuffer;
+    int m_iLen;
+    int m_iCapacity;
+};
+
+/////////////////////////////////
+
+#define MSG_BUFFER_POOL_LEN 512
+#define MSG_BUFFER_POOL_MAX_CAPACITY 65536
+
+class MsgBufferPool
+{
+public:
+    MsgBufferPool();
+    ~MsgBufferPool();
+
+    static MsgBufferPool * Instance();
+
+    //always success, allocate a new one if pool is empty.
+    MsgBuffer * Get(const int iLen);
+
+    //big buffers are freed, not kept in pool.
+    void Put(MsgBuffer * poBuffer);
+
+private:
+    LockFreeQueue<MsgBuffer *> m_oFreeQueue;
+};
+
+}
@@ -22,12 +22,22 @@ See the AUTHORS file for names of contributors.
 #include "timer.h"
 #include "util.h"
 #include <algorithm> 
+#include <limits.h>
 
 namespace phxpaxos
 {
 
-Timer :: Timer() : m_iNowTimerID(1)
+Timer :: Timer() 
+    : m_iFreeHead(-1), m_iFreeTail(-1),
+    m_iExpiredList(TIMER_WHEEL_ROOT_SIZE + TIMER_WHEEL_LEVEL_COUNT * TIMER_WHEEL_LEVEL_SIZE),
+    m_llNowTick(Time::GetSteadyClockMS()), m_iWheelCount(0), m_iTimerCount(0)
 {
+    TimerList tEmptyList;
+    tEmptyList.m_iHead = -1;
+    tEmptyList.m_iTail = -1;
+    m_vecLists.assign(m_iExpiredList + 1, tEmptyList);
+
+    std::fill(std::begin(m_arrRootBitmap), std::end(m_arrRootBitmap), 0);
 }
 
 Timer :: ~Timer()
@@ -36,64 +46,381 @@ Timer :: ~Timer()
 
 void Timer :: AddTimer(const uint64_t llAbsTime, uint32_t & iTimerID)
 {
-    return AddTimerWithType(llAbsTime, 0, iTimerID);
+    return AddTimerWithData(llAbsTime, 0, 0, iTimerID);
 }
 
 void Timer :: AddTimerWithType(const uint64_t llAbsTime, const int iType, uint32_t & iTimerID)
 {
-    iTimerID = m_iNowTimerID++;
+    return AddTimerWithData(llAbsTime, iType, 0, iTimerID);
+}
+
+void Timer :: AddTimerWithData(const uint64_t llAbsTime, const int iType, const int iData, uint32_t & iTimerID)
+{
+    int iNode = NewNode();
+    if (iNode == -1)
+    {
+        iTimerID = 0;
+        return;
+    }
+
+    if (m_iWheelCount == 0)
+    {
+        //wheel is idle, catch up with now, so the timer is placed by the real delay.
+        m_llNowTick = std::max(m_llNowTick, Time::GetSteadyClockMS());
+    }
 
-    TimerObj tObj(iTimerID, llAbsTime, iType);
-    m_vecTimerHeap.push_back(tObj);
-    // Сѡ
-    push_heap(begin(m_vecTimerHeap), end(m_vecTimerHeap));
+    TimerObj & tObj = m_vecNodes[iNode];
+    tObj.m_llAbsTime = llAbsTime;
+    tObj.m_iType = iType;
+    tObj.m_iData = iData;
+
+    Place(iNode);
+    m_iTimerCount++;
+
+    iTimerID = tObj.m_iTimerID;
+}
+
+bool Timer :: RemoveTimer(const uint32_t iTimerID)
+{
+    int iNode = (int)(iTimerID & ((1u << TIMER_INDEX_BITS) - 1));
+    if (iNode >= (int)m_vecNodes.size())
+    {
+        return false;
+    }
+
+    TimerObj & tObj = m_vecNodes[iNode];
+    if (tObj.m_iList == -1 || tObj.m_iTimerID != iTimerID)
+    {
+        //already timeout or removed.
+        return false;
+    }
+
+    Unlink(iNode);
+    FreeNode(iNode);
+    m_iTimerCount--;
+
+    return true;
 }
 
 //  0 Ѿʱ쳬ʱǸ¼
 // ʣµûгʱʱ䡣
 const int Timer :: GetNextTimeout() const
 {
-    if (m_vecTimerHeap.empty())
+    if (m_vecLists[m_iExpiredList].m_iHead != -1)
+    {
+        return 0;
+    }
+
+    if (m_iWheelCount == 0)
     {
         return -1;
     }
 
-    int iNextTimeout = 0;
+    //timers in upper levels are no earlier than the next level 0 wrap,
+    //so wake up there at most, and look again after cascade.
+    uint64_t llBlockStart = m_llNowTick & ~(uint64_t)(TIMER_WHEEL_ROOT_SIZE - 1);
+    uint64_t llNextTick = llBlockStart + TIMER_WHEEL_ROOT_SIZE;
+
+    int iFromSlot = (int)(m_llNowTick - llBlockStart);
+    for (int i = iFromSlot / 64; i < TIMER_WHEEL_ROOT_SIZE / 64; i++)
+    {
+        uint64_t llBits = m_arrRootBitmap[i];
+        if (i == iFromSlot / 64)
+        {
+            llBits &= ~(uint64_t)0 << (iFromSlot % 64);
+        }
+
+        if (llBits != 0)
+        {
+            llNextTick = llBlockStart + i * 64 + __builtin_ctzll(llBits);
+            break;
+        }
+    }
 
-    TimerObj tObj = m_vecTimerHeap.front();
     uint64_t llNowTime = Time::GetSteadyClockMS();
-    if (tObj.m_llAbsTime > llNowTime)
+    if (llNextTick <= llNowTime)
     {
-        iNextTimeout = (int)(tObj.m_llAbsTime - llNowTime);
+        return 0;
     }
 
-    return iNextTimeout;
+    return (int)std::min(llNextTick - llNowTime, (uint64_t)INT_MAX);
+}
+
+const size_t Timer :: GetTimerCount() const
+{
+    return m_iTimerCount;
 }
 
-// ȡСǸʱĽڵ㡣
 bool Timer :: PopTimeout(uint32_t & iTimerID, int & iType)
 {
-    if (m_vecTimerHeap.empty())
+    int iData = 0;
+    return PopTimeout(iTimerID, iType, iData);
+}
+
+bool Timer :: PopTimeout(uint32_t & iTimerID, int & iType, int & iData)
+{
+    if (m_iTimerCount == 0)
     {
         return false;
     }
 
-    TimerObj tObj = m_vecTimerHeap.front();
-    uint64_t llNowTime = Time::GetSteadyClockMS();
-    if (tObj.m_llAbsTime > llNowTime)
+    Advance(Time::GetSteadyClockMS());
+
+    int iNode = m_vecLists[m_iExpiredList].m_iHead;
+    if (iNode == -1)
     {
         return false;
     }
-    
-    pop_heap(begin(m_vecTimerHeap), end(m_vecTimerHeap));
-    m_vecTimerHeap.pop_back();
 
+    const TimerObj & tObj = m_vecNodes[iNode];
     iTimerID = tObj.m_iTimerID;
     iType = tObj.m_iType;
+    iData = tObj.m_iData;
+
+    Unlink(iNode);
+    FreeNode(iNode);
+    m_iTimerCount--;
 
     return true;
 }    
-    
+
+int Timer :: NewNode()
+{
+    int iNode = m_iFreeHead;
+    if (iNode != -1)
+    {
+        m_iFreeHead = m_vecNodes[iNode].m_iNext;
+        if (m_iFreeHead == -1)
+        {
+            m_iFreeTail = -1;
+        }
+    }
+    else
+    {
+        if (m_vecNodes.size() >= (1u << TIMER_INDEX_BITS))
+        {
+            return -1;
+        }
+
+        iNode = (int)m_vecNodes.size();
+        m_vecNodes.emplace_back();
+        m_vecNodes[iNode].m_iTimerID = (uint32_t)iNode;
+    }
+
+    //bump node generation, skip 0 to keep timerid non zero.
+    TimerObj & tObj = m_vecNodes[iNode];
+    uint32_t iGeneration = (tObj.m_iTimerID >> TIMER_INDEX_BITS) + 1;
+    if (iGeneration >= (1u << (32 - TIMER_INDEX_BITS)))
+    {
+        iGeneration = 1;
+    }
+
+    tObj.m_iTimerID = (iGeneration << TIMER_INDEX_BITS) | (uint32_t)iNode;
+    tObj.m_iList = -1;
+    tObj.m_iPrev = -1;
+    tObj.m_iNext = -1;
+
+    return iNode;
+}
+
+void Timer :: FreeNode(const int iNode)
+{
+    //reuse the oldest free node first, make stale timerid live longer.
+    TimerObj & tObj = m_vecNodes[iNode];
+    tObj.m_iList = -1;
+    tObj.m_iPrev = -1;
+    tObj.m_iNext = -1;
+
+    if (m_iFreeTail == -1)
+    {
+        m_iFreeHead = iNode;
+    }
+    else
+    {
+        m_vecNodes[m_iFreeTail].m_iNext = iNode;
+    }
+    m_iFreeTail = iNode;
 }
 
+void Timer :: Link(const int iList, const int iNode)
+{
+    TimerList & tList = m_vecLists[iList];
+    TimerObj & tObj = m_vecNodes[iNode];
+
+    tObj.m_iList = iList;
+    tObj.m_iPrev = tList.m_iTail;
+    tObj.m_iNext = -1;
 
+    if (tList.m_iTail == -1)
+    {
+        tList.m_iHead = iNode;
+    }
+    else
+    {
+        m_vecNodes[tList.m_iTail].m_iNext = iNode;
+    }
+    tList.m_iTail = iNode;
+
+    if (iList < TIMER_WHEEL_ROOT_SIZE)
+    {
+        m_arrRootBitmap[iList / 64] |= (uint64_t)1 << (iList % 64);
+    }
+
+    if (iList != m_iExpiredList)
+    {
+        m_iWheelCount++;
+    }
+}
+
+void Timer :: Unlink(const int iNode)
+{
+    TimerObj & tObj = m_vecNodes[iNode];
+    int iList = tObj.m_iList;
+    TimerList & tList = m_vecLists[iList];
+
+    if (tObj.m_iPrev == -1)
+    {
+        tList.m_iHead = tObj.m_iNext;
+    }
+    else
+    {
+        m_vecNodes[tObj.m_iPrev].m_iNext = tObj.m_iNext;
+    }
+
+    if (tObj.m_iNext == -1)
+    {
+        tList.m_iTail = tObj.m_iPrev;
+    }
+    else
+    {
+        m_vecNodes[tObj.m_iNext].m_iPrev = tObj.m_iPrev;
+    }
+
+    tObj.m_iList = -1;
+    tObj.m_iPrev = -1;
+    tObj.m_iNext = -1;
+
+    if (iList < TIMER_WHEEL_ROOT_SIZE && tList.m_iHead == -1)
+    {
+        m_arrRootBitmap[iList / 64] &= ~((uint64_t)1 << (iList % 64));
+    }
+
+    if (iList != m_iExpiredList)
+    {
+        m_iWheelCount--;
+    }
+}
+
+const int Timer :: GetListIdx(const int iLevel, const int iSlot) const
+{
+    if (iLevel == 0)
+    {
+        return iSlot;
+    }
+
+    return TIMER_WHEEL_ROOT_SIZE + (iLevel - 1) * TIMER_WHEEL_LEVEL_SIZE + iSlot;
+}
+
+void Timer :: Place(const int iNode)
+{
+    uint64_t llExpireTick = m_vecNodes[iNode].m_llAbsTime;
+    if (llExpireTick < m_llNowTick)
+    {
+        Link(m_iExpiredList, iNode);
+        return;
+    }
+
+    uint64_t llDelta = llExpireTick - m_llNowTick;
+    if (llDelta < TIMER_WHEEL_ROOT_SIZE)
+    {
+        Link(GetListIdx(0, (int)(llExpireTick & (TIMER_WHEEL_ROOT_SIZE - 1))), iNode);
+        return;
+    }
+
+    for (int iLevel = 1; iLevel <= TIMER_WHEEL_LEVEL_COUNT; iLevel++)
+    {
+        int iShift = TIMER_WHEEL_ROOT_BITS + iLevel * TIMER_WHEEL_LEVEL_BITS;
+        if (llDelta < ((uint64_t)1 << iShift) || iLevel == TIMER_WHEEL_LEVEL_COUNT)
+        {
+            if (llDelta >= ((uint64_t)1 << iShift))
+            {
+                //too far, park at the farthest slot, it is placed again after cascade.
+                llExpireTick = m_llNowTick + ((uint64_t)1 << iShift) - 1;
+            }
+
+            int iSlot = (int)((llExpireTick >> (iShift - TIMER_WHEEL_LEVEL_BITS)) & (TIMER_WHEEL_LEVEL_SIZE - 1));
+            Link(GetListIdx(iLevel, iSlot), iNode);
+            return;
+        }
+    }
+}
+
+void Timer :: Cascade(const int iLevel, const int iSlot)
+{
+    TimerList & tList = m_vecLists[GetListIdx(iLevel, iSlot)];
+    while (tList.m_iHead != -1)
+    {
+        int iNode = tList.m_iHead;
+        Unlink(iNode);
+        Place(iNode);
+    }
+}
+
+void Timer :: Advance(const uint64_t llNowTime)
+{
+    while (m_llNowTick <= llNowTime)
+    {
+        if (m_iWheelCount == 0)
+        {
+            m_llNowTick = llNowTime + 1;
+            break;
+        }
+
+        bool bRootEmpty = true;
+        for (auto llBits : m_arrRootBitmap)
+        {
+            if (llBits != 0)
+            {
+                bRootEmpty = false;
+                break;
+            }
+        }
+
+        if (bRootEmpty)
+        {
+            //nothing to expire before next level 0 wrap, jump over.
+            uint64_t llWrapTick = (m_llNowTick | (TIMER_WHEEL_ROOT_SIZE - 1)) + 1;
+            m_llNowTick = std::min(llWrapTick, llNowTime + 1);
+        }
+        else
+        {
+            TimerList & tList = m_vecLists[GetListIdx(0, (int)(m_llNowTick & (TIMER_WHEEL_ROOT_SIZE - 1)))];
+            while (tList.m_iHead != -1)
+            {
+                int iNode = tList.m_iHead;
+                Unlink(iNode);
+                Link(m_iExpiredList, iNode);
+            }
+
+            m_llNowTick++;
+        }
+
+        //cascade as soon as level 0 wraps, keep all timers of this round in level 0.
+        if ((m_llNowTick & (TIMER_WHEEL_ROOT_SIZE - 1)) == 0)
+        {
+            for (int iLevel = 1; iLevel <= TIMER_WHEEL_LEVEL_COUNT; iLevel++)
+            {
+                int iShift = TIMER_WHEEL_ROOT_BITS + (iLevel - 1) * TIMER_WHEEL_LEVEL_BITS;
+                int iSlot = (int)((m_llNowTick >> iShift) & (TIMER_WHEEL_LEVEL_SIZE - 1));
+                Cascade(iLevel, iSlot);
+
+                if (iSlot != 0)
+                {
+                    break;
+                }
+            }
+        }
+    }
+}
+    
+}
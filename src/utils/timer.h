@@ -23,10 +23,25 @@ See the AUTHORS file for names of contributors.
 
 #include <vector>
 #include <inttypes.h>
+#include <stddef.h>
 
 namespace phxpaxos
 {
 
+//hierarchical timing wheel with 1ms tick, add/remove/pop are O(1).
+//level 0 has 256 slots of 1ms, each upper level has 64 slots covering the whole lower level,
+//timers in upper levels cascade down when the lower level wraps.
+#define TIMER_WHEEL_ROOT_BITS 8
+#define TIMER_WHEEL_LEVEL_BITS 6
+#define TIMER_WHEEL_LEVEL_COUNT 4
+#define TIMER_WHEEL_ROOT_SIZE (1 << TIMER_WHEEL_ROOT_BITS)
+#define TIMER_WHEEL_LEVEL_SIZE (1 << TIMER_WHEEL_LEVEL_BITS)
+
+//timerid = node generation << TIMER_INDEX_BITS | node index, so a stale timerid
+//won't hit the timer reusing its node, and 0 is never a valid timerid.
+//at most 1M timers alive in one loop, AddTimer return timerid 0 if overflow.
+#define TIMER_INDEX_BITS 20
+
 class Timer
 {
 public:
@@ -37,37 +52,68 @@ public:
     
     void AddTimerWithType(const uint64_t llAbsTime, const int iType, uint32_t & iTimerID);
 
+    void AddTimerWithData(const uint64_t llAbsTime, const int iType, const int iData, uint32_t & iTimerID);
+
+    bool RemoveTimer(const uint32_t iTimerID);
+
     bool PopTimeout(uint32_t & iTimerID, int & iType);
 
+    bool PopTimeout(uint32_t & iTimerID, int & iType, int & iData);
+
     const int GetNextTimeout() const;
+
+    const size_t GetTimerCount() const;
     
 private:
     struct TimerObj
     {
-        TimerObj(uint32_t iTimerID, uint64_t llAbsTime, int iType) 
-            : m_iTimerID(iTimerID), m_llAbsTime(llAbsTime), m_iType(iType) {}
-
         uint32_t m_iTimerID;
         uint64_t m_llAbsTime;
         int m_iType;
+        int m_iData;
 
-        // Сںţ㽨Сѡ
-        bool operator < (const TimerObj & obj) const
-        {
-            if (obj.m_llAbsTime == m_llAbsTime)
-            {
-                return obj.m_iTimerID < m_iTimerID;
-            }
-            else
-            {
-                return obj.m_llAbsTime < m_llAbsTime;
-            }
-        }
+        //list the node linked in, -1 means node is free.
+        int m_iList;
+        int m_iPrev;
+        int m_iNext;
+    };
+
+    struct TimerList
+    {
+        int m_iHead;
+        int m_iTail;
     };
 
+    int NewNode();
+
+    void FreeNode(const int iNode);
+
+    void Link(const int iList, const int iNode);
+
+    void Unlink(const int iNode);
+
+    void Place(const int iNode);
+
+    void Cascade(const int iLevel, const int iSlot);
+
+    void Advance(const uint64_t llNowTime);
+
+    const int GetListIdx(const int iLevel, const int iSlot) const;
+
 private:
-    uint32_t m_iNowTimerID;
-    std::vector<TimerObj> m_vecTimerHeap;
+    std::vector<TimerObj> m_vecNodes;
+    int m_iFreeHead;
+    int m_iFreeTail;
+
+    //level 0 slots, then upper levels slots, then the expired list.
+    std::vector<TimerList> m_vecLists;
+    int m_iExpiredList;
+    uint64_t m_arrRootBitmap[TIMER_WHEEL_ROOT_SIZE / 64];
+
+    //next tick not processed yet.
+    uint64_t m_llNowTick;
+    size_t m_iWheelCount;
+    size_t m_iTimerCount;
 };
     
 }